@@ -33,6 +33,7 @@
 # ttc.bringdown()
 # ttc.status()
 # ttc.clearCache()
+# ttc.batch([('ISA','physical-object','garage'), ('parents','Evian')])
 # ttc.close()
 #
 
@@ -55,6 +56,9 @@ class TTConnection:
     self.cache = {}
     self.USECACHE = 1
     self.errout = sys.stdout
+    self.rbuf = ''
+    self.rpos = 0
+    self.batching = None
 
   def __del__(self):
     self.close()
@@ -135,6 +139,26 @@ class TTConnection:
   def clearCache(self):
     self.cache = {}
 
+  # Issues several requests in one round trip, and returns their results
+  # in order. Each call is a tuple of a method name and its arguments.
+  def batch(self, calls):
+    self.batching = []
+    try:
+      for call in calls: getattr(self, call[0])(*call[1:])
+      queued = self.batching
+    finally:
+      self.batching = None
+    self.skt.send('Batch '+str(len(queued))+'\n'+
+                  ''.join(map((lambda x: x[0]), queued)))
+    r = []
+    for (query, queryType) in queued:
+      line = self.rdline()
+      if line[0:1] != '#':
+        self.errout.write(line+'\n')
+        return r
+      r.append(self.parse(queryType))
+    return r
+
   def close(self):
     if self.skt:
       self.skt.close()
@@ -179,7 +203,7 @@ class TTConnection:
 
   # Internal functions
   def query(self, query, queryType):
-    if self.USECACHE:
+    if self.USECACHE and self.batching == None:
       if self.cache.has_key(query): return self.cache[query]
       r = self.query1(query, queryType)
       self.cache[query] = r;
@@ -188,40 +212,44 @@ class TTConnection:
       return self.query1(query, queryType)
 
   def query1(self, query, queryType):
+    if self.batching != None:
+      self.batching.append((query, queryType))
+      return None
+    self.skt.send(query)
+    return self.parse(queryType)
+
+  def parse(self, queryType):
     if queryType == "Boolean":
-      return self.queryBoolean(query)
+      return self.parseBoolean()
     elif queryType == "String":
-      return self.queryString(query)
+      return self.parseString()
     elif queryType == "ColonString":
-      return self.queryColonString(query)
+      return self.parseColonString()
     elif queryType == "AssertionLines":
-      return self.queryAssertionLines(query)
+      return self.parseAssertionLines()
     elif queryType == "Leos":
-      return self.queryLeos(query)
+      return self.parseLeos()
     elif queryType == "PNodes":
-      return self.queryPNodes(query)
+      return self.parsePNodes()
     else:
       self.errout.write('unknown queryType <'+queryType+'>')
       return None
 
-  def queryBoolean(self, query):
-    self.skt.send(query)
+  def parseBoolean(self):
     line = self.rdline()
     if line[0:6] == 'error:':
       self.errout.write(line+'\n')
       return 0
     return int(line)
 
-  def queryString(self, query):
-    self.skt.send(query)
+  def parseString(self):
     line = self.rdline()
     if line[0:6] == 'error:':
       self.errout.write(line+'\n')
       return ""
     return strip(line)
 
-  def queryColonString(self, query):
-    self.skt.send(query)
+  def parseColonString(self):
     line = self.rdline()
     if line[0:6] == 'error:':
       self.errout.write(line+'\n')
@@ -229,12 +257,10 @@ class TTConnection:
     if line=='': return []
     return split(line, ':')
 
-  def queryAssertionLines(self, query):
-    self.skt.send(query)
+  def parseAssertionLines(self):
     return map(tt.assertionParse,self.rdlines())
 
-  def queryLeos(self, query):
-    self.skt.send(query)
+  def parseLeos(self):
     r = []
     lines = self.rdlines()
     for x in lines:
@@ -244,8 +270,7 @@ class TTConnection:
       r.append(leo)
     return r
 
-  def queryPNodes(self, query):
-    self.skt.send(query)
+  def parsePNodes(self):
     r = []
     lines = self.rdlines()
     for x in lines:
@@ -258,18 +283,27 @@ class TTConnection:
     return r
 
   def rdline(self):
-    r = '';
     while 1:
-      c = self.skt.recv(1); # todo: buffering
-      if c == '\n': return r
-      r = r+c
+      i = self.rbuf.find('\n', self.rpos)
+      if i >= 0:
+        r = self.rbuf[self.rpos:i]
+        self.rpos = i+1
+        return r
+      c = self.skt.recv(65536)
+      if c == '':
+        r = self.rbuf[self.rpos:]
+        self.rbuf = ''
+        self.rpos = 0
+        return r
+      self.rbuf = self.rbuf[self.rpos:]+c
+      self.rpos = 0
 
   def rdlines(self):
     r = [];
     while 1:
       line = self.rdline()
       if line[0:6] == 'error:':
-        errout.write(line+'\n')
+        self.errout.write(line+'\n')
         return []
       if line == '.': break
       r.append(line)
@@ -0,0 +1,71 @@
+#
+# ThoughtTreasure
+# Throughput of the ThoughtTreasure server, one request at a time
+# versus in batches
+#
+# Copyright 2015 Erik Thomas Mueller. All Rights Reserved.
+#
+# Usage: python ttbench.py [host [port [requests [batchsize]]]]
+#
+# Start the server first, for example with: tt -c "server"
+#
+
+import sys
+import time
+import ttapi
+
+CALLS = [('ISA', 'food', 'apple'),
+         ('ISA', 'animal', 'human'),
+         ('isPartOf', 'finger', 'hand'),
+         ('ancestors', 'apple'),
+         ('parents', 'human'),
+         ('retrieve', -1, 1, -1, 'anc', 'part-of ? hand'),
+         ('phraseToConcepts', 'z', 'apple'),
+         ('conceptToLexEntries', 'food')]
+
+def calls(n):
+  r = []
+  for i in range(n): r.append(CALLS[i % len(CALLS)])
+  return r
+
+def oneAtATime(ttc, cs):
+  r = []
+  for call in cs: r.append(getattr(ttc, call[0])(*call[1:]))
+  return r
+
+def batched(ttc, cs, batchsize):
+  r = []
+  for i in range(0, len(cs), batchsize):
+    r = r+ttc.batch(cs[i:i+batchsize])
+  return r
+
+def report(label, n, secs):
+  sys.stdout.write('%-16s %6d requests %8.3f s %10.1f requests/s\n' %
+                   (label, n, secs, n/max(secs, 1e-6)))
+
+def main(args):
+  host = 'localhost'
+  port = ttapi.PORT
+  n = 4000
+  batchsize = 100
+  if len(args) > 0: host = args[0]
+  if len(args) > 1: port = int(args[1])
+  if len(args) > 2: n = int(args[2])
+  if len(args) > 3: batchsize = int(args[3])
+  ttc = ttapi.TTConnection(host, port)
+  ttc.USECACHE = 0
+  cs = calls(n)
+  t = time.time()
+  r1 = oneAtATime(ttc, cs)
+  report('one at a time', n, time.time()-t)
+  t = time.time()
+  r2 = batched(ttc, cs, batchsize)
+  report('batch '+str(batchsize), n, time.time()-t)
+  if map(str, r1) != map(str, r2):
+    sys.stdout.write('results differ\n')
+  ttc.close()
+
+if __name__ == '__main__':
+  main(sys.argv[1:])
+
+# End of file.
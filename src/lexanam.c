@@ -51,7 +51,7 @@ void AnaMorphClassListSet(char *suffix, AnaMorphClassList *mcs)
 
 void AnaMorphInit()
 {
-  AnaMorphHt = HashTableCreate(30001L);
+  AnaMorphHt = HashTableCreate(30001L, "AnaMorphHt");
   AnaMorphClassAll = NULL;
 }
 
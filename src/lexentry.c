@@ -12,6 +12,7 @@
  * 19940610: worked on automatic word inflecting and phrase inflecting
  * 19950428: new phrasal verb parsing mechanism
  * 19981122T092001: STATS
+ * 20261018T040000: prefix index of phrases
  *
  * todo:
  * - How to handle plurals of English abbreviations? "'s" left in inflection
@@ -198,18 +199,36 @@ void FeatureCheck(char *features, char *set, char *context)
   }
 }
 
-Obj *FeatToCon1(int feature)
+Obj	*FeatToConTable[256];
+Bool	FeatToConTableOK;
+
+Obj *FeatToCon2(int feature)
 {
   char	name[WORDLEN];
   sprintf(name, "F%d", CharsetISO_8859_1ToMac(feature));
   /* todo: Replace F with relations mac-code-of and iso-code-of.
    * Change object names to more intuitive names and fix references
-   * to those F objects in code and db. Cache a table to make these
-   * functions (called in parsing) fast.
+   * to those F objects in code and db.
    */
   return(NameToObj(name, OBJ_NO_CREATE));
 }
 
+/* Cache a table to make these functions (called in parsing) fast. */
+void FeatToConInit()
+{
+  int	i;
+  for (i = 0; i < 256; i++) FeatToConTable[i] = FeatToCon2(i);
+  FeatToConTableOK = 1;
+}
+
+Obj *FeatToCon1(int feature)
+{
+  if (FeatToConTableOK && feature >= 0 && feature < 256) {
+    return(FeatToConTable[feature]);
+  }
+  return(FeatToCon2(feature));
+}
+
 Obj *FeatToCon(int feature)
 {
   int	macfeat;
@@ -711,6 +730,7 @@ IndexEntry *IndexEntryIndexInfl(char *key, LexEntry *lexentry, char *features,
   Dbg(DBGLEX, DBGHYPER, "Indexing <%s>\n", key);
   ie = IndexEntryCreate(lexentry, features, previe);
   HashTableSet(ht, key, ie);
+  if (IsPhrase(key)) LexEntryPrefixIndexPhrase(ht, key);
   return(ie);
 }
 
@@ -734,6 +754,7 @@ int		MaxWordsInPhrase;
 HashTable	*FrenchIndex;
 HashTable	*EnglishIndex;
 HashTable	*SpellIndex;
+HashTable	*FrenchPrefixIndex, *EnglishPrefixIndex;
 LexEntry	*AllLexEntries;
 Bool		LexEntryOff, LexEntryInsideName;
 
@@ -742,9 +763,11 @@ void LexEntryInit()
   MaxWordsInPhrase = 0;
   AllLexEntries = NULL;
   LexEntryInsideName = 0;
-  FrenchIndex = HashTableCreate(10037L);
-  EnglishIndex = HashTableCreate(10037L);
-  if (!SaveTime) SpellIndex = HashTableCreate(10037L);
+  FrenchIndex = HashTableCreate(10037L, "FrenchIndex");
+  EnglishIndex = HashTableCreate(10037L, "EnglishIndex");
+  FrenchPrefixIndex = HashTableCreate(1009L, "FrenchPrefixIndex");
+  EnglishPrefixIndex = HashTableCreate(1009L, "EnglishPrefixIndex");
+  if (!SaveTime) SpellIndex = HashTableCreate(10037L, "SpellIndex");
   else SpellIndex = NULL;
 }
 
@@ -953,6 +976,67 @@ int LexEntryHtLang(HashTable *ht)
   else return(F_ENGLISH);
 }
 
+/* Prefix index */
+
+/* The prefix index of <ht> contains, for each phrase indexed in <ht>, the
+ * phrase and its initial word sequences, normalized by
+ * LexEntryPrefixAppend. It enables TA_LexEntry to stop extending a
+ * phrase as soon as no phrase begins with it.
+ */
+HashTable *LexEntryPrefixIndex(HashTable *ht)
+{
+  if (FrenchIndex == ht) return(FrenchPrefixIndex);
+  else return(EnglishPrefixIndex);
+}
+
+/* Appends <word> of length <len> to <prefix> of length <*prefix_len>,
+ * lowercased and without LE_NONWHITESPACE characters, so that all the
+ * spellings LexEntryFindPhrase1 tries for a phrase (absent SpellIndex)
+ * have the same normalization. Returns 0 if the result is too long.
+ */
+Bool LexEntryPrefixAppend(/* INPUT AND RESULTS */ char *prefix,
+                          int *prefix_len,
+                          /* INPUT */ char *word, int len)
+{
+  int	i, n;
+  n = *prefix_len;
+  if (n > 0) {
+    if (n >= PHRASELEN-1) return(0);
+    prefix[n++] = SPACE;
+  }
+  for (i = 0; i < len; i++) {
+    if (StringIn(((uc *)word)[i], LE_NONWHITESPACE)) continue;
+    if (n >= PHRASELEN-1) return(0);
+    prefix[n++] = CharToLower(((uc *)word)[i]);
+  }
+  prefix[n] = TERM;
+  *prefix_len = n;
+  return(1);
+}
+
+void LexEntryPrefixIndexPhrase(HashTable *ht, char *phrase)
+{
+  int		len;
+  long		flags;
+  char		*p, *word, prefix[PHRASELEN];
+  HashTable	*pht;
+  pht = LexEntryPrefixIndex(ht);
+  len = 0;
+  p = phrase;
+  while (1) {
+    word = p;
+    while (*p && *p != SPACE) p++;
+    if (!LexEntryPrefixAppend(prefix, &len, word, p-word)) return;
+    flags = (long)HashTableGet(pht, prefix);
+    if (*p == TERM) {
+      HashTableSetDup(pht, prefix, (void *)(flags | LEPREFIX_PHRASE));
+      return;
+    }
+    HashTableSetDup(pht, prefix, (void *)(flags | LEPREFIX_WORDS));
+    p++;
+  }
+}
+
 HashTable *LexEntryHtFlip(HashTable *ht)
 {
   if (EnglishIndex == ht) return(FrenchIndex);
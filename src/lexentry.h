@@ -16,6 +16,8 @@ Bool FeatureDefaultTo(char *features, int maxlen, char *ft, unsigned int def);
 int FeatureFlipLanguage(int lang);
 void FeatureCopyIn(char *in, char *set, char *out);
 void FeatureCheck(char *features, char *set, char *context);
+Obj *FeatToCon2(int feature);
+void FeatToConInit(void);
 Obj *FeatToCon1(int feature);
 Obj *FeatToCon(int feature);
 int ConToFeat(Obj *obj);
@@ -62,6 +64,9 @@ LexEntry *LexEntryFind(char *srcphrase, char *features, HashTable *ht);
 HashTable *LexEntryLangHt(char *features);
 HashTable *LexEntryLangHt1(int lang);
 int LexEntryHtLang(HashTable *ht);
+HashTable *LexEntryPrefixIndex(HashTable *ht);
+Bool LexEntryPrefixAppend(char *prefix, int *prefix_len, char *word, int len);
+void LexEntryPrefixIndexPhrase(HashTable *ht, char *phrase);
 HashTable *LexEntryHtFlip(HashTable *ht);
 LexEntry *LexEntryFindInfl1(char *word, char *features, HashTable *ht);
 LexEntry *LexEntryFindInfl(char *word, char *features, HashTable *ht, int lowering_ok);
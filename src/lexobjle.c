@@ -54,9 +54,9 @@ void ObjToLexEntryClearLastused(ObjToLexEntry *ole, Discourse *dc)
 
 Bool FeatureTaskOK(char *features, Obj *task)
 {
-  if (task == N("parse")) {
+  if (task == N_parse) {
     return(!StringIn(F_TRANS_ONLY, features));
-  } else if (task == N("generate")) {
+  } else if (task == N_generate) {
     return(!StringIn(F_TRANS_ONLY, features));
   } else if (task == N("translate")) {
     return(1);
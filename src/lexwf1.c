@@ -34,7 +34,7 @@ Bool		WordFormTrained;
 
 void WordFormInit()
 {
-  WordFormHt = HashTableCreate(1009L);	/* todo: Increase size? */
+  WordFormHt = HashTableCreate(1009L, "WordFormHt");
   WordFormTrained = 0;
 }
 
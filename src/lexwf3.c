@@ -55,7 +55,7 @@ HashTable *WordFormAffixFindTrain(int prefix, Obj *class, char *features,
   LexEntry	*le;
   HashTable	*ht;
   Word		*word;
-  ht = HashTableCreate(1021L);
+  ht = HashTableCreate(1021L, "WordFormAffix");
   for (le = AllLexEntries; le; le = le->next) {
     if ((!phrases_ok) && LexEntryIsPhrase(le)) continue;
     if (class && (!LexEntryConceptIsAncestor(class, le))) continue;
@@ -13,6 +13,9 @@
  * 19950329: moved general code here
  * 19950401: cosmetic changes to Demon
  * 19951024: to new context-based scheme
+ * 20261018T000000: discrimination tree of pattern demons
+ * 20261018T010000: heap of runnable subgoals for PA_Pass
+ * 20261018T030000: actors of sprouted Contexts are copied on first use
  *
  * todo:
  * - Convert all planning agents to use ADDO/GETO instead of fields of Subgoal.
@@ -29,6 +32,7 @@
 #include "pamtrans.h"
 #include "paphone.h"
 #include "paptrans.h"
+#include "repactor.h"
 #include "repbasic.h"
 #include "repcxt.h"
 #include "repdb.h"
@@ -104,6 +108,7 @@ Subgoal *PA_StartSubgoal(Context *cx, Ts *ts, Obj *actor, Subgoal *supergoal,
     SubgoalCreate(ac, actor, ts, supergoal, onsuccess, onfailure, subgoal,
                   ac->subgoals);
   SubgoalStatusChange(sg, N("active-goal"), NULL);
+  PA_QueueUpdate(sg);
   if (supergoal) {
     TOSTATE(cx, supergoal, STWAITING);
     /* The caller can reset this if desired. */
@@ -341,6 +346,128 @@ void DemonPrintAll(FILE *stream, Demon *d)
   }
 }
 
+/* Demon index
+ *
+ * The pattern demons of each Context are entered in a discrimination tree
+ * (cx->demon_index, keyed as in DemonIndexKey), so that an assertion is
+ * only matched against the demons whose predicate and first argument are
+ * variables or ancestors of its own (cf ObjMatchItem).
+ */
+
+long	DemonAssertions, DemonVisits, DemonFires;
+
+Obj *DemonIndexKey(Obj *elem)
+{
+  if (elem == NULL || ObjIsList(elem) || ObjIsVar(elem)) return(NULL);
+  return(elem);
+}
+
+void DemonIndexAdd(Context *cx, Subgoal *sg, Demon *d)
+{
+  Obj		*pred, *arg;
+  DemonPredNode	*pn;
+  DemonArgNode	*an;
+  DemonLeaf	*leaf;
+  pred = DemonIndexKey(I(d->ptn, 0));
+  arg = DemonIndexKey(I(d->ptn, 1));
+  for (pn = cx->demon_index; pn; pn = pn->next) {
+    if (pn->pred == pred) break;
+  }
+  if (pn == NULL) {
+    pn = CREATE(DemonPredNode);
+    pn->pred = pred;
+    pn->args = NULL;
+    pn->next = cx->demon_index;
+    cx->demon_index = pn;
+  }
+  for (an = pn->args; an; an = an->next) {
+    if (an->arg == arg) break;
+  }
+  if (an == NULL) {
+    an = CREATE(DemonArgNode);
+    an->arg = arg;
+    an->leaves = NULL;
+    an->next = pn->args;
+    pn->args = an;
+  }
+  leaf = CREATE(DemonLeaf);
+  leaf->demon = d;
+  leaf->sg = sg;
+  leaf->next = an->leaves;
+  an->leaves = leaf;
+}
+
+void DemonIndexRemove(Context *cx, Demon *d)
+{
+  Obj		*pred, *arg;
+  DemonPredNode	*pn, **pnp;
+  DemonArgNode	*an, **anp;
+  DemonLeaf	*leaf, **leafp;
+  pred = DemonIndexKey(I(d->ptn, 0));
+  arg = DemonIndexKey(I(d->ptn, 1));
+  for (pnp = &cx->demon_index; (pn = *pnp); pnp = &pn->next) {
+    if (pn->pred == pred) break;
+  }
+  if (pn == NULL) return;
+  for (anp = &pn->args; (an = *anp); anp = &an->next) {
+    if (an->arg == arg) break;
+  }
+  if (an == NULL) return;
+  for (leafp = &an->leaves; (leaf = *leafp); leafp = &leaf->next) {
+    if (leaf->demon == d) {
+      *leafp = leaf->next;
+      MemFree(leaf, "DemonLeaf");
+      break;
+    }
+  }
+  if (an->leaves == NULL) {
+    *anp = an->next;
+    MemFree(an, "DemonArgNode");
+  }
+  if (pn->args == NULL) {
+    *pnp = pn->next;
+    MemFree(pn, "DemonPredNode");
+  }
+}
+
+/* Sets the demon_mark of the subgoals of <cx> having a pattern demon which
+ * might match <assertion> to <mark>, and returns how many demons there
+ * are.
+ */
+long DemonIndexMark(Context *cx, Obj *assertion, long mark)
+{
+  long		r;
+  Obj		*pred, *arg;
+  DemonPredNode	*pn;
+  DemonArgNode	*an;
+  DemonLeaf	*leaf;
+  r = 0L;
+  pred = I(assertion, 0);
+  arg = I(assertion, 1);
+  for (pn = cx->demon_index; pn; pn = pn->next) {
+    if (pn->pred && !ISA(pn->pred, pred)) continue;
+    for (an = pn->args; an; an = an->next) {
+      if (an->arg && !ISA(an->arg, arg)) continue;
+      for (leaf = an->leaves; leaf; leaf = leaf->next) {
+        leaf->sg->demon_mark = mark;
+        r++;
+      }
+    }
+  }
+  return(r);
+}
+
+void DemonStatsPrint(FILE *stream)
+{
+  double	n;
+  n = (DemonAssertions > 0L) ? (double)DemonAssertions : 1.0;
+  fprintf(stream, "%ld assertion(s) tested against demons\n", DemonAssertions);
+  fprintf(stream, "%10ld pattern demon(s) visited %10.2f per assertion\n",
+          DemonVisits, DemonVisits/n);
+  fprintf(stream, "%10ld pattern demon(s) fired   %10.2f per assertion\n",
+          DemonFires, DemonFires/n);
+}
+
 void DemonSet(Context *cx, Subgoal *sg, Ts *ts, int tostate, Obj *ptn,
               Dur waitidle)
 {
@@ -352,6 +479,7 @@ void DemonSet(Context *cx, Subgoal *sg, Ts *ts, int tostate, Obj *ptn,
   d->waitidle = waitidle;
   d->next = sg->demons;
   sg->demons = d;
+  if (ptn) DemonIndexAdd(sg->ac->cx, sg, d);
   if (DbgOn(DBGPLAN, DBGDETAIL)) {
     fputs("SET ", Log);
     DemonPrint(Log, d);
@@ -365,6 +493,7 @@ void DemonClearAll(Context *cx, Subgoal *sg)
   while (sg->demons) {
     d = sg->demons;
     sg->demons = d->next;
+    if (d->ptn) DemonIndexRemove(sg->ac->cx, d);
     MemFree(d, "Demon");
   }
 }
@@ -413,11 +542,14 @@ Bool DemonPtnTest(Context *cx, Subgoal *sg, Obj *assertion)
 {
   Demon	*d;
   for (d = sg->demons; d; d = d->next) {
-    if (d->ptn && ObjMatchList(d->ptn, assertion)) {
+    if (d->ptn == NULL) continue;
+    DemonVisits++;
+    if (ObjMatchList(d->ptn, assertion)) {
       if (DbgOn(DBGPLAN, DBGDETAIL)) {
         fputs("FIRES ptn", Log);
         DemonPrint(Log, d);
       }
+      DemonFires++;
       sg->trigger = assertion;
       TOSTATE(cx, sg, d->tostate);
       DemonClearAll(cx, sg);
@@ -442,14 +574,30 @@ Bool DemonStop(Context *cx, Subgoal *sg)
   return(0);
 }
 
+/* Subgoals are still tested in actor and subgoal order, but only those
+ * marked by DemonIndexMark. A demon firing may assert the subgoal's new
+ * status, testing demons recursively (with another mark), so the marks are
+ * renewed after each firing.
+ */
+long	DemonMarkNext;
+
 void DemonPtnTestAll(Context *cx, Obj *assertion)
 {
-  Actor	*ac;
+  long		mark;
+  Actor		*ac;
   Subgoal	*sg;
-  for (ac = cx->actors; ac; ac = ac->next) {
+  if (cx->demon_index == NULL) return;
+  DemonAssertions++;
+  mark = ++DemonMarkNext;
+  if (0L == DemonIndexMark(cx, assertion, mark)) return;
+  for (ac = ContextActors(cx); ac; ac = ac->next) {
     for (sg = ac->subgoals; sg; sg = sg->next) {
+      if (sg->demon_mark != mark) continue;
       if (SubgoalStateIsStopped(sg->state)) continue;
-      if (sg->demons) DemonPtnTest(cx, sg, assertion);
+      if (sg->demons && DemonPtnTest(cx, sg, assertion)) {
+        mark = ++DemonMarkNext;
+        DemonIndexMark(cx, assertion, mark);
+      }
     }
   }
 }
@@ -558,14 +706,17 @@ void TOSTATE(Context *cx, Subgoal *sg, SubgoalState state)
     Dbg(DBGPLAN, DBGBAD, "attempt to revive stopped goal ignored");
     return;
   }
+  if (sg->ac && sg->ac->cx->pending) ContextActorsCopyChildren(sg->ac->cx);
   sg->last_state = sg->state;
   sg->state = state;
+  PA_QueueUpdate(sg);
   if (state == STSUCCESS) {
     SubgoalStatusChange(sg, N("succeeded-goal"), sg->success_causes);
     if (sg->supergoal) {
       if (TsLT(&sg->supergoal->ts, &sg->ts)) {
         Dbg(DBGPLAN, DBGDETAIL, "advancing supergoal ts", E);
         sg->supergoal->ts = sg->ts;
+        PA_QueueUpdate(sg->supergoal);
       }
       TOSTATE(cx, sg->supergoal, sg->onsuccess);
     }
@@ -623,6 +774,283 @@ void WAIT_IDLE(Context *cx, Subgoal *sg, Ts *ts, Dur waitidle, int tostate)
   TOSTATE(cx, sg, STWAITING);
 }
 
+/* Subgoal queue
+ *
+ * The subgoals of each Context are kept in a heap (cx->queue) ordered by
+ * timestamp and then by their order in cx->actors and ac->subgoals, so
+ * that PA_Pass need not rescan every subgoal of every actor. Each subgoal
+ * is in the heap at most once, at sg->queue_i, keyed on sg->queue_ts.
+ * TOSTATE and PA_StartSubgoal requeue subgoals as they change, and PA_Pass
+ * requeues each subgoal it runs. Planning agents also advance sg->ts
+ * directly, so an entry whose key is stale is requeued when it reaches
+ * the top (cf PA_QueueTop).
+ * Subgoals which cannot run in the current pass are set aside: deferred
+ * ones are requeued at the end of the pass, parked ones (not spinning)
+ * at the end of spinning (cf ContextClearSpin).
+ */
+
+long	PA_QueueOrderNext;
+
+/* Returns an order for a new actor or subgoal. Since these are pushed
+ * onto the front of their lists, list order is decreasing order.
+ */
+long PA_QueueOrder()
+{
+  return(++PA_QueueOrderNext);
+}
+
+/* Whether <sg1> comes before <sg2> in the actors and subgoals of their
+ * Context.
+ */
+Bool PA_QueuePrecedes(Subgoal *sg1, Subgoal *sg2)
+{
+  if (sg1->ac != sg2->ac) return(sg1->ac->order > sg2->ac->order);
+  return(sg1->order > sg2->order);
+}
+
+/* Subgoals with nonspecific timestamps come last. */
+Bool PA_QueueBefore(Subgoal *sg1, Subgoal *sg2)
+{
+  Bool	specific1, specific2;
+  specific1 = TsIsSpecific(&sg1->queue_ts);
+  specific2 = TsIsSpecific(&sg2->queue_ts);
+  if (specific1 != specific2) return(specific1);
+  if (specific1 && TsNE(&sg1->queue_ts, &sg2->queue_ts)) {
+    return(TsLT(&sg1->queue_ts, &sg2->queue_ts));
+  }
+  return(PA_QueuePrecedes(sg1, sg2));
+}
+
+SubgoalQueue *PA_QueueCreate(int maxlen)
+{
+  SubgoalQueue	*q;
+  q = CREATE(SubgoalQueue);
+  q->len = 0;
+  q->maxlen = maxlen < 16 ? 16 : maxlen;
+  q->heap = (Subgoal **)MemAlloc(q->maxlen*sizeof(Subgoal *), "Subgoal *");
+  q->numdeferred = q->maxdeferred = 0;
+  q->deferred = NULL;
+  q->numparked = q->maxparked = 0;
+  q->parked = NULL;
+  return(q);
+}
+
+void PA_QueueSet(SubgoalQueue *q, int i, Subgoal *sg)
+{
+  q->heap[i] = sg;
+  sg->queue_i = i;
+}
+
+void PA_QueueSiftUp(SubgoalQueue *q, int i)
+{
+  int		parent;
+  Subgoal	*sg;
+  sg = q->heap[i];
+  while (i > 0) {
+    parent = (i-1)/2;
+    if (!PA_QueueBefore(sg, q->heap[parent])) break;
+    PA_QueueSet(q, i, q->heap[parent]);
+    i = parent;
+  }
+  PA_QueueSet(q, i, sg);
+}
+
+void PA_QueueSiftDown(SubgoalQueue *q, int i)
+{
+  int		child;
+  Subgoal	*sg;
+  sg = q->heap[i];
+  while ((child = 2*i+1) < q->len) {
+    if (child+1 < q->len && PA_QueueBefore(q->heap[child+1], q->heap[child])) {
+      child++;
+    }
+    if (!PA_QueueBefore(q->heap[child], sg)) break;
+    PA_QueueSet(q, i, q->heap[child]);
+    i = child;
+  }
+  PA_QueueSet(q, i, sg);
+}
+
+void PA_QueueHeapify(SubgoalQueue *q)
+{
+  int	i;
+  for (i = q->len/2 - 1; i >= 0; i--) PA_QueueSiftDown(q, i);
+}
+
+void PA_QueueInsert(SubgoalQueue *q, Subgoal *sg)
+{
+  if (q->len >= q->maxlen) {
+    q->maxlen *= 2;
+    q->heap = (Subgoal **)MemRealloc(q->heap, q->maxlen*sizeof(Subgoal *),
+                                     "Subgoal *");
+  }
+  sg->queue_ts = sg->ts;
+  PA_QueueSet(q, q->len++, sg);
+  PA_QueueSiftUp(q, sg->queue_i);
+}
+
+void PA_QueueRemove(SubgoalQueue *q, Subgoal *sg)
+{
+  int		i;
+  Subgoal	*last;
+  if ((i = sg->queue_i) < 0) return;
+  sg->queue_i = QUEUENONE;
+  last = q->heap[--q->len];
+  if (last == sg) return;
+  PA_QueueSet(q, i, last);
+  PA_QueueSiftUp(q, i);
+  PA_QueueSiftDown(q, last->queue_i);
+}
+
+/* Sets <sg> aside in <*sgs> until PA_QueueRestore. */
+void PA_QueueAside(Subgoal *sg, int queue_i, /* RESULTS */ Subgoal ***sgs,
+                   int *num, int *max)
+{
+  if (*num >= *max) {
+    *max = *max ? 2*(*max) : 16;
+    if (*sgs) {
+      *sgs = (Subgoal **)MemRealloc(*sgs, (*max)*sizeof(Subgoal *),
+                                    "Subgoal *");
+    } else {
+      *sgs = (Subgoal **)MemAlloc((*max)*sizeof(Subgoal *), "Subgoal *");
+    }
+  }
+  (*sgs)[(*num)++] = sg;
+  sg->queue_i = queue_i;
+}
+
+/* Requeues the deferred subgoals and, if <parked>, the parked ones. */
+void PA_QueueRestore(SubgoalQueue *q, Bool parked)
+{
+  int	i;
+  for (i = 0; i < q->numdeferred; i++) {
+    q->deferred[i]->queue_i = QUEUENONE;
+    if (SubgoalStateIsStopped(q->deferred[i]->state)) continue;
+    PA_QueueInsert(q, q->deferred[i]);
+  }
+  q->numdeferred = 0;
+  if (!parked) return;
+  for (i = 0; i < q->numparked; i++) {
+    q->parked[i]->queue_i = QUEUENONE;
+    if (SubgoalStateIsStopped(q->parked[i]->state)) continue;
+    PA_QueueInsert(q, q->parked[i]);
+  }
+  q->numparked = 0;
+}
+
+/* Called when <sg> is started, is run, or changes state or timestamp. */
+void PA_QueueUpdate(Subgoal *sg)
+{
+  SubgoalQueue	*q;
+  if (sg->ac == NULL || !(q = sg->ac->cx->queue)) return;
+  if (SubgoalStateIsStopped(sg->state)) {
+    PA_QueueRemove(q, sg);
+    return;
+  }
+  if (sg->queue_i == QUEUENONE) {
+    PA_QueueInsert(q, sg);
+  } else if (sg->queue_i >= 0) {
+    sg->queue_ts = sg->ts;
+    PA_QueueSiftUp(q, sg->queue_i);
+    PA_QueueSiftDown(q, sg->queue_i);
+  }
+  /* Deferred and parked subgoals are keyed anew by PA_QueueRestore. */
+}
+
+/* Builds the queue of <cx> from its actors, the first time PA_Pass
+ * is run on it.
+ */
+SubgoalQueue *PA_QueueBuild(Context *cx)
+{
+  int		len;
+  Actor		*ac;
+  Subgoal	*sg;
+  SubgoalQueue	*q;
+  len = 0;
+  for (ac = ContextActors(cx); ac; ac = ac->next) {
+    for (sg = ac->subgoals; sg; sg = sg->next) len++;
+  }
+  q = PA_QueueCreate(len);
+  for (ac = ContextActors(cx); ac; ac = ac->next) {
+    for (sg = ac->subgoals; sg; sg = sg->next) {
+      sg->queue_i = QUEUENONE;
+      if (SubgoalStateIsStopped(sg->state)) continue;
+      sg->queue_ts = sg->ts;
+      PA_QueueSet(q, q->len++, sg);
+    }
+  }
+  PA_QueueHeapify(q);
+  return(q);
+}
+
+void PA_QueueCopy1(SubgoalQueue *q, Subgoal **sgs, int num)
+{
+  int		i;
+  Subgoal	*sg;
+  for (i = 0; i < num; i++) {
+    if (!(sg = sgs[i]->child_copy)) continue;
+    if (SubgoalStateIsStopped(sg->state)) continue;
+    sg->queue_ts = sg->ts;
+    PA_QueueSet(q, q->len++, sg);
+  }
+}
+
+/* Called by ContextSprout once the subgoals of <cx_parent> have been copied
+ * to <cx_child> (cf sg->child_copy). The copies of the actors and subgoals
+ * are in reverse order, so the heap is rebuilt. Nothing is spinning in a
+ * new Context, so the parked subgoals are requeued.
+ */
+SubgoalQueue *PA_QueueCopy(Context *cx_parent, Context *cx_child)
+{
+  SubgoalQueue	*q, *q_parent;
+  if (!(q_parent = cx_parent->queue)) return(NULL);
+  q = PA_QueueCreate(q_parent->len+q_parent->numdeferred+
+                     q_parent->numparked);
+  PA_QueueCopy1(q, q_parent->heap, q_parent->len);
+  PA_QueueCopy1(q, q_parent->deferred, q_parent->numdeferred);
+  PA_QueueCopy1(q, q_parent->parked, q_parent->numparked);
+  PA_QueueHeapify(q);
+  return(q);
+}
+
+/* Returns the first subgoal of <cx> eligible to run, or NULL. Stopped
+ * subgoals are dropped and subgoals which cannot run in the current mode
+ * are set aside. Sets <*depends_on_now> if the first subgoal has yet
+ * to occur.
+ */
+Subgoal *PA_QueueTop(Context *cx, Ts *now, /* RESULTS */ int *depends_on_now)
+{
+  Subgoal	*sg;
+  SubgoalQueue	*q;
+  q = cx->queue;
+  while (q->len > 0) {
+    sg = q->heap[0];
+    if (SubgoalStateIsStopped(sg->state)) {
+      PA_QueueRemove(q, sg);
+    } else if (TsNE(&sg->queue_ts, &sg->ts)) {
+      sg->queue_ts = sg->ts;
+      PA_QueueSiftDown(q, 0);
+      PA_QueueSiftUp(q, sg->queue_i);
+    } else if (!ActorIsAnimal(sg->ac)) {
+      PA_QueueRemove(q, sg);
+      PA_QueueAside(sg, QUEUEDEFERRED, &q->deferred, &q->numdeferred,
+                    &q->maxdeferred);
+    } else if (cx->mode == MODE_SPINNING && sg->spin_to_state == STNOSPIN) {
+      PA_QueueRemove(q, sg);
+      PA_QueueAside(sg, QUEUEPARKED, &q->parked, &q->numparked,
+                    &q->maxparked);
+    } else if (!TsIsSpecific(&sg->ts)) {
+      return(NULL);
+    } else if (cx->mode == MODE_PERFORMANCE && TsGT(&sg->ts, now)) {
+      if (depends_on_now) *depends_on_now = 1;
+      return(NULL);
+    } else {
+      return(sg);
+    }
+  }
+  return(NULL);
+}
+
 /* PLANNING CONTROL STRUCTURE */
 
 int PlanNoActivity;
@@ -657,22 +1085,6 @@ void Daydream()
   PA_MainLoop(StdDiscourse->cx_best, MODE_DAYDREAMING);
 }
 
-Bool PA_SubgoalIneligible(Context *cx, Subgoal *sg, Ts *now,
-                          /* RESULTS */ int *depends_on_now)
-{
-  if (SubgoalStateIsStopped(sg->state)) {
-    return(1);
-  }
-  if (cx->mode == MODE_PERFORMANCE && TsGT(&sg->ts, now)) {
-    if (depends_on_now) *depends_on_now = 1;
-    return(1);
-  }
-  if (cx->mode == MODE_SPINNING && sg->spin_to_state == STNOSPIN) {
-    return(1);
-  }
-  return(0);
-}
-
 Bool PA_SpinIsFinished(Context *cx, Subgoal *sg)
 {
   if (cx->mode == MODE_SPINNING &&
@@ -700,35 +1112,32 @@ void PA_AdvanceStoryTime(Context *cx)
 #endif
 }
 
+/* Runs the subgoals with the lowest timestamp, in the order of the actors
+ * and subgoals of <cx> (cf PA_QueueTop). A subgoal reaching that timestamp
+ * during the pass is run in the same pass only if it comes after those
+ * already run.
+ */
 Bool PA_Pass(Context *cx)
 {
   int		depends_on_now;
   Bool		activity;
   Ts		lowestts, now;
-  Actor	*ac;
-  Subgoal	*sg;
+  Subgoal	*sg, *last;
   activity = 0;
   Dbg(DBGPLAN, DBGHYPER, "PA_Pass");
   TsSetNow(&now);
-  TsSetNa(&lowestts);
   depends_on_now = 0;
-  for (ac = cx->actors; ac; ac = ac->next) {
-    if (!ISA(N("animal"), ac->actor)) continue;
-    for (sg = ac->subgoals; sg; sg = sg->next) {
-      if (PA_SubgoalIneligible(cx, sg, &now, &depends_on_now)) continue;
-      if ((!TsIsSpecific(&lowestts)) || TsLT(&sg->ts, &lowestts)) {
-        lowestts = sg->ts;
-      }
-    }
-  }
-
-  if (!TsIsSpecific(&lowestts)) {
+  ContextActors(cx);	/* copies the actors of a sprouted Context */
+  if (cx->queue == NULL) cx->queue = PA_QueueBuild(cx);
+  PA_QueueRestore(cx->queue, 0);
+  if (!(sg = PA_QueueTop(cx, &now, &depends_on_now))) {
     if (depends_on_now) {
       goto exit1;
     } else {
       goto exit0;
     }
   }
+  lowestts = sg->ts;
   if (DbgOn(DBGPLAN, DBGDETAIL)) {
     Dbg(DBGPLAN, DBGDETAIL, "lowestts:");
     TsPrint(Log, &lowestts);
@@ -739,22 +1148,26 @@ Bool PA_Pass(Context *cx)
     ContextPrint(Log, cx);
   }
   cx->story_time.stopts = lowestts;
-  for (ac = cx->actors; ac; ac = ac->next) {
-    if (!ISA(N("animal"), ac->actor)) continue;
-    for (sg = ac->subgoals; sg; sg = sg->next) {
-      if (PA_SubgoalIneligible(cx, sg, &now, NULL)) continue;
-      if (TsEQ(&sg->ts, &lowestts)) {
-        if (PA_SpinIsFinished(cx, sg)) {
-          goto exit0;
-        }
-        if (PA_RunSubgoal(cx, sg)) {
-          activity = 1;
-          sg->lastts = sg->ts;
-        }
-        if (PA_SpinIsFinished(cx, sg)) {
-          goto exit0;
-        }
-      }
+  last = NULL;
+  while ((sg = PA_QueueTop(cx, &now, NULL)) && TsEQ(&sg->ts, &lowestts)) {
+    PA_QueueRemove(cx->queue, sg);
+    if (last && !PA_QueuePrecedes(last, sg)) {
+      PA_QueueAside(sg, QUEUEDEFERRED, &cx->queue->deferred,
+                    &cx->queue->numdeferred, &cx->queue->maxdeferred);
+      continue;
+    }
+    last = sg;
+    if (PA_SpinIsFinished(cx, sg)) {
+      PA_QueueUpdate(sg);
+      goto exit0;
+    }
+    if (PA_RunSubgoal(cx, sg)) {
+      activity = 1;
+      sg->lastts = sg->ts;
+    }
+    PA_QueueUpdate(sg);
+    if (PA_SpinIsFinished(cx, sg)) {
+      goto exit0;
     }
   }
   if (activity) PlanNoActivity = 0;
@@ -764,11 +1177,13 @@ Bool PA_Pass(Context *cx)
     goto exit0;
   }
 exit1:
+  PA_QueueRestore(cx->queue, 0);
 #ifdef MICRO
   PA_AdvanceStoryTime(cx);
 #endif
   return(1);
 exit0:
+  PA_QueueRestore(cx->queue, 0);
 #ifdef MICRO
   PA_AdvanceStoryTime(cx);
 #endif
@@ -3,6 +3,11 @@ Subgoal *PA_StartSubgoal(Context *cx, Ts *ts, Obj *actor, Subgoal *supergoal, in
 Bool PA_RunSubgoal(Context *cx, Subgoal *sg);
 void DemonPrint(FILE *stream, Demon *d);
 void DemonPrintAll(FILE *stream, Demon *d);
+Obj *DemonIndexKey(Obj *elem);
+void DemonIndexAdd(Context *cx, Subgoal *sg, Demon *d);
+void DemonIndexRemove(Context *cx, Demon *d);
+long DemonIndexMark(Context *cx, Obj *assertion, long mark);
+void DemonStatsPrint(FILE *stream);
 void DemonSet(Context *cx, Subgoal *sg, Ts *ts, int tostate, Obj *ptn, Dur waitidle);
 void DemonClearAll(Context *cx, Subgoal *sg);
 int DemonTsTest(Context *cx, Subgoal *sg, Bool *pending);
@@ -21,9 +26,25 @@ void TOSTATE(Context *cx, Subgoal *sg, SubgoalState state);
 void WAIT_TS(Context *cx, Subgoal *sg, Ts *ts, Dur dur, int tostate);
 Bool WAIT_PTN(Context *cx, Subgoal *sg, int immed_check, int tostate, Obj *ptn);
 void WAIT_IDLE(Context *cx, Subgoal *sg, Ts *ts, Dur waitidle, int tostate);
+long PA_QueueOrder(void);
+Bool PA_QueuePrecedes(Subgoal *sg1, Subgoal *sg2);
+Bool PA_QueueBefore(Subgoal *sg1, Subgoal *sg2);
+SubgoalQueue *PA_QueueCreate(int maxlen);
+void PA_QueueSet(SubgoalQueue *q, int i, Subgoal *sg);
+void PA_QueueSiftUp(SubgoalQueue *q, int i);
+void PA_QueueSiftDown(SubgoalQueue *q, int i);
+void PA_QueueHeapify(SubgoalQueue *q);
+void PA_QueueInsert(SubgoalQueue *q, Subgoal *sg);
+void PA_QueueRemove(SubgoalQueue *q, Subgoal *sg);
+void PA_QueueAside(Subgoal *sg, int queue_i, Subgoal ***sgs, int *num, int *max);
+void PA_QueueRestore(SubgoalQueue *q, Bool parked);
+void PA_QueueUpdate(Subgoal *sg);
+SubgoalQueue *PA_QueueBuild(Context *cx);
+void PA_QueueCopy1(SubgoalQueue *q, Subgoal **sgs, int num);
+SubgoalQueue *PA_QueueCopy(Context *cx_parent, Context *cx_child);
+Subgoal *PA_QueueTop(Context *cx, Ts *now, int *depends_on_now);
 void PA_MainLoop(Context *cx, int mode);
 void Daydream(void);
-Bool PA_SubgoalIneligible(Context *cx, Subgoal *sg, Ts *now, int *depends_on_now);
 Bool PA_SpinIsFinished(Context *cx, Subgoal *sg);
 Bool PA_Pass(Context *cx);
 void PA_SpinTo(Context *cx, Subgoal *sg, int spin_to_state);
@@ -5,6 +5,7 @@
  */
 
 #include "tt.h"
+#include "pa.h"
 #include "repactor.h"
 #include "repbasic.h"
 #include "repcxt.h"
@@ -100,7 +101,9 @@ Actor *ActorCreate(Obj *actor, Context *cx, Actor *next)
   ac->emotions = NULL;
   ac->friends = NULL;
   ac->appointment_cur = NULL;
-  if (ISA(N("animal"), actor)) {
+  ac->order = PA_QueueOrder();
+  ac->animal_epoch = IsaLinkEpoch;
+  if ((ac->animal = ISA(N("animal"), actor))) {
     ac->rest_level = L(N("restedness"), actor, D(1.0), E);
     ac->energy_level = L(N("energy"), actor, D(1.0), E);
   } else {
@@ -148,6 +151,11 @@ Actor *ActorCopy(Actor *ac_parent, Context *cx_parent, Context *cx_child,
      * They were not asserted last time I checked.
      */
 
+  ac_child->order = -ac_parent->order;
+    /* ActorCopyAll reverses the order of the actors. */
+  ac_child->animal = ac_parent->animal;
+  ac_child->animal_epoch = ac_parent->animal_epoch;
+
   ac_child->cx = cx_child;
   ac_child->next = next;
 
@@ -169,6 +177,15 @@ Actor *ActorCopyAll(Actor *ac_parent, Context *cx_parent, Context *cx_child)
   return(ac_children);
 }
 
+Bool ActorIsAnimal(Actor *ac)
+{
+  if (ac->animal_epoch != IsaLinkEpoch) {
+    ac->animal = ISA(N("animal"), ac->actor);
+    ac->animal_epoch = IsaLinkEpoch;
+  }
+  return(ac->animal);
+}
+
 ObjList *ActorFindSubgoalsHead(Actor *ac, Obj *head_class)
 {
   Subgoal	*sg;
@@ -6,6 +6,7 @@ void AntecedentRefresh(Antecedent *an, Obj *obj, PNode *pn, PNode *pn_top, int g
 Actor *ActorCreate(Obj *actor, Context *cx, Actor *next);
 Actor *ActorCopy(Actor *ac_parent, Context *cx_parent, Context *cx_child, Actor *next);
 Actor *ActorCopyAll(Actor *ac_parent, Context *cx_parent, Context *cx_child);
+Bool ActorIsAnimal(Actor *ac);
 ObjList *ActorFindSubgoalsHead(Actor *ac, Obj *head_class);
 void ActorPrint(FILE *stream, Actor *ac);
 void ActorPrintAll(FILE *stream, Actor *actors);
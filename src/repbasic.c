@@ -15,6 +15,10 @@
  * 19981108T132215: timestamp mods
  * 19981112T075423: changed gets to fgets
  * 19981115T075312: added FileTemp
+ * 20261017T120000: full-key open addressing HashTable
+ * 20261017T140000: load arena for snapshots
+ * 20261017T160000: KB and per-request scratch arenas
+ * 20261017T200000: database mutex for the threaded server
  */
 
 #include "tt.h"
@@ -428,136 +432,182 @@ void CharPutN(FILE *stream, int c, int n)
 
 /* HashTable */
 
-/*
-int HashTableHash(HashTable *ht, char *symbol)
-{
-  unsigned char s[HASHSIG];
-
-  memset(s, 0, 6);
-  memcpy(s, symbol, (size_t)IntMin((int)strlen((char *)symbol), 6));
-  return((int)(((s[1] + s[5] + (s[0]+s[4])*(long)256) +
-                (s[3] + s[2]*(long)256)*(long)481) % ht->size));
-}
-*/
+HashTable *HashTables;
 
-int HashTableHash(HashTable *ht, char *symbol)
+/* FNV-1a over the full symbol. (The former hash looked at only the first
+ * 6 characters, so names such as "media-object-..." all collided.)
+ */
+unsigned long HashTableHash(char *symbol)
 {
-  unsigned char s[HASHSIG];
-  size_t len;
+  register unsigned char	*s;
+  register unsigned long	h;
 
-  len = (size_t)strlen(symbol);
-  if (len > 6) len = 6L;
-  memset(s, 0, 6);
-  memcpy(s, symbol, (size_t)len);
-  return((int)(((s[1] + s[5] + (s[0]+s[4])*(long)256) +
-                (s[3] + s[2]*(long)256)*(long)481) % ht->size));
+  h = 2166136261UL;
+  for (s = (unsigned char *)symbol; *s; s++) {
+    h = (h ^ *s) * 16777619UL;
+  }
+  return(h & 0xffffffffUL);
 }
 
-HashTable *HashTableCreate(size_t size)
+HashTable *HashTableCreate(size_t size, char *name)
 {
   HashTable	*ht;
-  int		i;
-
-  ht = (HashTable *)MemAlloc(sizeof(int)+size*sizeof(HashEntry *), "HashTable");
-  ht->size = size;
-  for (i = 0; i < size; i++) ht->hashentries[i] = NULL;
+  size_t	i;
+
+  ht = CREAT(HashTable, 1);
+  ht->name = name;
+  for (ht->size = 16; ht->size < size; ht->size <<= 1);
+  ht->count = 0;
+  ht->hashentries = (HashEntry *)MemAlloc1(ht->size*sizeof(HashEntry),
+                                           "HashEntry", 1);
+  for (i = 0; i < ht->size; i++) ht->hashentries[i].symbol = NULL;
+  ht->next = HashTables;
+  HashTables = ht;
   return(ht);
 }
 
-void *HashTableGet(HashTable *ht, char *symbol)
+/* Returns the slot containing <symbol>, or the unused slot where it
+ * would be entered.
+ */
+HashEntry *HashTableSlot(HashTable *ht, char *symbol, unsigned long hash)
 {
   register HashEntry	*he;
+  register size_t	i, mask;
 
-  for (he = ht->hashentries[HashTableHash(ht, symbol)]; he; he = he->next) {
-    if (symbol[0] == he->symbol[0] && 0 == strcmp(symbol, he->symbol)) {
-      return(he->value);
-    }
+  mask = ht->size - 1;
+  for (i = hash & mask; ; i = (i + 1) & mask) {
+    he = &ht->hashentries[i];
+    if (he->symbol == NULL) return(he);
+    if (he->hash == hash && 0 == strcmp(symbol, he->symbol)) return(he);
   }
-  return(NULL);
 }
 
-char *HashTableIntern(HashTable *ht, char *symbol)
+void HashTableGrow(HashTable *ht)
 {
-  register HashEntry	*he;
-  int			i;
+  HashEntry	*old, *he;
+  size_t	i, oldsize;
 
-  i = HashTableHash(ht, symbol);
-  for (he = ht->hashentries[i]; he; he = he->next) {
-    if (symbol[0] == he->symbol[0] && 0 == strcmp(symbol, he->symbol)) {
-      return(he->symbol);
-    }
+  old = ht->hashentries;
+  oldsize = ht->size;
+  ht->size = oldsize << 1;
+  ht->hashentries = (HashEntry *)MemAlloc1(ht->size*sizeof(HashEntry),
+                                           "HashEntry", 1);
+  for (i = 0; i < ht->size; i++) ht->hashentries[i].symbol = NULL;
+  for (i = 0; i < oldsize; i++) {
+    if (old[i].symbol == NULL) continue;
+    he = HashTableSlot(ht, old[i].symbol, old[i].hash);
+    *he = old[i];
   }
-  he = CREATE(HashEntry);
-  he->symbol = StringCopy(symbol, "char HashTableIntern");
-  he->value = NULL;
-  he->next = ht->hashentries[i];
-  ht->hashentries[i] = he;
+  MemFree(old, "HashEntry");
+}
+
+/* Enters <symbol> in the unused slot <he> and returns the (possibly moved)
+ * entry.
+ */
+HashEntry *HashTableEnter(HashTable *ht, HashEntry *he, char *symbol,
+                          unsigned long hash, void *value)
+{
+  MemScratchPin(symbol);
+  MemScratchPin(value);
+  he->symbol = symbol;
+  he->value = value;
+  he->hash = hash;
+  ht->count++;
+  if (ht->count > (size_t)(HASHMAXLOAD*ht->size)) {
+    HashTableGrow(ht);
+    he = HashTableSlot(ht, symbol, hash);
+  }
+  return(he);
+}
+
+void *HashTableGet(HashTable *ht, char *symbol)
+{
+  HashEntry	*he;
+  he = HashTableSlot(ht, symbol, HashTableHash(symbol));
+  return(he->symbol ? he->value : NULL);
+}
+
+char *HashTableIntern(HashTable *ht, char *symbol)
+{
+  HashEntry	*he;
+  unsigned long	hash;
+
+  hash = HashTableHash(symbol);
+  he = HashTableSlot(ht, symbol, hash);
+  if (he->symbol) return(he->symbol);
+  MemScratchSuspend();
+  he = HashTableEnter(ht, he, StringCopy(symbol, "char HashTableIntern"),
+                      hash, NULL);
+  MemScratchResume();
   return(he->symbol);
 }
 
 void HashTableSet(HashTable *ht, char *symbol, void *value)
 {
-  register HashEntry	*he;
-  int			i;
+  HashEntry	*he;
+  unsigned long	hash;
 
-  i = HashTableHash(ht, symbol);
-  for (he = ht->hashentries[i]; he; he = he->next) {
-    if (symbol[0] == he->symbol[0] && 0 == strcmp(symbol, he->symbol)) {
-      he->value = value;
-      return;
-    }
+  hash = HashTableHash(symbol);
+  he = HashTableSlot(ht, symbol, hash);
+  if (he->symbol) {
+    MemScratchPin(value);
+    he->value = value;
+    return;
   }
-  he = CREATE(HashEntry);
-  he->symbol = symbol;
-  he->value = value;
-  he->next = ht->hashentries[i];
-  ht->hashentries[i] = he;
+  HashTableEnter(ht, he, symbol, hash, value);
 }
 
 void HashTableSetDup(HashTable *ht, char *symbol, void *value)
 {
-  register HashEntry	*he;
-  int			i;
+  HashEntry	*he;
+  unsigned long	hash;
 
-  i = HashTableHash(ht, symbol);
-  for (he = ht->hashentries[i]; he; he = he->next) {
-    if (symbol[0] == he->symbol[0] && 0 == strcmp(symbol, he->symbol)) {
-      he->value = value;
-      return;
-    }
+  hash = HashTableHash(symbol);
+  he = HashTableSlot(ht, symbol, hash);
+  if (he->symbol) {
+    MemScratchPin(value);
+    he->value = value;
+    return;
   }
-  he = CREATE(HashEntry);
-  he->symbol = StringCopy(symbol, "char HashTableSetDup");
-  he->value = value;
-  he->next = ht->hashentries[i];
-  ht->hashentries[i] = he;
+  MemScratchSuspend();
+  HashTableEnter(ht, he, StringCopy(symbol, "char HashTableSetDup"), hash,
+                 value);
+  MemScratchResume();
 }
 
+/* <fn> must not add entries to <ht>. */
 void HashTableForeach(HashTable *ht, void (fn)())
 {
-  int		i;
+  size_t	i;
   HashEntry	*he;
 
   for (i = 0; i < ht->size; i++) {
-    for (he = ht->hashentries[i]; he; he = he->next) {
-      (fn)(he->symbol, he->value);
-    }
+    he = &ht->hashentries[i];
+    if (he->symbol) (fn)(he->symbol, he->value);
   }
 }
 
+/* Empties <ht>. Freeing symbols and values is up to the caller. */
+void HashTableClear(HashTable *ht)
+{
+  size_t	i;
+
+  for (i = 0; i < ht->size; i++) ht->hashentries[i].symbol = NULL;
+  ht->count = 0;
+}
+
 void HashTablePrint(FILE *stream, HashTable *ht)
 {
-  int	i;
+  size_t	i;
   HashEntry	*he;
 
   for (i = 0; i < ht->size; i++) {
-    he = ht->hashentries[i];
-    if (he == NULL) {
-      fprintf(stream, "%d: unused\n", i);
+    he = &ht->hashentries[i];
+    if (he->symbol == NULL) {
+      fprintf(stream, "%ld: unused\n", (long)i);
     } else {
-      for (; he; he = he->next) {
-        fprintf(stream, "%d 0x%p: 0x%p %s\n", i, he, he->symbol, he->symbol);
-      }
+      fprintf(stream, "%ld %lx: 0x%p %s\n", (long)i, he->hash, he->symbol,
+              he->symbol);
     }
   }
 }
@@ -570,6 +620,50 @@ void pht(HashTable *ht)
   fputc(NEWLINE, Log);
 }
 
+#define HASHSTATMAX	10
+
+/* Prints the load factor and a histogram of probe lengths (the number of
+ * slots examined to find each entry) for <ht>.
+ */
+void HashTableStats(FILE *stream, HashTable *ht)
+{
+  size_t	i, home, probes, maxprobes, total;
+  long		hist[HASHSTATMAX+1];
+  HashEntry	*he;
+
+  for (i = 0; i <= HASHSTATMAX; i++) hist[i] = 0L;
+  maxprobes = total = 0;
+  for (i = 0; i < ht->size; i++) {
+    he = &ht->hashentries[i];
+    if (he->symbol == NULL) continue;
+    home = he->hash & (ht->size - 1);
+    probes = 1 + ((i + ht->size - home) & (ht->size - 1));
+    total += probes;
+    if (probes > maxprobes) maxprobes = probes;
+    hist[IntMin((int)probes, HASHSTATMAX)]++;
+  }
+  fprintf(stream, "%-16s %8ld entries %8ld slots load %.3f",
+          ht->name, (long)ht->count, (long)ht->size,
+          ((Float)ht->count)/(Float)ht->size);
+  fprintf(stream, " probes avg %.3f max %ld\n",
+          ht->count ? ((Float)total)/(Float)ht->count : 0.0,
+          (long)maxprobes);
+  fprintf(stream, "  probes:");
+  for (i = 1; i <= HASHSTATMAX; i++) {
+    if (i == HASHSTATMAX) fprintf(stream, " %ld+:%ld", (long)i, hist[i]);
+    else fprintf(stream, " %ld:%ld", (long)i, hist[i]);
+  }
+  fputc(NEWLINE, stream);
+}
+
+void HashTableStatsAll(FILE *stream)
+{
+  HashTable	*ht;
+  for (ht = HashTables; ht; ht = ht->next) {
+    HashTableStats(stream, ht);
+  }
+}
+
 /* File */
 
 void FileTemp(char *stem, int fn_len, /* OUTPUT */ char *fn)
@@ -1176,6 +1270,48 @@ void SleepMs(int ms)
   Sleep(ms / 1000);
 }
 
+/* Threads
+ *
+ * The database is otherwise single-threaded. When the server runs
+ * requests on several threads (ThreadsOn, cf toolsvr.c), the few places
+ * where a read-only request still updates shared state (the symbol table,
+ * the Objs list, the ISA cache) are wrapped in ThreadLock/ThreadUnlock.
+ * The lock is recursive, and is a no-op when ThreadsOn is 0.
+ */
+
+#ifdef GCC
+#include <pthread.h>
+pthread_mutex_t	ThreadMutex;
+#endif
+
+Bool		ThreadsOn;
+
+void ThreadInit()
+{
+#ifdef GCC
+  pthread_mutexattr_t	attr;
+  pthread_mutexattr_init(&attr);
+  pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+  pthread_mutex_init(&ThreadMutex, &attr);
+  pthread_mutexattr_destroy(&attr);
+#endif
+  ThreadsOn = 0;
+}
+
+void ThreadLock()
+{
+#ifdef GCC
+  if (ThreadsOn) pthread_mutex_lock(&ThreadMutex);
+#endif
+}
+
+void ThreadUnlock()
+{
+#ifdef GCC
+  if (ThreadsOn) pthread_mutex_unlock(&ThreadMutex);
+#endif
+}
+
 /* Mem */
 
 /* Three memory allocation alternatives are provided.
@@ -1196,6 +1332,8 @@ void SleepMs(int ms)
  * malloc will be used in this case.
  */
 
+/* Snapshots (tt -S/-L) additionally require (3). */
+
 /* Enable one of the below. MALLOC is a good starting point. */
 /*
 #define QALLOC
@@ -1221,6 +1359,256 @@ void *nofail_realloc(void *ptr, size_t size)
   return(r);
 }
 
+/* Arenas. Memory is carved out of an arena by bumping a pointer, and is
+ * released all at once rather than object by object.
+ *
+ * MemArenaKB: permanent arena for everything allocated while Starting,
+ * so that the loaded database is contiguous. It is mapped at a fixed
+ * address, so that it can be written out as is by tt -S and mapped back
+ * in at the same address by tt -L. cf utilsnap.c.
+ *
+ * MemArenaScratch: per-request arena for the PNodes, ObjLists, and
+ * temporary Objs of one request (cf MemScratchBegin), released in one
+ * shot at the end of the request; MemFree makes scratch memory available
+ * for reuse within the request (cf MemArenaFree). Allocations that must
+ * outlive the request either pass force_malloc to MemAlloc1, or are made
+ * between MemScratchSuspend and MemScratchResume. If scratch memory
+ * nonetheless gets linked into the database (cf MemScratchPin), the
+ * request's memory is kept.
+ *
+ * MemFree of KB memory does nothing.
+ */
+
+#ifdef GCC
+#include <sys/mman.h>
+#endif
+
+#define MEMARENAADDR	((char *)0x3f0000000000L)
+#define MEMARENAMAX	0x40000000L
+#define MEMSCRATCHMAX	0x40000000L
+#define MEMARENAALIGN	16L	/* also room for the size of the object */
+
+MemArena	MemArenaKB, MemArenaScratch;
+Bool		MemArenaReport;
+int		MemScratchDepth, MemScratchSuspended;
+Bool		MemScratchPinned;
+
+/* Reserves <max> bytes at <addr> (anywhere if NULL). Pages are only
+ * committed as they are used.
+ */
+Bool MemArenaCreate(MemArena *ma, char *name, char *addr, size_t max)
+{
+#ifdef GCC
+  char	*p;
+  p = mmap(addr, max, PROT_READ|PROT_WRITE,
+           MAP_PRIVATE|MAP_ANONYMOUS|MAP_NORESERVE, -1, 0);
+  if (p == MAP_FAILED) {
+    Dbg(DBGGEN, DBGBAD, "MemArenaCreate: %s: mmap failed", name);
+    return(0);
+  }
+  if (addr && p != addr) {
+    Dbg(DBGGEN, DBGBAD, "MemArenaCreate: %s: address in use", name);
+    munmap(p, max);
+    return(0);
+  }
+  ma->name = name;
+  ma->base = p;
+  ma->max = max;
+  ma->used = ma->floor = ma->high = ma->peak = 0;
+  memset(ma->freelist, 0, sizeof(ma->freelist));
+  ma->on = 1;
+  return(1);
+#else
+  Dbg(DBGGEN, DBGBAD, "MemArenaCreate: not supported on this platform");
+  return(0);
+#endif
+}
+
+/* Map <used> bytes of the KB arena previously written to <fd> at <offset>.
+ * The mapping is private, so that pointers can be fixed up and objects
+ * modified without touching the file.
+ */
+Bool MemArenaMap(MemArena *ma, int fd, long offset, size_t used)
+{
+#ifdef GCC
+  char	*p;
+  if (used == 0) return(1);
+  p = mmap(MEMARENAADDR, used, PROT_READ|PROT_WRITE, MAP_PRIVATE, fd,
+           (off_t)offset);
+  if (p == MAP_FAILED) {
+    Dbg(DBGGEN, DBGBAD, "MemArenaMap: mmap failed");
+    return(0);
+  }
+  if (p != MEMARENAADDR) {
+    Dbg(DBGGEN, DBGBAD, "MemArenaMap: address in use");
+    munmap(p, used);
+    return(0);
+  }
+  ma->name = "kb";
+  ma->base = p;
+  ma->max = ma->used = ma->floor = ma->high = ma->peak = used;
+  memset(ma->freelist, 0, sizeof(ma->freelist));
+  ma->on = 0;
+  return(1);
+#else
+  Dbg(DBGGEN, DBGBAD, "MemArenaMap: not supported on this platform");
+  return(0);
+#endif
+}
+
+/* Called by Init: tries for the KB arena at its fixed address, and falls
+ * back on malloc if it cannot be had.
+ */
+void MemArenaInit()
+{
+  MemArenaKB.base = MemArenaScratch.base = NULL;
+  MemArenaKB.on = MemArenaScratch.on = 0;
+  MemScratchDepth = MemScratchSuspended = 0;
+  MemScratchPinned = 0;
+  MemArenaCreate(&MemArenaKB, "kb", MEMARENAADDR, MEMARENAMAX);
+}
+
+void *MemArenaAlloc(MemArena *ma, size_t size)
+{
+  char		*r;
+  size_t	cls;
+  if ((size % MEMARENAALIGN) != 0) {
+    size += MEMARENAALIGN - (size % MEMARENAALIGN);
+  }
+  cls = size/MEMARENAALIGN;
+  if (cls < MEMARENACLASSES && (r = ma->freelist[cls])) {
+    ma->freelist[cls] = *((char **)r);
+    return((void *)r);
+  }
+  if (ma->used + size + MEMARENAALIGN > ma->max) {
+    Panic("Out of memory (arena).");
+  }
+  r = ma->base + ma->used;
+  ma->used += size + MEMARENAALIGN;
+  if (ma->used > ma->high) ma->high = ma->used;
+  *((size_t *)r) = size;
+  return((void *)(r + MEMARENAALIGN));
+}
+
+/* Makes <buffer> available again before <ma> is released: the last block
+ * allocated is given back, and other small blocks are kept on free lists
+ * by size. Memory already released is ignored.
+ */
+void MemArenaFree(MemArena *ma, void *buffer)
+{
+  char		*p;
+  size_t	size, cls;
+  p = (char *)buffer;
+  if (p < ma->base + ma->floor || p >= ma->base + ma->used) return;
+  size = MemArenaSize(buffer);
+  if (p + size == ma->base + ma->used) {
+    ma->used -= size + MEMARENAALIGN;
+    return;
+  }
+  cls = size/MEMARENAALIGN;
+  if (cls < MEMARENACLASSES) {
+    *((char **)p) = ma->freelist[cls];
+    ma->freelist[cls] = p;
+  }
+}
+
+/* Whether <buffer> was ever allocated out of <ma>, including memory since
+ * released.
+ */
+Bool MemArenaContains(MemArena *ma, void *buffer)
+{
+  return(ma->base != NULL &&
+         ((char *)buffer) >= ma->base &&
+         ((char *)buffer) < ma->base + ma->max);
+}
+
+size_t MemArenaSize(void *buffer)
+{
+  return(*((size_t *)(((char *)buffer) - MEMARENAALIGN)));
+}
+
+/* Scratch arena */
+
+void MemScratchOnSet()
+{
+  MemArenaScratch.on = MemScratchDepth > 0 && MemScratchSuspended == 0 &&
+                       MemArenaScratch.base != NULL;
+}
+
+/* Begins a request whose allocations may be released when it ends.
+ * Requests nest; memory is released when the outermost one ends.
+ */
+void MemScratchBegin()
+{
+  if (Starting) return;
+  if (MemArenaScratch.base == NULL &&
+      !MemArenaCreate(&MemArenaScratch, "scratch", NULL, MEMSCRATCHMAX)) {
+    return;
+  }
+  MemScratchDepth++;
+  MemScratchOnSet();
+}
+
+void MemScratchEnd(char *request)
+{
+  size_t	bytes;
+  if (MemScratchDepth <= 0) return;
+  if (--MemScratchDepth > 0) return;
+  bytes = MemArenaScratch.high - MemArenaScratch.floor;
+  if (bytes > MemArenaScratch.peak) MemArenaScratch.peak = bytes;
+  if (MemArenaReport) {
+    fprintf(Log, "arena %s: %s %ld bytes (peak %ld)%s, %s %ld bytes\n",
+            request, MemArenaScratch.name, (long)bytes,
+            (long)MemArenaScratch.peak,
+            MemScratchPinned ? " pinned" : "",
+            MemArenaKB.name ? MemArenaKB.name : "kb", (long)MemArenaKB.used);
+  }
+  if (MemScratchPinned) {
+    MemArenaScratch.floor = MemArenaScratch.used;
+    MemScratchPinned = 0;
+  } else {
+    MemArenaScratch.used = MemArenaScratch.floor;
+  }
+  MemArenaScratch.high = MemArenaScratch.used;
+  memset(MemArenaScratch.freelist, 0, sizeof(MemArenaScratch.freelist));
+  MemScratchOnSet();
+}
+
+/* Allocations between MemScratchSuspend and MemScratchResume outlive the
+ * current request.
+ */
+void MemScratchSuspend()
+{
+  MemScratchSuspended++;
+  MemScratchOnSet();
+}
+
+void MemScratchResume()
+{
+  if (MemScratchSuspended > 0) MemScratchSuspended--;
+  MemScratchOnSet();
+}
+
+/* Whether <buffer> is released at the end of the current request. */
+Bool MemScratchContains(void *buffer)
+{
+  return(MemArenaScratch.base != NULL &&
+         ((char *)buffer) >= MemArenaScratch.base + MemArenaScratch.floor &&
+         ((char *)buffer) < MemArenaScratch.base + MemArenaScratch.max);
+}
+
+/* Called when <buffer> is about to be linked into the database. If it is
+ * scratch memory, the current request's memory is kept rather than
+ * released.
+ */
+void MemScratchPin(void *buffer)
+{
+  if (MemScratchDepth > 0 && MemScratchContains(buffer)) {
+    Dbg(DBGGEN, DBGDETAIL, "scratch memory pinned");
+    MemScratchPinned = 1;
+  }
+}
+
 #ifdef QALLOC
 
 void MemCheckReset()
@@ -1516,23 +1904,45 @@ void MemCheckPrint()
 {
 }
 
+/* <force_malloc>: allocation must outlive the current request. */
 void *MemAlloc1(size_t size, char *typ, Bool force_malloc)
 {
+  if (Starting) {
+    if (MemArenaKB.on) return(MemArenaAlloc(&MemArenaKB, size));
+  } else if (MemArenaScratch.on && !force_malloc) {
+    return(MemArenaAlloc(&MemArenaScratch, size));
+  }
   return(nofail_malloc(size));
 }
 
 void *MemAlloc(size_t size, char *typ)
 {
-  return(nofail_malloc(size));
+  return(MemAlloc1(size, typ, 0));
 }
 
+/* Memory that outlives the current request continues to. */
 void *MemRealloc(void *buffer, size_t size, char *typ)
 {
+  void		*r;
+  size_t	oldsize;
+  if (MemArenaContains(&MemArenaKB, buffer) ||
+      MemArenaContains(&MemArenaScratch, buffer)) {
+    r = MemAlloc1(size, typ, !MemScratchContains(buffer));
+    oldsize = MemArenaSize(buffer);
+    memcpy(r, buffer, oldsize < size ? oldsize : size);
+    MemFree(buffer, typ);
+    return(r);
+  }
   return(nofail_realloc(buffer, size));
 }
 
 void MemFree(void *buffer, char *typ)
 {
+  if (MemArenaContains(&MemArenaKB, buffer)) return;
+  if (MemArenaContains(&MemArenaScratch, buffer)) {
+    MemArenaFree(&MemArenaScratch, buffer);
+    return;
+  }
   free(buffer);
 }
 
@@ -43,15 +43,21 @@ int CharToLower(int c);
 int CharDevoice(int c);
 int CharReduceVowel(int c);
 void CharPutN(FILE *stream, int c, int n);
-int HashTableHash(HashTable *ht, char *symbol);
-HashTable *HashTableCreate(size_t size);
+unsigned long HashTableHash(char *symbol);
+HashTable *HashTableCreate(size_t size, char *name);
+HashEntry *HashTableSlot(HashTable *ht, char *symbol, unsigned long hash);
+void HashTableGrow(HashTable *ht);
+HashEntry *HashTableEnter(HashTable *ht, HashEntry *he, char *symbol, unsigned long hash, void *value);
 void *HashTableGet(HashTable *ht, char *symbol);
 char *HashTableIntern(HashTable *ht, char *symbol);
 void HashTableSet(HashTable *ht, char *symbol, void *value);
 void HashTableSetDup(HashTable *ht, char *symbol, void *value);
 void HashTableForeach(HashTable *ht, void (fn)());
+void HashTableClear(HashTable *ht);
 void HashTablePrint(FILE *stream, HashTable *ht);
 void pht(HashTable *ht);
+void HashTableStats(FILE *stream, HashTable *ht);
+void HashTableStatsAll(FILE *stream);
 void FileTemp(char *stem, int fn_len, char *fn);
 void FileNameGen(char *stem, char *suffix, int fn_len, /* OUTPUT */ char *fn);
 FILE *StreamOpen(char *filename, char *mode);
@@ -94,8 +100,25 @@ Directory *DirectoryRead(char *dirfn);
 Directory *DirectoryReadEnv(char *dirfn);
 void Sleep(int secs);
 void SleepMs(int ms);
+void ThreadInit(void);
+void ThreadLock(void);
+void ThreadUnlock(void);
 void *nofail_malloc(size_t size);
 void *nofail_realloc(void *ptr, size_t size);
+Bool MemArenaCreate(MemArena *ma, char *name, char *addr, size_t max);
+Bool MemArenaMap(MemArena *ma, int fd, long offset, size_t used);
+void MemArenaInit(void);
+void *MemArenaAlloc(MemArena *ma, size_t size);
+void MemArenaFree(MemArena *ma, void *buffer);
+Bool MemArenaContains(MemArena *ma, void *buffer);
+size_t MemArenaSize(void *buffer);
+void MemScratchOnSet(void);
+void MemScratchBegin(void);
+void MemScratchEnd(char *request);
+void MemScratchSuspend(void);
+void MemScratchResume(void);
+Bool MemScratchContains(void *buffer);
+void MemScratchPin(void *buffer);
 void qallocInit(void);
 void MemCheckReset(void);
 void MemCheckPrint(void);
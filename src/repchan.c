@@ -57,6 +57,9 @@ void ChannelInit(Channel *ch)
   ch->pnf_holding_area = NULL;
   ch->synparse_pns = NULL;
   ch->synparse_pnnnext = 0;
+  ch->synparse_seqnext = 0L;
+  ch->synparse_startat = NULL;
+  ch->synparse_endat = NULL;
   ch->synparse_lowerb = 0L;
   ch->synparse_upperb = 0L;
   ch->synparse_sentences = 0;
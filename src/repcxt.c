@@ -2,6 +2,8 @@
  * ThoughtTreasure
  * Copyright 1996, 1997, 1998, 1999, 2015 Erik Thomas Mueller.
  * All Rights Reserved.
+ *
+ * 20261018T030000: copy-on-write actors and O(1) ContextIsAncestor
  */
 
 #include "tt.h"
@@ -29,8 +31,17 @@ void ContextInit()
 {
   Ts  ts;
   ContextCurrentDc = NULL;	/* todoTHREAD */
-  ContextNextTopId = 1L;
   TsSetNow(&ts);
+  if (SnapshotLoaded) {
+  /* ContextRoot comes from the snapshot, since the assertions in it point
+   * to ContextRoot. Only its story time is brought up to date.
+   */
+    ContextRoot->story_time.startts = ts;
+    ContextRoot->story_time.stopts = ts;
+    TsRangeSetContext(&ContextRoot->story_time, ContextRoot);
+    return;
+  }
+  ContextNextTopId = 1L;
   ContextRoot = NULL;
   ContextRoot = ContextCreate(&ts, 0, NULL, NULL);
 }
@@ -42,6 +53,7 @@ Context *ContextCreate(Ts *ts, TenseStep tensestep, Discourse *dc,
   cx = CREATE(Context);
 
   cx->parent = ContextRoot;
+  ContextPathSet(cx, cx->parent);
   cx->sense = SENSE_TOTAL;
   TsRangeSetNa(&cx->story_time);
   cx->story_time.startts = *ts;
@@ -50,6 +62,10 @@ Context *ContextCreate(Ts *ts, TenseStep tensestep, Discourse *dc,
   cx->story_time.cx = cx;
   cx->story_tensestep = tensestep;
   cx->actors = NULL;
+  cx->actors_pending = 0;
+  cx->pending = cx->pending_next = NULL;
+  cx->demon_index = NULL;
+  cx->queue = NULL;
   cx->last_question = NULL;
   cx->dc = dc;
   cx->next = next;
@@ -86,6 +102,7 @@ Context *ContextSprout(Context *parent, Obj *sproutcon, PNode *sproutpn,
   cx = CREATE(Context);
 
   cx->parent = parent;
+  ContextPathSet(cx, parent);
   cx->sense = parent->sense;
   cx->story_time = parent->story_time;
   TsRangeSetContext(&cx->story_time, cx);
@@ -118,12 +135,20 @@ Context *ContextSprout(Context *parent, Obj *sproutcon, PNode *sproutpn,
   cx->sproutpn = sproutpn;
 
   cx->actors = NULL;
+  cx->demon_index = NULL;	/* SubgoalCopy does not copy demons. */
+  cx->queue = NULL;
 
 #ifdef notdef
   ContextRepairChildAssertions(parent, cx);
 #endif
 
-  cx->actors = ActorCopyAll(parent->actors, parent, cx);
+  /* The actors are copied by ContextActors when first needed, since many
+   * alternatives are ruled out before they are.
+   */
+  cx->actors_pending = 1;
+  cx->pending = NULL;
+  cx->pending_next = parent->pending;
+  parent->pending = cx;
 
   Dbg(DBGPLAN, DBGDETAIL, "sprouted Context %ld", cx->id);
   if (DbgOn(DBGPLAN, DBGHYPER)) {
@@ -133,15 +158,83 @@ Context *ContextSprout(Context *parent, Obj *sproutcon, PNode *sproutpn,
   return(cx);
 }
 
+/* Sets the depth and path of <cx>, a new child of <parent>. The first child
+ * of <parent> to be created shares the path of <parent>; later children get
+ * a copy.
+ */
+void ContextPathSet(Context *cx, Context *parent)
+{
+  int		i;
+  ContextPath	*path;
+  if (parent == NULL) {
+    cx->depth = 0;
+    path = CREATE(ContextPath);
+    path->maxlen = 8;
+    path->cxs = (Context **)MemAlloc(path->maxlen*sizeof(Context *),
+                                     "Context* ContextPath");
+    path->len = 0;
+  } else {
+    cx->depth = parent->depth+1;
+    path = parent->path;
+    if (path->len != cx->depth) {
+      path = CREATE(ContextPath);
+      path->maxlen = cx->depth+8;
+      path->cxs = (Context **)MemAlloc(path->maxlen*sizeof(Context *),
+                                       "Context* ContextPath");
+      for (i = 0; i < cx->depth; i++) path->cxs[i] = parent->path->cxs[i];
+      path->len = cx->depth;
+    }
+  }
+  if (path->len >= path->maxlen) {
+    path->maxlen *= 2;
+    path->cxs = (Context **)MemRealloc(path->cxs,
+                                       path->maxlen*sizeof(Context *),
+                                       "Context* ContextPath");
+  }
+  path->cxs[path->len++] = cx;
+  cx->path = path;
+}
+
 Bool ContextIsAncestor(Context *anc, Context *des)
 {
   if (anc == NULL) anc = ContextRoot;
   if (des == NULL) des = ContextRoot;
-  while (1) {
-    if (des == NULL) return 0;
-    if (des == anc) return 1;
-    des = des->parent;
+  if (anc == NULL || des == NULL) return 0;
+  return(anc->depth <= des->depth && des->path->cxs[anc->depth] == anc);
+}
+
+/* Copies the actors and subgoals of the parent of <cx> to <cx>. */
+void ContextActorsCopy(Context *cx)
+{
+  Context	*parent, **p;
+  parent = cx->parent;
+  if (parent->actors_pending) ContextActorsCopy(parent);
+  for (p = &parent->pending; *p; p = &(*p)->pending_next) {
+    if (*p == cx) {
+      *p = cx->pending_next;
+      break;
+    }
   }
+  cx->pending_next = NULL;
+  cx->actors_pending = 0;
+  cx->actors = ActorCopyAll(parent->actors, parent, cx);
+  cx->queue = PA_QueueCopy(parent, cx);
+}
+
+/* Copies the actors of the children of <cx> which have yet to be copied,
+ * before <cx> is modified.
+ */
+void ContextActorsCopyChildren(Context *cx)
+{
+  while (cx->pending) ContextActorsCopy(cx->pending);
+}
+
+/* Returns the actors of <cx>, which the caller may modify. */
+Actor *ContextActors(Context *cx)
+{
+  if (cx->actors_pending) ContextActorsCopy(cx);
+  if (cx->pending) ContextActorsCopyChildren(cx);
+  return(cx->actors);
 }
 
 Context *ContextLast(Context *cx)
@@ -233,7 +326,7 @@ void ContextPrint(FILE *stream, Context *cx)
     ObjPrint(stream, cx->reinterp);
     fputc(NEWLINE, stream);
   }
-  ActorPrintAll(stream, cx->actors);
+  ActorPrintAll(stream, ContextActors(cx));
 }
 
 void ContextPrintAll(FILE *stream, Context *cxs)
@@ -349,11 +442,12 @@ void ContextClearSpin(Context *cx)
 {
   Actor		*ac;
   Subgoal	*sg;
-  for (ac = cx->actors; ac; ac = ac->next) {
+  for (ac = ContextActors(cx); ac; ac = ac->next) {
     for (sg = ac->subgoals; sg; sg = sg->next) {
       sg->spin_to_state = STNOSPIN;
     }
   }
+  if (cx->queue) PA_QueueRestore(cx->queue, 1);
 }
 
 Context *ContextFindBest(Context *cxs, Context *exclude1, Context *exclude2)
@@ -431,7 +525,7 @@ void ContextInitiateHandlers(Context *cx, Obj *actor)
 Actor *ContextActorFind(Context *cx, Obj *actor, int create_ok)
 {
   Actor	*ac;
-  for (ac = cx->actors; ac; ac = ac->next) {
+  for (ac = ContextActors(cx); ac; ac = ac->next) {
     if (ac->actor == actor) return(ac);
   }
   if (create_ok) {
@@ -475,7 +569,7 @@ ObjList *ContextFindMatchingSubgoals(Context *cx, Obj *subgoal_obj)
   Subgoal	*sg;
   ObjList	*r;
   r = NULL;
-  for (ac = cx->actors; ac; ac = ac->next) {
+  for (ac = ContextActors(cx); ac; ac = ac->next) {
     for (sg = ac->subgoals; sg; sg = sg->next) {
       if (ObjUnify(subgoal_obj, sg->obj)) {	/* todoFREE: bd */
         r = ObjListCreate(sg->obj, r);
@@ -490,7 +584,7 @@ Subgoal *ContextFindSubgoal(Context *cx, Obj *subgoal_obj)
 {
   Actor	*ac;
   Subgoal	*sg;
-  for (ac = cx->actors; ac; ac = ac->next) {
+  for (ac = ContextActors(cx); ac; ac = ac->next) {
     for (sg = ac->subgoals; sg; sg = sg->next) {
       if (ObjMatchList(subgoal_obj, sg->obj)) {	/* todoFREE: bd */
         if (sg->supergoal) return(sg);
@@ -521,7 +615,7 @@ ObjList *ContextSubgoals(Context *cx, Obj *subgoal_obj)
   Subgoal	*super, *sg;
   r = NULL;
   if ((super = ContextFindSubgoal(cx, subgoal_obj))) {
-    for (ac = cx->actors; ac; ac = ac->next) {
+    for (ac = ContextActors(cx); ac; ac = ac->next) {
       for (sg = ac->subgoals; sg; sg = sg->next) {
         if (sg->supergoal == super) r = ObjListCreate(sg->obj, r);
       }
@@ -607,7 +701,7 @@ ObjList *ContextFindGrids(Context *cx)
   ObjList	*r;
   GridCoord	row, col;
   r = NULL;
-  for (ac = cx->actors; ac; ac = ac->next) {
+  for (ac = ContextActors(cx); ac; ac = ac->next) {
     if (SpaceLocateObject(NULL, &cx->story_time, ac->actor, NULL, 1,
                           &polity, &grid, &row, &col)) {
       r = ObjListCreate(grid, r);
@@ -625,14 +719,14 @@ ObjList *ContextFindObjects(Context *cx, Obj *class)
   if (N("human") == class) {
   /* Find humans in context = Actors. */
     r = NULL;
-    for (ac = cx->actors; ac; ac = ac->next) {
+    for (ac = ContextActors(cx); ac; ac = ac->next) {
       r = ObjListCreate(ac->actor, r);
     }
     return(r);
   } else {
   /* Find objects near actors. */
     r = NULL;
-    for (ac = cx->actors; ac; ac = ac->next) {
+    for (ac = ContextActors(cx); ac; ac = ac->next) {
       if (ISAP(class, ac->actor) && !ObjListIn(ac->actor, r)) {
         r = ObjListCreate(ac->actor, r);
       }
@@ -667,7 +761,7 @@ void ContextAntecedentDecayAllCh(Context *cx)
 {
   int		i;
   Actor		*ac;
-  for (ac = cx->actors; ac; ac = ac->next) {
+  for (ac = ContextActors(cx); ac; ac = ac->next) {
     for (i = 0; i < DCMAX; i++) {
       if (NULL == DiscourseGetIthChannel(cx->dc, i)) continue;
       AntecedentDecay(&ac->antecedent[i]);
@@ -679,7 +773,7 @@ void ContextAntecedentDecayAllCh(Context *cx)
 void ContextAntecedentDecayOneCh(Context *cx)
 {
   Actor		*ac;
-  for (ac = cx->actors; ac; ac = ac->next) {
+  for (ac = ContextActors(cx); ac; ac = ac->next) {
     AntecedentDecay(&ac->antecedent[cx->dc->curchannel]);
   }
 }
@@ -739,7 +833,7 @@ void ContextAntecedentRefreshOneCh(Context *cx, Obj *obj, PNode *pn,
   }
   if (!ContextIsAntecedent(obj, cx)) return;
 
-  for (ac = cx->actors; ac; ac = ac->next) {
+  for (ac = ContextActors(cx); ac; ac = ac->next) {
     if (ac->actor == obj) {
       AntecedentRefresh(&ac->antecedent[cx->dc->curchannel],
                         obj, pn, pn_top, gender, number, person);
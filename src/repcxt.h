@@ -2,7 +2,11 @@
 void ContextInit(void);
 Context *ContextCreate(Ts *ts, TenseStep tensestep, Discourse *dc, Context *next);
 Context *ContextSprout(Context *parent, Obj *sproutcon, PNode *sproutpn, Context *next);
+void ContextPathSet(Context *cx, Context *parent);
 Bool ContextIsAncestor(Context *anc, Context *des);
+void ContextActorsCopy(Context *cx);
+void ContextActorsCopyChildren(Context *cx);
+Actor *ContextActors(Context *cx);
 Context *ContextLast(Context *cx);
 Context *ContextAppendDestructive(Context *cx1, Context *cx2);
 void ContextPrintName(FILE *stream, Context *cx);
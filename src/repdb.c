@@ -6,6 +6,12 @@
  * 19940419: begun
  * 19940705: incorporated timestamps into objects
  * 19980701: fix to DbRestrictionParse1 causing SEGVs
+ * 20261017T121500: exact-key assertion indexes
+ * 20261017T160000: assertions made during a scratch request are kept
+ * 20261017T230000: forward chaining on assertion (cf repinfer.c)
+ * 20261018T160000: at-grid assertions entered in the spatial index
+ * 20261018T200000: cached grid states dropped on at-grid changes
+ * 20261018T230000: wormholes entered in the intergrid graph
  */
 
 #include "tt.h"
@@ -13,16 +19,19 @@
 #include "repbasic.h"
 #include "repcxt.h"
 #include "repdb.h"
+#include "repgrid.h"
+#include "repinfer.h"
 #include "repobj.h"
 #include "repobjl.h"
 #include "repprove.h"
+#include "repspace.h"
 #include "reptime.h"
 #include "semanaph.h"
 #include "semdisc.h"
 #include "synpnode.h"
 #include "utildbg.h"
 
-HashTable *DbHT01, *DbHT02, *DbHT0, *DbHT1, *DbHT2;
+DbIndex *DbIndex01, *DbIndex02, *DbIndex0, *DbIndex1, *DbIndex2;
 
 long DbAssertionCnt;
 
@@ -30,49 +39,182 @@ void DbInit()
 {
   Dbg(DBGDB, DBGHYPER, "DbInit", E);
   DbAssertionCnt = 0;
-  DbHT01 = HashTableCreate(4099L);
-  DbHT02 = HashTableCreate(4099L);
-  DbHT0 = HashTableCreate(4099L);
-  DbHT1 = HashTableCreate(4099L);
-  DbHT2 = HashTableCreate(4099L);
+  DbIndex01 = DbIndexCreate(8192L, "DbIndex01");
+  DbIndex02 = DbIndexCreate(8192L, "DbIndex02");
+  DbIndex0 = DbIndexCreate(1024L, "DbIndex0");
+  DbIndex1 = DbIndexCreate(8192L, "DbIndex1");
+  DbIndex2 = DbIndexCreate(8192L, "DbIndex2");
 }
 
-void DbHashSym(char *s1, char *s2, /* RESULT */ char *r)
+/******************************************************************************
+ * INDEXING
+ *
+ * Assertions are indexed on the pairs (pred, arg1), (pred, arg2) and on
+ * pred, arg1 and arg2 alone. Each slot holds only the assertions whose
+ * elements have the slot's exact keys, so DbRetrieval does not have to
+ * filter out unrelated assertions that merely share a name prefix.
+ ******************************************************************************/
+
+DbIndex *DbIndexCreate(size_t size, char *name)
 {
-  int	i;
-  if (s2[0] == TERM) {
-    for (i = 0; *s1 && i < 6; i++, r++, s1++) *r = *s1;
-  } else {
-    for (i = 0; *s1 && i < 3; i++, r++, s1++) *r = *s1;
-    for (i = 0; *s2 && i < 3; i++, r++, s2++) *r = *s2;
+  DbIndex	*di;
+  size_t	i;
+  di = CREAT(DbIndex, 1);
+  di->name = name;
+  for (di->size = 16; di->size < size; di->size <<= 1);
+  di->count = 0;
+  di->entries = (DbIndexEntry *)MemAlloc1(di->size*sizeof(DbIndexEntry),
+                                          "DbIndexEntry", 1);
+  for (i = 0; i < di->size; i++) di->entries[i].objs = NULL;
+  return(di);
+}
+
+/* Returns a key such that ObjEqual objects have equal keys: numbers and
+ * strings are keyed on their (interned) values, all timestamp ranges
+ * share one key, and everything else is keyed on its address.
+ */
+unsigned long DbIndexKey(Obj *obj)
+{
+  unsigned long	key;
+  double	number;
+  size_t	i;
+  if (obj == NULL) return(0L);
+  switch (obj->type) {
+    case OBJTYPENUMBER:
+      number = obj->u2.number;
+      if (number == 0.0) return(1L);	/* 0.0 and -0.0 */
+      key = 0L;
+      for (i = 0; i < sizeof(double); i++) {
+        key = (key << 8) ^ (key >> (8*sizeof(unsigned long)-8)) ^
+              ((unsigned char *)&number)[i];
+      }
+      return(key);
+    case OBJTYPESTRING:
+      return((unsigned long)obj->u2.s);
+    case OBJTYPENAME:
+      return((unsigned long)obj->u2.nm);
+    case OBJTYPETSR:
+      return((unsigned long)OBJTYPETSR);
+    default:
+      return((unsigned long)obj);
+  }
+}
+
+unsigned long DbIndexHash(unsigned long a, unsigned long b)
+{
+  unsigned long	h;
+  h = (a >> 3) * 2654435761UL;
+  h ^= (b >> 3) * 2246822519UL;
+  h ^= h >> 15;
+  return(h);
+}
+
+/* Returns the slot for keys <a> <b>, or the unused slot where it would
+ * be entered.
+ */
+DbIndexEntry *DbIndexSlot(DbIndex *di, unsigned long a, unsigned long b)
+{
+  register DbIndexEntry	*de;
+  register size_t	i, mask;
+  mask = di->size - 1;
+  for (i = DbIndexHash(a, b) & mask; ; i = (i + 1) & mask) {
+    de = &di->entries[i];
+    if (de->objs == NULL) return(de);
+    if (de->a == a && de->b == b) return(de);
+  }
+}
+
+void DbIndexGrow(DbIndex *di)
+{
+  DbIndexEntry	*old, *de;
+  size_t	i, oldsize;
+  old = di->entries;
+  oldsize = di->size;
+  di->size = oldsize << 1;
+  di->entries = (DbIndexEntry *)MemAlloc1(di->size*sizeof(DbIndexEntry),
+                                          "DbIndexEntry", 1);
+  for (i = 0; i < di->size; i++) di->entries[i].objs = NULL;
+  for (i = 0; i < oldsize; i++) {
+    if (old[i].objs == NULL) continue;
+    de = DbIndexSlot(di, old[i].a, old[i].b);
+    *de = old[i];
+  }
+  MemFree(old, "DbIndexEntry");
+}
+
+void DbIndexEnter(DbIndex *di, Obj *obj, Obj *elema, Obj *elemb)
+{
+  DbIndexEntry	*de;
+  unsigned long	a, b;
+  if (elema == NULL) return;
+  a = DbIndexKey(elema);
+  b = DbIndexKey(elemb);
+  de = DbIndexSlot(di, a, b);
+  if (de->objs == NULL) {
+    de->a = a;
+    de->b = b;
+    di->count++;
+  }
+  de->objs = ObjListCreateShort(obj, de->objs);
+  if (di->count > (size_t)(HASHMAXLOAD*di->size)) DbIndexGrow(di);
+}
+
+ObjList *DbIndexRetrieve(DbIndex *di, Obj *elema, Obj *elemb)
+{
+  return(DbIndexSlot(di, DbIndexKey(elema), DbIndexKey(elemb))->objs);
+}
+
+/* Only for indices that own their lists (ProveRuleIndex, InferenceAlpha). */
+void DbIndexClear(DbIndex *di)
+{
+  size_t	i;
+  for (i = 0; i < di->size; i++) {
+    if (di->entries[i].objs) {
+      ObjListFree(di->entries[i].objs);
+      di->entries[i].objs = NULL;
+    }
   }
-  *r = TERM;
+  di->count = 0;
 }
 
-void DbHashEnter(HashTable *ht, Obj *objs, Obj *elema, Obj *elemb)
+void DbIndexStats(FILE *stream, DbIndex *di)
 {
-  char		sym[DHASHSIG];
-  ObjList	*prev, *new;
-  DbHashSym(M(elema), M(elemb), sym);
-  prev = (ObjList *)HashTableGet(ht, sym);
-  new = ObjListCreateShort(objs, prev);
-  HashTableSetDup(ht, sym, new);
+  size_t	i, len, maxlen, total;
+  ObjList	*p;
+  maxlen = total = 0;
+  for (i = 0; i < di->size; i++) {
+    for (len = 0, p = di->entries[i].objs; p; p = p->next) len++;
+    total += len;
+    if (len > maxlen) maxlen = len;
+  }
+  fprintf(stream, "%-16s %8ld keys %8ld slots load %.3f",
+          di->name, (long)di->count, (long)di->size,
+          ((Float)di->count)/(Float)di->size);
+  fprintf(stream, " assertions %ld max per key %ld\n", (long)total,
+          (long)maxlen);
 }
 
-ObjList *DbHashRetrieve(HashTable *ht, Obj *elema, Obj *elemb)
+void DbIndexStatsAll(FILE *stream)
 {
-  char	sym[DHASHSIG];
-  DbHashSym(M(elema), M(elemb), sym);
-  return((ObjList *)HashTableGet(ht, sym));
+  DbIndexStats(stream, DbIndex01);
+  DbIndexStats(stream, DbIndex02);
+  DbIndexStats(stream, DbIndex0);
+  DbIndexStats(stream, DbIndex1);
+  DbIndexStats(stream, DbIndex2);
 }
 
 /******************************************************************************
  * ASSERTION
  ******************************************************************************/
 
+/* script-relation is looked up rather than created, as the db does not
+ * define it.
+ */
 Bool DbGenIsPruned(Obj *obj)
 {
-  return(ISA(N("script-relation"), I(obj, 0)));
+  Obj	*class;
+  if (!(class = NameToObj("script-relation", OBJ_NO_CREATE))) return(0);
+  return(ISA(class, I(obj, 0)));
 }
 
 void DbAssert1(Obj *obj)
@@ -90,11 +232,17 @@ void DbAssert1(Obj *obj)
     DbRestrictValidate(obj, 1);
   }
   DbAssertionCnt++;
-  DbHashEnter(DbHT01, obj, I(obj, 0), I(obj, 1));
-  DbHashEnter(DbHT02, obj, I(obj, 0), I(obj, 2));
-  DbHashEnter(DbHT0, obj, I(obj, 0), NULL);
-  DbHashEnter(DbHT1, obj, I(obj, 1), NULL);
-  DbHashEnter(DbHT2, obj, I(obj, 2), NULL);
+  MemScratchPin(obj);
+  MemScratchSuspend();
+  DbIndexEnter(DbIndex01, obj, I(obj, 0), I(obj, 1));
+  DbIndexEnter(DbIndex02, obj, I(obj, 0), I(obj, 2));
+  DbIndexEnter(DbIndex0, obj, I(obj, 0), NULL);
+  DbIndexEnter(DbIndex1, obj, I(obj, 1), NULL);
+  DbIndexEnter(DbIndex2, obj, I(obj, 2), NULL);
+  SpaceCellsEnter(obj);
+  GridStateInvalidate(obj);
+  IntergridGraphEnter(obj);
+  MemScratchResume();
   obj->u1.lst.asserted = 1;
   if (DbgOn(DBGDB, DBGDETAIL)) {
     fputs("****ASSERTED ", Log);
@@ -102,30 +250,13 @@ void DbAssert1(Obj *obj)
     fputc(NEWLINE, Log);
   }
   if (!Starting) {
-    /* todo: Max depth. Retraction maintenance. */
+    /* todo: Retraction maintenance. */
     tsr = ObjToTsRange(obj);
 #ifdef notdef
     if (tsr->cx) {
       tsr->cx->assertions = ObjListCreate(obj, tsr->cx->assertions);
     }
 #endif
-#ifdef notdef
-    Ts		*ts;
-    ts = tsr->startts;
-    /* This is looping. */
-    inferred = InferenceRunInferenceRules(ts, NULL, obj, NULL, 1);
-    /* todo: This is looping on "Jim likes rain."
-    for (p = inferred; p; p = p->next) {
-      if (YES(ZRE(ts, p->obj))) {
-        Dbg(DBGDB, DBGHYPER, "already true:");
-        DbgOP(DBGDB, DBGHYPER, p->obj);
-      } else {
-        DbAssert1(p->obj);
-      }
-    }
-     */
-    ObjListFree(inferred);
-#endif
 #ifdef notdef
     /* todo */
     inferred = InferenceRunActivationRules(ts, NULL, obj, NULL, 1);
@@ -151,6 +282,7 @@ void DbAssert1(Obj *obj)
     }
     ContextOnAssert(tsr, obj);
   }
+  if (!Starting) InferenceAssert(obj);
 }
 
 /* Steps on <obj> tsr. */
@@ -185,6 +317,17 @@ void DbAssertState(Ts *ts, Dur dur, Obj *obj)
  * RETRIEVAL
  ******************************************************************************/
 
+/* Returns whether assertion <obj> holds in context <cx> at <ts> or, if
+ * <tsr> is not NULL, during <tsr>.
+ */
+Bool DbAssertionHolds(Context *cx, Ts *ts, TsRange *tsr, Obj *obj)
+{
+  if (!ContextIsAncestor(obj->u2.tsr.cx, cx)) return(0);
+  if (ObjSupersededIn(obj, cx)) return(0);
+  return(tsr ? TsRangeOverlaps(tsr, &obj->u2.tsr) :
+               TsRangeMatch(ts, &obj->u2.tsr));
+}
+
 ObjList *DbRetrieval(Ts *ts, TsRange *tsr, Obj *ptn, ObjList *r, Ts *tsretract,
                      Bool freeptn)
 {
@@ -201,26 +344,22 @@ ObjList *DbRetrieval(Ts *ts, TsRange *tsr, Obj *ptn, ObjList *r, Ts *tsretract,
   elem1 = I(ptn, 1);
   elem2 = I(ptn, 2);
   if (ObjIsNotVar(elem0) && ObjIsNotVarNC(elem1)) {
-    fl = DbHashRetrieve(DbHT01, elem0, elem1);
+    fl = DbIndexRetrieve(DbIndex01, elem0, elem1);
   } else if (ObjIsNotVar(elem0) && ObjIsNotVarNC(elem2)) {
-    fl = DbHashRetrieve(DbHT02, elem0, elem2);
+    fl = DbIndexRetrieve(DbIndex02, elem0, elem2);
   } else if (ObjIsNotVar(elem0)) {
-    fl = DbHashRetrieve(DbHT0, elem0, NULL);
+    fl = DbIndexRetrieve(DbIndex0, elem0, NULL);
   } else if (ObjIsNotVarNC(elem1)) {
-    fl = DbHashRetrieve(DbHT1, elem1, NULL);
+    fl = DbIndexRetrieve(DbIndex1, elem1, NULL);
   } else if (ObjIsNotVarNC(elem2)) {
-    fl = DbHashRetrieve(DbHT2, elem2, NULL);
+    fl = DbIndexRetrieve(DbIndex2, elem2, NULL);
   } else {
     Dbg(DBGDB, DBGBAD, "no retrieval hash");
     if (freeptn) ObjFree(ptn);
     return(r);
   }
   for (f = fl; f; f = f->next) {
-    if (!ContextIsAncestor(f->obj->u2.tsr.cx, cx)) continue;
-    if (ObjSupersededIn(f->obj, cx)) continue;
-    if ((tsr ? TsRangeOverlaps(tsr, &f->obj->u2.tsr) :
-               TsRangeMatch(ts, &f->obj->u2.tsr)) &&
-        ObjUnifyQuick(ptn, f->obj)) {
+    if (DbAssertionHolds(cx, ts, tsr, f->obj) && ObjUnifyQuick(ptn, f->obj)) {
       Dbg(DBGDB, DBGHYPER, "found:");
       DbgOP(DBGDB, DBGHYPER, f->obj);
       if (ptn == f->obj) freeptn = 0;
@@ -228,6 +367,7 @@ ObjList *DbRetrieval(Ts *ts, TsRange *tsr, Obj *ptn, ObjList *r, Ts *tsretract,
         if (f->obj->u2.tsr.cx == cx) {
         /* Retract in place. */
           f->obj->u2.tsr.stopts = *tsretract;
+          GridStateInvalidate(f->obj);
           if (DbgOn(DBGDB, DBGDETAIL)) {
             fputs("****RETRACTED ", Log);
             ObjPrint1(Log, f->obj, NULL, 5, 1, 0, 1, 0);
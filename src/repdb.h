@@ -1,14 +1,22 @@
 /* repdb.c */
 void DbInit(void);
-void DbHashSym(char *s1, char *s2, char *r);
-void DbHashEnter(HashTable *ht, Obj *objs, Obj *elema, Obj *elemb);
-ObjList *DbHashRetrieve(HashTable *ht, Obj *elema, Obj *elemb);
+DbIndex *DbIndexCreate(size_t size, char *name);
+unsigned long DbIndexKey(Obj *obj);
+unsigned long DbIndexHash(unsigned long a, unsigned long b);
+DbIndexEntry *DbIndexSlot(DbIndex *di, unsigned long a, unsigned long b);
+void DbIndexGrow(DbIndex *di);
+void DbIndexEnter(DbIndex *di, Obj *obj, Obj *elema, Obj *elemb);
+ObjList *DbIndexRetrieve(DbIndex *di, Obj *elema, Obj *elemb);
+void DbIndexClear(DbIndex *di);
+void DbIndexStats(FILE *stream, DbIndex *di);
+void DbIndexStatsAll(FILE *stream);
 Bool DbGenIsPruned(Obj *obj);
 void DbAssert1(Obj *obj);
 void DbAssert(TsRange *tsr, Obj *obj);
 void DbAssertActionDur(Ts *ts, Dur dur, Obj *obj);
 void DbAssertActionRange(Ts *startts, Ts *stopts, Obj *obj);
 void DbAssertState(Ts *ts, Dur dur, Obj *obj);
+Bool DbAssertionHolds(Context *cx, Ts *ts, TsRange *tsr, Obj *obj);
 ObjList *DbRetrieval(Ts *ts, TsRange *tsr, Obj *ptn, ObjList *r, Ts *tsretract, Bool freeptn);
 ObjList *DbRetrievalDesc(Ts *ts, TsRange *tsr, Obj *ptn, int elemi, ObjList *r, Ts *tsretract, int lockout, int depth, Bool freeptn);
 ObjList *DbRetrievalAnc(Ts *ts, TsRange *tsr, Obj *ptn, int elemi, ObjList *r, Ts *tsretract, int lockout, int depth, Bool freeptn);
@@ -5,6 +5,9 @@
  *
  * 19981113T134512: begun
  * 19981114T165112: debugged 
+ * 20261017T160000: buffers are never scratch memory
+ * 20261017T200000: nor are fifos, which the server creates on its own thread
+ * 20261017T210000: FifoLength, FifoRemove, FifoMove
  */
 
 #include "tt.h"
@@ -14,11 +17,12 @@
 
 /* Buffer */
 
+/* Fifos outlive the requests that write to them. */
 Buffer *BufferCreate(int bufsize)
 {
   Buffer *b;
-  b = CREATE(Buffer);
-  b->buf = (char *)MemAlloc((size_t)bufsize, "Buffer* buf");
+  b = CREAT(Buffer, 1);
+  b->buf = (char *)MemAlloc1((size_t)bufsize, "Buffer* buf", 1);
   memset(b->buf, 0, bufsize); /* REDUNDANT */
   b->next = NULL;
   return b;
@@ -35,7 +39,7 @@ void BufferFree(Buffer *b)
 Fifo *FifoCreate(int bufsize)
 {
   Fifo *f;
-  f = CREATE(Fifo);
+  f = CREAT(Fifo, 1);
   f->bufsize = bufsize;
   if (f->bufsize > 0) {
     f->first = f->last = BufferCreate(bufsize);
@@ -132,12 +136,63 @@ Bool FifoIsEmpty(Fifo *f)
          f->first_removepos == f->last_addpos;
 }
 
+long FifoLength(Fifo *f)
+{
+  int    first_removepos, bufsize;
+  long   len;
+  char   *buf;
+  Buffer *first;
+  len = 0L;
+  FifoLookaheadBegin(f, &first, &first_removepos);
+  while (1) {
+    FifoLookaheadNext(f, &buf, &bufsize, &first, &first_removepos);
+    if (bufsize == 0) return len;
+    len += bufsize;
+  }
+}
+
+/* Removes up to <len> characters. */
+void FifoRemove(Fifo *f, long len)
+{
+  int  bufsize;
+  char *buf;
+  while (len > 0) {
+    FifoRemoveBegin(f, &buf, &bufsize);
+    if (bufsize == 0) return;
+    if (bufsize > len) bufsize = (int)len;
+    FifoRemoveEnd(f, bufsize);
+    len -= bufsize;
+  }
+}
+
+/* Moves the contents of <from> to the end of <to>. */
+void FifoMove(Fifo *to, Fifo *from)
+{
+  int    first_removepos, bufsize;
+  long   len;
+  char   *buf;
+  Buffer *first;
+  len = 0L;
+  FifoLookaheadBegin(from, &first, &first_removepos);
+  while (1) {
+    FifoLookaheadNext(from, &buf, &bufsize, &first, &first_removepos);
+    if (bufsize == 0) break;
+    FifoWriteLen(to, buf, bufsize);
+    len += bufsize;
+  }
+  FifoRemove(from, len);
+}
+
 void FifoWrite(Fifo *f, char *s)
 {
-  int  len, bufsize, siz;
+  FifoWriteLen(f, s, strlen(s));
+}
+
+void FifoWriteLen(Fifo *f, char *s, int len)
+{
+  int  bufsize, siz;
   char *buf;
 
-  len = strlen(s);
   while (len > 0) {
     FifoAddBegin(f, &buf, &bufsize);
     if (len < bufsize) siz = len;
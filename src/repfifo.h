@@ -10,6 +10,10 @@ void FifoRemoveEnd(Fifo *f, int removed);
 void FifoLookaheadBegin(Fifo *f, Buffer **first, int *first_removepos);
 void FifoLookaheadNext(Fifo *f, char **buf, int *bufsize, Buffer **first, int *first_removepos);
 Bool FifoIsEmpty(Fifo *f);
+long FifoLength(Fifo *f);
+void FifoRemove(Fifo *f, long len);
+void FifoMove(Fifo *to, Fifo *from);
 void FifoWrite(Fifo *f, char *s);
+void FifoWriteLen(Fifo *f, char *s, int len);
 Bool FifoIsLineAvailable(Fifo *f);
 Bool FifoReadLine(Fifo *f, int linelen, char *line);
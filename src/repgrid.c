@@ -11,6 +11,8 @@
  *           redid fill and path finding algorithms;
  *           merged Grid and GridRegion
  * 19940612: redid GridRegions as GridSubspaces
+ * 20261018T200000: A* path finding; multiple grid states and paths cached
+ * 20261018T230000: intergrid routes by search over a wormhole graph
  */
 
 #include "tt.h"
@@ -46,15 +48,37 @@
 
 /* Grid basic. */
 
-Grid	*LastGridState;
-Obj	*LastGridObj, *LastGridProp;
-Ts	LastGridTs;
+GridStateEntry	GridStates[GRIDSTATECACHE];
+long		GridStateUsed, GridStateEpoch, GridStatesEpoch;
+int		*GridPathG, *GridPathFrom, *GridPathOpened, *GridPathClosed;
+int		GridPathCells, GridPathStamp;
+GridOpen	*GridOpenHeap;
+int		GridOpenLen, GridOpenMax;
+IntergridDoor	*IntergridByGrid[INTERGRIDHASH], *IntergridByWorm[INTERGRIDHASH];
+Bool		IntergridGraphBuilt;
+long		IntergridStamp;
 
 void GridInit()
 {
-  LastGridState = NULL;
-  LastGridObj = LastGridProp = NULL;
-  TsSetNa(&LastGridTs);
+  int	i;
+  for (i = 0; i < GRIDSTATECACHE; i++) {
+    GridStates[i].gridobj = GridStates[i].prop = NULL;
+    TsSetNa(&GridStates[i].ts);
+    GridStates[i].state = NULL;
+    GridStates[i].used = 0L;
+    GridStates[i].pathcnt = 0;
+    GridStates[i].paths = NULL;
+  }
+  GridStateUsed = GridStateEpoch = GridStatesEpoch = 0L;
+  GridPathG = GridPathFrom = GridPathOpened = GridPathClosed = NULL;
+  GridPathCells = GridPathStamp = 0;
+  GridOpenHeap = NULL;
+  GridOpenLen = GridOpenMax = 0;
+  for (i = 0; i < INTERGRIDHASH; i++) {
+    IntergridByGrid[i] = IntergridByWorm[i] = NULL;
+  }
+  IntergridGraphBuilt = 0;
+  IntergridStamp = 0L;
 }
 
 Grid *GridCreate(Obj *grid, GridCoord rows, GridCoord cols, int fill)
@@ -68,6 +92,7 @@ Grid *GridCreate(Obj *grid, GridCoord rows, GridCoord cols, int fill)
   gr->m = (char *)MemAlloc(size, "char Grid m");
   memset((void *)gr->m, fill, size);
   gr->grid = grid;
+  gr->cells = NULL;
   return(gr);
 }
 
@@ -206,6 +231,17 @@ GridSubspace *GridSubspaceCopyShared(GridSubspace *old_gs)
   return(new_gs);
 }
 
+GridSubspace *GridSubspaceCopy(GridSubspace *old_gs)
+{
+  GridSubspace *new_gs;
+  new_gs = GridSubspaceCreate(old_gs->len > 0 ? (int)old_gs->len : 1,
+                              old_gs->grid);
+  new_gs->len = old_gs->len;
+  memcpy(new_gs->rows, old_gs->rows, sizeof(GridCoord)*old_gs->len);
+  memcpy(new_gs->cols, old_gs->cols, sizeof(GridCoord)*old_gs->len);
+  return(new_gs);
+}
+
 void GridSubspaceAdd(GridSubspace *gs, GridCoord row, GridCoord col)
 {
   if (gs->len >= gs->maxlen) {
@@ -383,57 +419,230 @@ void IntergridPathFree(IntergridPath *igp)
   MemFree(igp, "IntergridPath");
 }
 
-IntergridPath *IntergridFindPath1(Ts *ts, TsRange *tsr, Obj *gr1, Obj *gr2,
-                                  Obj *grvia, int maxdepth)
+/* Intergrid graph: the grids connected by each wormhole. It is built from
+ * the at-grid assertions of wormholes by the first IntergridFindPaths, and
+ * then kept up to date as they are asserted. Whether a door exists at the
+ * time of a search is checked during the search, so retraction needs no
+ * maintenance.
+ */
+
+int IntergridHashOf(Obj *obj)
 {
-  ObjList		*objs1, *p1, *objs2, *p2;
-  Obj			*worm, *grto;
-  IntergridPath	*igp;
-  objs1 = RDB(ts, tsr, L(N("at-grid"), N("wormhole"), gr1, ObjWild, E), 1);
-  for (p1 = objs1; p1; p1 = p1->next) {
-    worm = I(p1->obj, 1);
-    objs2 = RDB(ts, tsr, L(N("at-grid"), worm, ObjWild, ObjWild, E), 1);
-    grto = NULL;
-    for (p2 = objs2; p2; p2 = p2->next) {
-      if (I(p2->obj, 2) != gr1 && I(p2->obj, 2) != grvia) {
-        grto = I(p2->obj, 2);
-        break;
-      }
-    }
-    ObjListFree(objs2);
-    if (!grto) continue;
-    if (grto == gr2) {
-      igp = IntergridPathCreate(10);
-      igp->len = 0;
-      IntergridPathAddNext(igp, gr2, NULL);
-      IntergridPathAddNext(igp, gr1, worm);
-      ObjListFree(objs1);
-      return(igp);
-    }
-    if (maxdepth == 0) return(NULL);
-    if ((igp = IntergridFindPath1(ts, tsr, grto, gr2, gr1, maxdepth-1))) {
-      IntergridPathAddNext(igp, gr1, worm);
-      ObjListFree(objs1);
-      return(igp);
+  return((int)((((unsigned long)obj) >> 4) & (INTERGRIDHASH-1)));
+}
+
+void IntergridGraphEnter(Obj *assertion)
+{
+  int		i;
+  Obj		*grid;
+  GridSubspace	*gs;
+  IntergridDoor	*d;
+  if (!IntergridGraphBuilt) return;
+  if (ObjLen(assertion) < 4 ||
+      !streq(ObjToName(I(assertion, 0)), "at-grid")) {
+    return;
+  }
+  if (!ISA(N("wormhole"), I(assertion, 1))) return;
+  if (!(gs = ObjToGridSubspace(I(assertion, 3))) || gs->len == 0) return;
+  grid = I(assertion, 2);
+  d = (IntergridDoor *)MemAlloc1(sizeof(IntergridDoor), "IntergridDoor", 1);
+  d->wormhole = I(assertion, 1);
+  d->grid = grid;
+  d->assertion = assertion;
+  d->row = gs->rows[0];
+  d->col = gs->cols[0];
+  d->rowdist = ObjToNumber(DbGetRelationValue(&TsNA, NULL,
+                                              N("row-distance-of"), grid,
+                                              NULL));
+  d->coldist = ObjToNumber(DbGetRelationValue(&TsNA, NULL,
+                                              N("col-distance-of"), grid,
+                                              NULL));
+  if (d->rowdist == FLOATNA) d->rowdist = 1.0;
+  if (d->coldist == FLOATNA) d->coldist = 1.0;
+  d->stamp = 0L;
+  d->expanded = 0;
+  i = IntergridHashOf(grid);
+  d->nextgrid = IntergridByGrid[i];
+  IntergridByGrid[i] = d;
+  i = IntergridHashOf(d->wormhole);
+  d->nextworm = IntergridByWorm[i];
+  IntergridByWorm[i] = d;
+}
+
+void IntergridGraphBuild()
+{
+  ObjList	*p;
+  IntergridGraphBuilt = 1;
+  for (p = DbIndexRetrieve(DbIndex0, N("at-grid"), NULL); p; p = p->next) {
+    IntergridGraphEnter(p->obj);
+  }
+}
+
+/* Distance walked within the grid of <d>, or 0.0 if a cell is unknown. */
+Float IntergridDistance(IntergridDoor *d, GridCoord row1, GridCoord col1,
+                        GridCoord row2, GridCoord col2)
+{
+  if (row1 == INTNA || row2 == INTNA) return(0.0);
+  return(GridDistance1(d->rowdist, d->coldist, row1, col1, row2, col2));
+}
+
+/* Returns the index of a new label; <heap> has room for every label. */
+int IntergridLabelAdd(IntergridLabel **labels, int **heap, int *len,
+                      int *maxlen)
+{
+  if (*len >= *maxlen) {
+    *maxlen = 2*(*maxlen);
+    *labels = (IntergridLabel *)MemRealloc(*labels,
+                                           *maxlen*sizeof(IntergridLabel),
+                                           "IntergridLabel");
+    *heap = (int *)MemRealloc(*heap, *maxlen*sizeof(int), "int heap");
+  }
+  return((*len)++);
+}
+
+#define IntergridLabelBefore(labels, l1, l2) \
+  ((labels)[l1].cost < (labels)[l2].cost || \
+   ((labels)[l1].cost == (labels)[l2].cost && (l1) < (l2)))
+
+void IntergridHeapPush(int *heap, int *heaplen, IntergridLabel *labels, int l)
+{
+  int	i, parent;
+  for (i = (*heaplen)++; i > 0; i = parent) {
+    parent = (i-1)/2;
+    if (!IntergridLabelBefore(labels, l, heap[parent])) break;
+    heap[i] = heap[parent];
+  }
+  heap[i] = l;
+}
+
+int IntergridHeapPop(int *heap, int *heaplen, IntergridLabel *labels)
+{
+  int	i, child, r, last;
+  r = heap[0];
+  last = heap[--(*heaplen)];
+  for (i = 0; (child = 2*i+1) < *heaplen; i = child) {
+    if (child+1 < *heaplen &&
+        IntergridLabelBefore(labels, heap[child+1], heap[child])) {
+      child++;
     }
+    if (!IntergridLabelBefore(labels, heap[child], last)) break;
+    heap[i] = heap[child];
   }
-  ObjListFree(objs1);
-  return(NULL);
+  heap[i] = last;
+  return(r);
 }
 
-/* Result IntergridPath goes from <gr2> to <gr1>.
- * todo: This should find several paths.
- */
-IntergridPath *IntergridFindPath(Ts *ts, TsRange *tsr, Obj *gr1, Obj *gr2)
+Bool IntergridLabelVisited(IntergridLabel *labels, int l, Obj *grid)
+{
+  for (; l >= 0; l = labels[l].parent) {
+    if (labels[l].grid == grid) return(1);
+  }
+  return(0);
+}
+
+IntergridPath *IntergridLabelPath(IntergridLabel *labels, int l)
 {
+  int		i;
   IntergridPath	*igp;
-  int			maxdepth;
-  for (maxdepth = 1; maxdepth < MAXINTERGRID; maxdepth++) {
-    if ((igp = IntergridFindPath1(ts, tsr, gr1, gr2, NULL, maxdepth))) {
-      return(igp);
+  l = labels[l].parent;
+  igp = IntergridPathCreate(labels[l].depth+1);
+  for (i = labels[l].depth; i >= 0; i--, l = labels[l].parent) {
+    igp->grids[i] = labels[l].grid;
+    igp->wormholes[i] = labels[l].door ? labels[l].door->wormhole : NULL;
+  }
+  return(igp);
+}
+
+/* Finds up to <k> routes from <gr1> to <gr2> through wormholes, shortest
+ * first, into <paths>, and returns how many were found. The length of a
+ * route is the distance walked within each grid, starting from <row1>
+ * <col1> in <gr1> and ending at <row2> <col2> in <gr2> (INTNA if
+ * unknown). A route takes at most MAXINTERGRID wormholes and passes
+ * through no grid twice; each door is expanded at most <k> times.
+ * grids[0] of each route is <gr1>; wormholes[i] leads from grids[i-1]
+ * into grids[i].
+ */
+int IntergridFindPaths(Ts *ts, TsRange *tsr, Obj *gr1, GridCoord row1,
+                       GridCoord col1, Obj *gr2, GridCoord row2,
+                       GridCoord col2, int k,
+                       /* RESULTS */ IntergridPath **paths)
+{
+  int			n, l, i, len, maxlen, heaplen, *heap;
+  Context		*cx;
+  IntergridDoor		*d, *d2;
+  IntergridLabel	*labels, lab;
+  if (!IntergridGraphBuilt) IntergridGraphBuild();
+  cx = (tsr ? tsr->cx : ts->cx);
+  IntergridStamp++;
+  maxlen = 64;
+  labels = (IntergridLabel *)MemAlloc(maxlen*sizeof(IntergridLabel),
+                                      "IntergridLabel");
+  heap = (int *)MemAlloc(maxlen*sizeof(int), "int heap");
+  len = heaplen = n = 0;
+  l = IntergridLabelAdd(&labels, &heap, &len, &maxlen);
+  labels[l].grid = gr1;
+  labels[l].door = NULL;
+  labels[l].row = row1;
+  labels[l].col = col1;
+  labels[l].cost = 0.0;
+  labels[l].depth = 0;
+  labels[l].parent = -1;
+  labels[l].final = 0;
+  IntergridHeapPush(heap, &heaplen, labels, l);
+  while (n < k && heaplen > 0) {
+    l = IntergridHeapPop(heap, &heaplen, labels);
+    lab = labels[l];
+    if (lab.final) {
+      paths[n++] = IntergridLabelPath(labels, l);
+      continue;
+    }
+    if ((d = lab.door)) {
+      if (d->stamp != IntergridStamp) {
+        d->stamp = IntergridStamp;
+        d->expanded = 0;
+      }
+      if (d->expanded >= k) continue;
+      d->expanded++;
+    }
+    if (lab.grid == gr2) {
+      i = IntergridLabelAdd(&labels, &heap, &len, &maxlen);
+      labels[i] = lab;
+      if (lab.door) {
+        labels[i].cost += IntergridDistance(lab.door, lab.row, lab.col, row2,
+                                            col2);
+      }
+      labels[i].parent = l;
+      labels[i].final = 1;
+      IntergridHeapPush(heap, &heaplen, labels, i);
+      continue;
+    }
+    if (lab.depth >= MAXINTERGRID) continue;
+    for (d = IntergridByGrid[IntergridHashOf(lab.grid)]; d; d = d->nextgrid) {
+      if (d->grid != lab.grid) continue;
+      if (lab.door && d->wormhole == lab.door->wormhole) continue;
+      if (!DbAssertionHolds(cx, ts, tsr, d->assertion)) continue;
+      for (d2 = IntergridByWorm[IntergridHashOf(d->wormhole)]; d2;
+           d2 = d2->nextworm) {
+        if (d2->wormhole != d->wormhole || d2->grid == lab.grid) continue;
+        if (IntergridLabelVisited(labels, l, d2->grid)) continue;
+        if (!DbAssertionHolds(cx, ts, tsr, d2->assertion)) continue;
+        i = IntergridLabelAdd(&labels, &heap, &len, &maxlen);
+        labels[i].grid = d2->grid;
+        labels[i].door = d2;
+        labels[i].row = d2->row;
+        labels[i].col = d2->col;
+        labels[i].cost = lab.cost +
+                         IntergridDistance(d, lab.row, lab.col, d->row, d->col);
+        labels[i].depth = lab.depth+1;
+        labels[i].parent = l;
+        labels[i].final = 0;
+        IntergridHeapPush(heap, &heaplen, labels, i);
+      }
     }
   }
-  return(NULL);
+  MemFree(labels, "IntergridLabel");
+  MemFree(heap, "int heap");
+  return(n);
 }
 
 /* Grid parsing */
@@ -594,56 +803,6 @@ void GridSubspaceFill(Grid *srcgr, GridSubspace *destgs, char *wallchars)
   GridFree(fillgr);
 }
 
-int GridFindPathMidpoint(Grid *srcgr, GridCoord fromrow, GridCoord fromcol,
-                         GridCoord torow, GridCoord tocol, char *wallchars,
-                         GridCoord *midrow, GridCoord *midcol)
-{
-  int			change;
-  register Grid		*grfrom, *grto;
-  register GridCoord	i, j;
-  change = 1;
-  grfrom = GridBlankCopy(srcgr);
-  grto = GridBlankCopy(srcgr);
-  GR_SUB(grfrom, fromrow, fromcol) = GR_FILL;
-  GR_SUB(grto, torow, tocol) = GR_FILL;
-  while (change) {
-    change = 0;
-    for (i = 0; i < srcgr->rows; i++) {
-      for (j = 0; j < srcgr->cols; j++) {
-        if (GridIsFillable(srcgr, grfrom, i, j, wallchars)) {
-          change = 1;
-          GR_SUB(grfrom, i, j) = GR_FILL;
-          if (GR_SUB(grto, i, j) == GR_FILL) {
-            *midrow = i;
-            *midcol = j;
-            GridFree(grfrom);
-            GridFree(grto);
-            return(1);
-          }
-          if (DbgOn(DBGGRID, DBGHYPER)) {
-            GridPrint(Log, "midpoint grid to", grto, 1);
-            GridPrint(Log, "midpoint grid from", grfrom, 1);
-          }
-        }
-        if (GridIsFillable(srcgr, grto, i, j, wallchars)) {
-          change = 1;
-          GR_SUB(grto, i, j) = GR_FILL;
-          if (GR_SUB(grfrom, i, j) == GR_FILL) {
-            *midrow = i;
-            *midcol = j;
-            GridFree(grfrom);
-            GridFree(grto);
-            return(1);
-          }
-        }
-      }
-    }
-  }
-  GridFree(grfrom);
-  GridFree(grto);
-  return(0);
-}
-
 GridSubspace *GridFindLinearPath(Grid *gr, GridCoord fromrow, GridCoord fromcol,
                                  GridCoord torow, GridCoord tocol,
                                  char *wallchars)
@@ -711,48 +870,181 @@ GridSubspace *GridFindLinearPath(Grid *gr, GridCoord fromrow, GridCoord fromcol,
   return(gp);
 }
 
-GridSubspace *GridFindPath1(Grid *gr, GridCoord fromrow, GridCoord fromcol,
-                            GridCoord torow, GridCoord tocol, char *wallchars)
+/* A* path finding. The scratch arrays, indexed by cell, are kept across
+ * searches: a cell is open (closed) in the current search if its
+ * GridPathOpened (GridPathClosed) entry is GridPathStamp. Moves are to
+ * the 8 adjacent cells, as in GridFill.
+ */
+
+#define GRIDSTEP	70
+#define GRIDDIAG	99	/* GRIDSTEP*sqrt(2) */
+
+void GridPathScratch(int size)
 {
-  GridCoord	midrow, midcol;
-  GridSubspace	*gp, *gp1, *gp2;
-  int		i, j;
-  Dbg(DBGGRID, DBGHYPER, "GridFindPath1 %d %d -> %d %d", fromrow, fromcol,
-      torow, tocol);
-  if ((gp1 = GridFindLinearPath(gr, fromrow, fromcol, torow, tocol,
-                                wallchars))) {
-    return(gp1);
+  if (size > GridPathCells) {
+    if (GridPathCells > 0) {
+      MemFree(GridPathG, "int GridPath");
+      MemFree(GridPathFrom, "int GridPath");
+      MemFree(GridPathOpened, "int GridPath");
+      MemFree(GridPathClosed, "int GridPath");
+    }
+    GridPathG = (int *)MemAlloc1(size*sizeof(int), "int GridPath", 1);
+    GridPathFrom = (int *)MemAlloc1(size*sizeof(int), "int GridPath", 1);
+    GridPathOpened = (int *)MemAlloc1(size*sizeof(int), "int GridPath", 1);
+    GridPathClosed = (int *)MemAlloc1(size*sizeof(int), "int GridPath", 1);
+    GridPathCells = size;
+    GridPathStamp = INTPOSINF;
   }
-  if (!GridFindPathMidpoint(gr, fromrow, fromcol, torow, tocol, wallchars,
-                            &midrow, &midcol)) {
-    return(NULL);
+  if (GridPathStamp == INTPOSINF) {
+    memset(GridPathOpened, 0, GridPathCells*sizeof(int));
+    memset(GridPathClosed, 0, GridPathCells*sizeof(int));
+    GridPathStamp = 0;
   }
-  if (!(gp1 = GridFindPath1(gr, fromrow, fromcol, midrow, midcol, wallchars))) {
-    return(NULL);
+  GridPathStamp++;
+}
+
+#define GridOpenBefore(f1, g1, e) \
+  ((f1) < (e)->f || ((f1) == (e)->f && (g1) > (e)->g))
+
+void GridOpenPush(int f, int g, int cell)
+{
+  int	i, parent;
+  if (GridOpenLen >= GridOpenMax) {
+    if (GridOpenMax == 0) {
+      GridOpenMax = 256;
+      GridOpenHeap = (GridOpen *)MemAlloc1(GridOpenMax*sizeof(GridOpen),
+                                           "GridOpen", 1);
+    } else {
+      GridOpenMax = 2*GridOpenMax;
+      GridOpenHeap = (GridOpen *)MemRealloc(GridOpenHeap,
+                                            GridOpenMax*sizeof(GridOpen),
+                                            "GridOpen");
+    }
   }
-  if (!(gp2 = GridFindPath1(gr, midrow, midcol, torow, tocol, wallchars))) {
-    return(NULL);
+  for (i = GridOpenLen++; i > 0; i = parent) {
+    parent = (i-1)/2;
+    if (!GridOpenBefore(f, g, &GridOpenHeap[parent])) break;
+    GridOpenHeap[i] = GridOpenHeap[parent];
   }
-  gp = GridSubspaceCreate(gp1->len + gp2->len - 1, gr);
-  gp->len = gp->maxlen;
-  for (i = 0, j = 0; i < gp1->len; i++, j++) {
-    gp->rows[j] = gp1->rows[i];
-    gp->cols[j] = gp1->cols[i];
+  GridOpenHeap[i].f = f;
+  GridOpenHeap[i].g = g;
+  GridOpenHeap[i].cell = cell;
+}
+
+void GridOpenPop(/* RESULTS */ GridOpen *e)
+{
+  int		i, child;
+  GridOpen	last;
+  *e = GridOpenHeap[0];
+  last = GridOpenHeap[--GridOpenLen];
+  for (i = 0; (child = 2*i+1) < GridOpenLen; i = child) {
+    if (child+1 < GridOpenLen &&
+        GridOpenBefore(GridOpenHeap[child+1].f, GridOpenHeap[child+1].g,
+                       &GridOpenHeap[child])) {
+      child++;
+    }
+    if (!GridOpenBefore(GridOpenHeap[child].f, GridOpenHeap[child].g,
+                        &last)) {
+      break;
+    }
+    GridOpenHeap[i] = GridOpenHeap[child];
   }
-  for (i = 1; i < gp2->len; i++, j++) {
-    gp->rows[j] = gp2->rows[i];
-    gp->cols[j] = gp2->cols[i];
+  GridOpenHeap[i] = last;
+}
+
+/* Octile distance: admissible and consistent for 8-way moves. */
+int GridPathEstimate(GridCoord row1, GridCoord col1, GridCoord row2,
+                     GridCoord col2)
+{
+  int	drow, dcol;
+  drow = abs(row1-row2);
+  dcol = abs(col1-col2);
+  if (drow < dcol) return(GRIDSTEP*(dcol-drow) + GRIDDIAG*drow);
+  return(GRIDSTEP*(drow-dcol) + GRIDDIAG*dcol);
+}
+
+GridSubspace *GridPathReconstruct(Grid *gr, int start, int goal)
+{
+  int		len, cell, i;
+  GridSubspace	*gp;
+  len = 1;
+  for (cell = goal; cell != start; cell = GridPathFrom[cell]) len++;
+  gp = GridSubspaceCreate(len, gr);
+  gp->len = len;
+  for (cell = goal, i = len-1; i >= 0; cell = GridPathFrom[cell], i--) {
+    gp->rows[i] = cell/gr->cols;
+    gp->cols[i] = cell%gr->cols;
   }
-  GridSubspaceFree(gp1);
-  GridSubspaceFree(gp2);
   return(gp);
 }
 
+GridSubspace *GridFindPathAstar(Grid *gr, GridCoord fromrow, GridCoord fromcol,
+                                GridCoord torow, GridCoord tocol,
+                                char *wallchars)
+{
+  int		drow[8] = {0, 0, -1, 1, -1, -1, 1, 1};
+  int		dcol[8] = {-1, 1, 0, 0, -1, 1, -1, 1};
+  int		i, start, goal, cell, g;
+  GridCoord	row, col;
+  GridOpen	e;
+  GridPathScratch(gr->rows*gr->cols);
+  start = fromrow*gr->cols + fromcol;
+  goal = torow*gr->cols + tocol;
+  GridPathG[start] = 0;
+  GridPathOpened[start] = GridPathStamp;
+  GridOpenLen = 0;
+  GridOpenPush(GridPathEstimate(fromrow, fromcol, torow, tocol), 0, start);
+  while (GridOpenLen > 0) {
+    GridOpenPop(&e);
+    if (GridPathClosed[e.cell] == GridPathStamp) continue;
+    if (e.cell == goal) return(GridPathReconstruct(gr, start, goal));
+    GridPathClosed[e.cell] = GridPathStamp;
+    for (i = 0; i < 8; i++) {
+      row = e.cell/gr->cols + drow[i];
+      col = e.cell%gr->cols + dcol[i];
+      if (row < 0 || row >= gr->rows || col < 0 || col >= gr->cols) continue;
+      cell = row*gr->cols + col;
+      if (GridPathClosed[cell] == GridPathStamp) continue;
+      if (!GridIsEmpty(gr, row, col, wallchars)) continue;
+      g = e.g + ((drow[i] && dcol[i]) ? GRIDDIAG : GRIDSTEP);
+      if (GridPathOpened[cell] == GridPathStamp && GridPathG[cell] <= g) {
+        continue;
+      }
+      GridPathOpened[cell] = GridPathStamp;
+      GridPathG[cell] = g;
+      GridPathFrom[cell] = e.cell;
+      GridOpenPush(g + GridPathEstimate(row, col, torow, tocol), g, cell);
+    }
+  }
+  return(NULL);
+}
+
+/* A straight line of cells, when clear, is as short as any path. */
+GridSubspace *GridFindPath1(Grid *gr, GridCoord fromrow, GridCoord fromcol,
+                            GridCoord torow, GridCoord tocol, char *wallchars)
+{
+  GridSubspace	*gp;
+  Dbg(DBGGRID, DBGHYPER, "GridFindPath1 %d %d -> %d %d", fromrow, fromcol,
+      torow, tocol);
+  if ((gp = GridFindLinearPath(gr, fromrow, fromcol, torow, tocol,
+                               wallchars))) {
+    return(gp);
+  }
+  return(GridFindPathAstar(gr, fromrow, fromcol, torow, tocol, wallchars));
+}
+
 GridSubspace *GridFindPath(Grid *gr, GridCoord fromrow, GridCoord fromcol,
                            GridCoord torow, GridCoord tocol, char *wallchars)
 {
   int			fromsave, tosave;
   GridSubspace		*r;
+  GridStateEntry	*gse;
+  GridPathEntry		*gpe;
+  if ((gse = GridStateEntryOf(gr)) &&
+      (gpe = GridPathCacheGet(gse, fromrow, fromcol, torow, tocol,
+                              wallchars))) {
+    return(gpe->path ? GridSubspaceCopy(gpe->path) : NULL);
+  }
   fromsave = GR_SUB(gr, fromrow, fromcol);
   tosave = GR_SUB(gr, torow, tocol);
   GR_SUB(gr, fromrow, fromcol) = GR_EMPTY;
@@ -760,6 +1052,9 @@ GridSubspace *GridFindPath(Grid *gr, GridCoord fromrow, GridCoord fromcol,
   r = GridFindPath1(gr, fromrow, fromcol, torow, tocol, wallchars);
   GR_SUB(gr, fromrow, fromcol) = fromsave;
   GR_SUB(gr, torow, tocol) = tosave;
+  if (gse) {
+    GridPathCachePut(gse, fromrow, fromcol, torow, tocol, wallchars, r);
+  }
   return(r);
 }
 
@@ -919,19 +1214,130 @@ Grid *GridBuild(Ts *ts, Grid *gr, int namestr, int fillchar, Obj *prop)
   return(r);
 }
 
-/* Grid state cache. Could add support for multiple grids per ts. */
+/* Grid state cache. The GRIDSTATECACHE most recently used grid states,
+ * keyed by grid, timestamp, and property, each with the GRIDPATHCACHE
+ * most recently found paths in it. Cached states and paths are dropped
+ * whenever an at-grid assertion is made or retracted (cf
+ * GridStateInvalidate). They are allocated outside the scratch arena,
+ * since they outlive the request.
+ */
+
+void GridStateInvalidate(Obj *assertion)
+{
+  if (ObjLen(assertion) < 4 ||
+      !streq(ObjToName(I(assertion, 0)), "at-grid")) {
+    return;
+  }
+  GridStateEpoch++;
+}
+
+void GridPathEntryFree(GridPathEntry *gpe)
+{
+  if (gpe->path) GridSubspaceFree(gpe->path);
+  MemFree(gpe->wallchars, "char *");
+  MemFree(gpe, "GridPathEntry");
+}
+
+void GridStateEntryFree(GridStateEntry *gse)
+{
+  GridPathEntry	*gpe, *n;
+  if (gse->state) GridFree(gse->state);
+  for (gpe = gse->paths; gpe; gpe = n) {
+    n = gpe->next;
+    GridPathEntryFree(gpe);
+  }
+  gse->gridobj = gse->prop = NULL;
+  gse->state = NULL;
+  gse->used = 0L;
+  gse->pathcnt = 0;
+  gse->paths = NULL;
+}
+
+void GridStateCacheClear()
+{
+  int	i;
+  for (i = 0; i < GRIDSTATECACHE; i++) GridStateEntryFree(&GridStates[i]);
+  GridStatesEpoch = GridStateEpoch;
+}
+
+GridStateEntry *GridStateEntryOf(Grid *state)
+{
+  int	i;
+  if (state == NULL) return(NULL);
+  for (i = 0; i < GRIDSTATECACHE; i++) {
+    if (GridStates[i].state == state) return(&GridStates[i]);
+  }
+  return(NULL);
+}
+
+GridPathEntry *GridPathCacheGet(GridStateEntry *gse, GridCoord fromrow,
+                                GridCoord fromcol, GridCoord torow,
+                                GridCoord tocol, char *wallchars)
+{
+  GridPathEntry	*gpe, *prev;
+  for (prev = NULL, gpe = gse->paths; gpe; prev = gpe, gpe = gpe->next) {
+    if (gpe->fromrow == fromrow && gpe->fromcol == fromcol &&
+        gpe->torow == torow && gpe->tocol == tocol &&
+        streq(gpe->wallchars, wallchars)) {
+      if (prev) {
+        prev->next = gpe->next;
+        gpe->next = gse->paths;
+        gse->paths = gpe;
+      }
+      return(gpe);
+    }
+  }
+  return(NULL);
+}
+
+void GridPathCachePut(GridStateEntry *gse, GridCoord fromrow,
+                      GridCoord fromcol, GridCoord torow, GridCoord tocol,
+                      char *wallchars, GridSubspace *path)
+{
+  GridPathEntry	*gpe;
+  MemScratchSuspend();
+  gpe = CREATE(GridPathEntry);
+  gpe->fromrow = fromrow;
+  gpe->fromcol = fromcol;
+  gpe->torow = torow;
+  gpe->tocol = tocol;
+  gpe->wallchars = StringCopy(wallchars, "char *");
+  gpe->path = path ? GridSubspaceCopy(path) : NULL;
+  MemScratchResume();
+  gpe->next = gse->paths;
+  gse->paths = gpe;
+  if (++gse->pathcnt > GRIDPATHCACHE) {
+    for (gpe = gse->paths; gpe->next->next; gpe = gpe->next);
+    GridPathEntryFree(gpe->next);
+    gpe->next = NULL;
+    gse->pathcnt--;
+  }
+}
 
 Grid *GridStateGet(Ts *ts, Obj *gridobj, Obj *prop)
 {
-  if (TsNE(ts, &LastGridTs) || LastGridProp != prop ||
-      gridobj != LastGridObj) {
-    if (LastGridState) GridFree(LastGridState);
-    LastGridState = GridBuild(ts, ObjToGrid(gridobj), 0, GR_FILL, prop);
-    LastGridObj = gridobj;
-    LastGridTs = *ts;
-    LastGridProp = prop;
-  } 
-  return(LastGridState);
+  int			i, lru;
+  GridStateEntry	*gse;
+  if (GridStatesEpoch != GridStateEpoch) GridStateCacheClear();
+  for (i = 0, lru = 0; i < GRIDSTATECACHE; i++) {
+    gse = &GridStates[i];
+    if (gse->gridobj == gridobj && gse->prop == prop &&
+        TsEQ(&gse->ts, ts) && gse->ts.cx == ts->cx) {
+      gse->used = ++GridStateUsed;
+      return(gse->state);
+    }
+    if (gse->used < GridStates[lru].used) lru = i;
+  }
+  gse = &GridStates[lru];
+  GridStateEntryFree(gse);
+  MemScratchSuspend();
+  gse->state = GridBuild(ts, ObjToGrid(gridobj), 0, GR_FILL, prop);
+  MemScratchResume();
+  gse->gridobj = gridobj;
+  gse->prop = prop;
+  gse->ts = *ts;
+  gse->used = ++GridStateUsed;
+  return(gse->state);
 }
 
 Bool GridObjAtRowCol(Obj *grid, GridCoord row, GridCoord col)
@@ -12,6 +12,7 @@ Float GridDistance1(Float rowdist, Float coldist, GridCoord row1, GridCoord col1
 Float GridDistance(Obj *grid, GridCoord row1, GridCoord col1, GridCoord row2, GridCoord col2);
 GridSubspace *GridSubspaceCreate(int maxlen, Grid *grid);
 GridSubspace *GridSubspaceCopyShared(GridSubspace *old_gs);
+GridSubspace *GridSubspaceCopy(GridSubspace *old_gs);
 void GridSubspaceAdd(GridSubspace *gs, GridCoord row, GridCoord col);
 void GridSubspaceAddGrid(GridSubspace *gs, Grid *gr);
 void GridSubspaceFree(GridSubspace *gs);
@@ -25,16 +26,29 @@ void GridSubspaceTextPrint(Text *text, GridSubspace *gs);
 IntergridPath *IntergridPathCreate(int len);
 void IntergridPathAddNext(IntergridPath *igp, Obj *grid, Obj *wormhole);
 void IntergridPathFree(IntergridPath *igp);
-IntergridPath *IntergridFindPath1(Ts *ts, TsRange *tsr, Obj *gr1, Obj *gr2, Obj *grvia, int maxdepth);
-IntergridPath *IntergridFindPath(Ts *ts, TsRange *tsr, Obj *gr1, Obj *gr2);
+int IntergridHashOf(Obj *obj);
+void IntergridGraphEnter(Obj *assertion);
+void IntergridGraphBuild(void);
+Float IntergridDistance(IntergridDoor *d, GridCoord row1, GridCoord col1, GridCoord row2, GridCoord col2);
+int IntergridLabelAdd(IntergridLabel **labels, int **heap, int *len, int *maxlen);
+void IntergridHeapPush(int *heap, int *heaplen, IntergridLabel *labels, int l);
+int IntergridHeapPop(int *heap, int *heaplen, IntergridLabel *labels);
+Bool IntergridLabelVisited(IntergridLabel *labels, int l, Obj *grid);
+IntergridPath *IntergridLabelPath(IntergridLabel *labels, int l);
+int IntergridFindPaths(Ts *ts, TsRange *tsr, Obj *gr1, GridCoord row1, GridCoord col1, Obj *gr2, GridCoord row2, GridCoord col2, int k, IntergridPath **paths);
 Grid *GridParse(Obj *grid, char *s, int sep);
 Grid *GridRead(FILE *stream, Obj *grid);
 void GridReadVariables(FILE *stream, Grid *gr);
 void GridReadVariable(char *line, int required, Grid *gr, FILE *stream);
 void GridFill(Grid *srcgr, Grid *destgr, char *wallchars);
 void GridSubspaceFill(Grid *srcgr, GridSubspace *destgs, char *wallchars);
-int GridFindPathMidpoint(Grid *srcgr, GridCoord fromrow, GridCoord fromcol, GridCoord torow, GridCoord tocol, char *wallchars, GridCoord *midrow, GridCoord *midcol);
 GridSubspace *GridFindLinearPath(Grid *gr, GridCoord fromrow, GridCoord fromcol, GridCoord torow, GridCoord tocol, char *wallchars);
+void GridPathScratch(int size);
+void GridOpenPush(int f, int g, int cell);
+void GridOpenPop(GridOpen *e);
+int GridPathEstimate(GridCoord row1, GridCoord col1, GridCoord row2, GridCoord col2);
+GridSubspace *GridPathReconstruct(Grid *gr, int start, int goal);
+GridSubspace *GridFindPathAstar(Grid *gr, GridCoord fromrow, GridCoord fromcol, GridCoord torow, GridCoord tocol, char *wallchars);
 GridSubspace *GridFindPath1(Grid *gr, GridCoord fromrow, GridCoord fromcol, GridCoord torow, GridCoord tocol, char *wallchars);
 GridSubspace *GridFindPath(Grid *gr, GridCoord fromrow, GridCoord fromcol, GridCoord torow, GridCoord tocol, char *wallchars);
 void GridSubspaceSimplify(GridSubspace *gs);
@@ -43,5 +57,12 @@ int GridPlopdownText1(Grid *to, char *text, int len, GridCoord row, GridCoord co
 void GridPlopdownText(Grid *to, char *text, GridCoord row, GridCoord col);
 Bool GridFindAccessibleBorder(GridSubspace *gs, Grid *gr, GridCoord *rowp, GridCoord *colp);
 Grid *GridBuild(Ts *ts, Grid *gr, int namestr, int fillchar, Obj *prop);
+void GridStateInvalidate(Obj *assertion);
+void GridPathEntryFree(GridPathEntry *gpe);
+void GridStateEntryFree(GridStateEntry *gse);
+void GridStateCacheClear(void);
+GridStateEntry *GridStateEntryOf(Grid *state);
+GridPathEntry *GridPathCacheGet(GridStateEntry *gse, GridCoord fromrow, GridCoord fromcol, GridCoord torow, GridCoord tocol, char *wallchars);
+void GridPathCachePut(GridStateEntry *gse, GridCoord fromrow, GridCoord fromcol, GridCoord torow, GridCoord tocol, char *wallchars, GridSubspace *path);
 Grid *GridStateGet(Ts *ts, Obj *gridobj, Obj *prop);
 Bool GridObjAtRowCol(Obj *grid, GridCoord row, GridCoord col);
@@ -0,0 +1,269 @@
+/*
+ * ThoughtTreasure
+ * Copyright 1996, 1997, 1998, 1999, 2015 Erik Thomas Mueller.
+ * All Rights Reserved.
+ *
+ * 20261017T230000: begun
+ *
+ * Forward chaining on the "if" rules (InferenceRules), run by DbAssert1
+ * on each new assertion. The network is Rete-style minus beta memories:
+ *   - The alpha network, InferenceAlpha, maps the predicate of an
+ *     assertion to the rules having a condition that could match it, so
+ *     that an assertion only touches those rules.
+ *   - For each condition the assertion unifies with, the remaining
+ *     conditions are joined against the database by Prove, with the
+ *     bindings so far. The database indices (cf DbIndexEnter) serve as
+ *     the alpha memories, so nothing is stored twice.
+ * Consequents are instantiated with the timestamp range of the assertion
+ * that triggered them and are put on an agenda, which is asserted
+ * breadth first. A consequent that is already true, or was already
+ * derived from the same top-level assertion (InferenceDerived, a list
+ * freed when that assertion is done), is dropped. This stops cycles such
+ * as a symmetric rule "if [adore X Y] then [adore Y X]", whose consequent
+ * matches its own condition. Each assertion may fire at most
+ * INFERENCEMAXFIRINGS rules, counting those fired by its consequences.
+ * Forward chaining is turned on and off by the inferon and inferoff
+ * shell commands (InferenceOn).
+ */
+
+#include "tt.h"
+#include "repbasic.h"
+#include "repdb.h"
+#include "repinfer.h"
+#include "repobj.h"
+#include "repobjl.h"
+#include "repprove.h"
+#include "utildbg.h"
+
+#define INFERENCEMAXFIRINGS	100
+
+Bool	InferenceOn;
+DbIndex	*InferenceAlpha;
+ObjList	*InferenceDerived;
+int	InferenceAlphaEpoch;
+Bool	InferenceRunning;
+long	InferenceFirings;
+ObjList	*InferenceAgenda;
+
+void InferenceForwardInit()
+{
+  InferenceOn = 1;
+  InferenceAlpha = NULL;
+  InferenceDerived = NULL;
+  InferenceRunning = 0;
+  InferenceAgenda = NULL;
+}
+
+/* Whether a condition is matched against assertions, rather than proven
+ * (isa, and, or, not, comparisons).
+ */
+Bool InferenceCondIsPattern(Obj *cond)
+{
+  Obj	*head;
+  if (!ObjIsList(cond)) return(0);
+  head = I(cond, 0);
+  if (head == NULL || !ObjIsSymbol(head)) return(0);
+  if (head == N("isa") || head == N("ako") || head == N("and") ||
+      head == N("or") || head == N("not")) {
+    return(0);
+  }
+  return(!ISA(N("arithmetic-relation"), head));
+}
+
+int InferenceCondLen(Obj *rule)
+{
+  Obj	*ante;
+  ante = I(rule, 1);
+  if (N("and") == I(ante, 0)) return(ObjLen(ante)-1);
+  return(1);
+}
+
+Obj *InferenceCond(Obj *rule, int i)
+{
+  Obj	*ante;
+  ante = I(rule, 1);
+  if (N("and") == I(ante, 0)) return(I(ante, i+1));
+  return(ante);
+}
+
+/* Returns the conditions of <rule> other than the <i>th, or NULL. */
+Obj *InferenceCondRest(Obj *rule, int i)
+{
+  int	j, k, len;
+  Obj	*elems[MAXLISTLEN];
+  len = InferenceCondLen(rule);
+  if (len <= 1) return(NULL);
+  elems[0] = N("and");
+  for (j = 0, k = 1; j < len; j++) {
+    if (j != i) elems[k++] = InferenceCond(rule, j);
+  }
+  if (k == 2) return(elems[1]);
+  return(ObjCreateList1(elems, k));
+}
+
+Bool InferenceRuleMayMatch(Obj *rule, Obj *pred)
+{
+  int	i, len;
+  Obj	*cond;
+  for (i = 0, len = InferenceCondLen(rule); i < len; i++) {
+    cond = InferenceCond(rule, i);
+    if (!InferenceCondIsPattern(cond)) continue;
+    if (ObjIsVar(I(cond, 0)) || ISA(I(cond, 0), pred)) return(1);
+  }
+  return(0);
+}
+
+/* Returns the rules which might be triggered by an assertion of <pred>. */
+ObjList *InferenceAlphaRules(Obj *pred)
+{
+  ObjList	*p, *r;
+  DbIndexEntry	*de;
+  MemScratchSuspend();
+  if (InferenceAlpha == NULL) {
+    InferenceAlpha = DbIndexCreate(64L, "InferenceAlpha");
+    InferenceAlphaEpoch = IsaLinkEpoch;
+  } else if (InferenceAlphaEpoch != IsaLinkEpoch) {
+    DbIndexClear(InferenceAlpha);
+    InferenceAlphaEpoch = IsaLinkEpoch;
+  }
+  de = DbIndexSlot(InferenceAlpha, DbIndexKey(pred), 0L);
+  if (de->objs == NULL) {
+    r = NULL;
+    for (p = InferenceRules; p; p = p->next) {
+      if (InferenceRuleMayMatch(p->obj, pred)) r = ObjListCreate(p->obj, r);
+    }
+    /* The entry starts with <pred> so that it is nonempty. */
+    de->objs = ObjListCreate(pred, ObjListReverseDest(r));
+    de->a = DbIndexKey(pred);
+    de->b = 0L;
+    InferenceAlpha->count++;
+    r = de->objs->next;
+    if (InferenceAlpha->count > (size_t)(HASHMAXLOAD*InferenceAlpha->size)) {
+      DbIndexGrow(InferenceAlpha);
+    }
+  } else {
+    r = de->objs->next;
+  }
+  MemScratchResume();
+  return(r);
+}
+
+void InferenceAlphaClear()
+{
+  if (InferenceAlpha) DbIndexClear(InferenceAlpha);
+}
+
+Bool InferenceIsGround(Obj *obj)
+{
+  int	i, len;
+  if (ObjIsVar(obj)) return(0);
+  if (ObjIsList(obj)) {
+    for (i = 0, len = ObjLen(obj); i < len; i++) {
+      if (!InferenceIsGround(I(obj, i))) return(0);
+    }
+  }
+  return(1);
+}
+
+Bool InferenceIsDerived(Obj *obj)
+{
+  ObjList	*p;
+  for (p = InferenceDerived; p; p = p->next) {
+    if (ObjSimilarList(p->obj, obj)) return(1);
+  }
+  return(0);
+}
+
+void InferenceFire(Obj *rule, Bd *bd, Obj *fact)
+{
+  Obj	*obj;
+  TsRange	*tsr;
+  if (InferenceFirings >= INFERENCEMAXFIRINGS) return;
+  InferenceFirings++;
+  obj = ObjInstan(I(rule, 2), bd);
+  if (!InferenceIsGround(obj)) {
+    Dbg(DBGOBJ, DBGDETAIL, "InferenceFire: unbound variable in consequent");
+    return;
+  }
+  tsr = ObjToTsRange(fact);
+  ObjSetTsRange(obj, tsr);
+  if (InferenceIsDerived(obj)) return;
+  InferenceDerived = ObjListCreate(obj, InferenceDerived);
+  if (YES(ZRE(&tsr->startts, obj))) {
+    Dbg(DBGDB, DBGHYPER, "already true:");
+    DbgOP(DBGDB, DBGHYPER, obj);
+    return;
+  }
+  if (DbgOn(DBGOBJ, DBGDETAIL)) {
+    fputs("inferred ", Log);
+    ObjPrint(Log, obj);
+    fputs(" from ", Log);
+    ObjPrint(Log, fact);
+    fputc(NEWLINE, Log);
+  }
+  InferenceAgenda = ObjListAppendDestructive(InferenceAgenda,
+                                             ObjListCreate(obj, NULL));
+}
+
+/* Fires the rules whose conditions are satisfied by way of <fact>. */
+void InferenceMatch(Obj *fact)
+{
+  int		i, len;
+  Obj		*cond, *rest;
+  Bd		*bd;
+  ObjList	*p;
+  Proof		*proofs, *pr;
+  TsRange	*tsr;
+  if (!ObjIsList(fact) || !ObjIsSymbol(I(fact, 0))) return;
+  tsr = ObjToTsRange(fact);
+  for (p = InferenceAlphaRules(I(fact, 0)); p; p = p->next) {
+    for (i = 0, len = InferenceCondLen(p->obj); i < len; i++) {
+      if (InferenceFirings >= INFERENCEMAXFIRINGS) return;
+      cond = InferenceCond(p->obj, i);
+      if (!InferenceCondIsPattern(cond)) continue;
+      if (!(bd = ObjUnify2(cond, fact, BdCreate()))) continue;
+      if (!(rest = InferenceCondRest(p->obj, i))) {
+        InferenceFire(p->obj, bd, fact);
+        continue;
+      }
+      rest = ObjInstan(rest, bd);
+      if (Prove(&tsr->startts, NULL, rest, NULL, 1, &proofs)) {
+        for (pr = proofs; pr; pr = pr->next) {
+          InferenceFire(p->obj, BdCopyAppend(bd, pr->bd), fact);
+        }
+      }
+    }
+  }
+}
+
+/* Called by DbAssert1 for each assertion once Starting is over.
+ * Consequences of consequences are matched as they are asserted from the
+ * agenda, within the budget of the outermost assertion.
+ */
+void InferenceAssert(Obj *obj)
+{
+  Obj	*fact;
+  if (!InferenceOn || InferenceRules == NULL) return;
+  if (InferenceRunning) {
+    InferenceMatch(obj);
+    return;
+  }
+  InferenceRunning = 1;
+  InferenceFirings = 0;
+  InferenceDerived = NULL;
+  InferenceMatch(obj);
+  while (InferenceAgenda) {
+    fact = InferenceAgenda->obj;
+    InferenceAgenda = InferenceAgenda->next;
+    DbAssert1(fact);
+  }
+  if (InferenceFirings >= INFERENCEMAXFIRINGS) {
+    Dbg(DBGDB, DBGBAD, "InferenceAssert: work budget exhausted");
+    DbgOP(DBGDB, DBGBAD, obj);
+  }
+  ObjListFree(InferenceDerived);
+  InferenceDerived = NULL;
+  InferenceRunning = 0;
+}
+
+/* End of file. */
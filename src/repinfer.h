@@ -0,0 +1,14 @@
+/* repinfer.c */
+void InferenceForwardInit(void);
+Bool InferenceCondIsPattern(Obj *cond);
+int InferenceCondLen(Obj *rule);
+Obj *InferenceCond(Obj *rule, int i);
+Obj *InferenceCondRest(Obj *rule, int i);
+Bool InferenceRuleMayMatch(Obj *rule, Obj *pred);
+ObjList *InferenceAlphaRules(Obj *pred);
+void InferenceAlphaClear(void);
+Bool InferenceIsGround(Obj *obj);
+Bool InferenceIsDerived(Obj *obj);
+void InferenceFire(Obj *rule, Bd *bd, Obj *fact);
+void InferenceMatch(Obj *fact);
+void InferenceAssert(Obj *obj);
@@ -14,6 +14,12 @@
  * 19950330: added Tsr objects
  * 19951027: added pn_list to objects; cosmetic changes to code
  * 19951111: reorganized Obj from 108 bytes into 76 nicer bytes
+ * 20261017T123000: added ISA cache
+ * 20261017T130000: added pre-resolved concept handles
+ * 20261017T160000: scratch objects are not entered in Objs
+ * 20261017T200000: locking for the threaded server
+ * 20261018T100000: dense object ids and marked traversals
+ * 20261018T140000: bidirectional shortest paths and path length cache
  */
 
 #include "tt.h"
@@ -38,9 +44,84 @@
 #include "utilhtml.h"
 
 HashTable *ObjHash;
+int IsaEpoch, IsaLinkEpoch, ObjNextId;
 Obj *ObjWild, *ObjNA, *Objs, *OBJDEFER;
 Bool IncreaseMsg;
 long ObjParentLinkCnt;
+long NameToObjCnt;
+
+Obj *N_F63, *N_F68, *N_F71, *N_F72, *N_F100, *N_F101, *N_F102,
+  *N_eng_infl_tense_of, *N_eng_infl_mood_of, *N_auxiliary_verb,
+  *N_progressive_tense, *N_infinitive, *N_imperative, *N_expl, *N_aobj,
+  *N_subj, *N_obj, *N_iobj, *N_tsrobj, *N_spatial, *N_spatial_preposition,
+  *N_location_interrogative_pronoun, *N_noun_phrase_pronoun,
+  *N_relative_pronoun, *N_determining_interrogative_pronoun, *N_copula,
+  *N_appearance_copula, *N_action, *N_object_interrogative_pronoun,
+  *N_intervention, *N_such_that, *N_determiner_article, *N_relation, *N_one,
+  *N_pronoun_there_expletive, *N_and, *N_or, *N_not, *N_nonhuman, *N_human,
+  *N_location, *N_physical_object, *N_polity, *N_number, *N_list, *N_string,
+  *N_time_range, *N_concept, *N_parse, *N_generate, *N_title, *N_human_name,
+  *N_X_MAX, *N_Y_MAX, *N_W_MAX, *N_prep_adjunct_OK;
+
+ObjHandle ObjHandles[] = {
+  {&N_F63, "F63"},
+  {&N_F68, "F68"},
+  {&N_F71, "F71"},
+  {&N_F72, "F72"},
+  {&N_F100, "F100"},
+  {&N_F101, "F101"},
+  {&N_F102, "F102"},
+  {&N_eng_infl_tense_of, "eng-infl-tense-of"},
+  {&N_eng_infl_mood_of, "eng-infl-mood-of"},
+  {&N_auxiliary_verb, "auxiliary-verb"},
+  {&N_progressive_tense, "progressive-tense"},
+  {&N_infinitive, "infinitive"},
+  {&N_imperative, "imperative"},
+  {&N_expl, "expl"},
+  {&N_aobj, "aobj"},
+  {&N_subj, "subj"},
+  {&N_obj, "obj"},
+  {&N_iobj, "iobj"},
+  {&N_tsrobj, "tsrobj"},
+  {&N_spatial, "spatial"},
+  {&N_spatial_preposition, "spatial-preposition"},
+  {&N_location_interrogative_pronoun, "location-interrogative-pronoun"},
+  {&N_noun_phrase_pronoun, "noun-phrase-pronoun"},
+  {&N_relative_pronoun, "relative-pronoun"},
+  {&N_determining_interrogative_pronoun, "determining-interrogative-pronoun"},
+  {&N_copula, "copula"},
+  {&N_appearance_copula, "appearance-copula"},
+  {&N_action, "action"},
+  {&N_object_interrogative_pronoun, "object-interrogative-pronoun"},
+  {&N_intervention, "intervention"},
+  {&N_such_that, "such-that"},
+  {&N_determiner_article, "determiner-article"},
+  {&N_relation, "relation"},
+  {&N_one, "one"},
+  {&N_pronoun_there_expletive, "pronoun-there-expletive"},
+  {&N_and, "and"},
+  {&N_or, "or"},
+  {&N_not, "not"},
+  {&N_nonhuman, "nonhuman"},
+  {&N_human, "human"},
+  {&N_location, "location"},
+  {&N_physical_object, "physical-object"},
+  {&N_polity, "polity"},
+  {&N_number, "number"},
+  {&N_list, "list"},
+  {&N_string, "string"},
+  {&N_time_range, "time-range"},
+  {&N_concept, "concept"},
+  {&N_parse, "parse"},
+  {&N_generate, "generate"},
+  {&N_title, "title"},
+  {&N_human_name, "human-name"},
+  {&N_X_MAX, "X-MAX"},
+  {&N_Y_MAX, "Y-MAX"},
+  {&N_W_MAX, "W-MAX"},
+  {&N_prep_adjunct_OK, "prep-adjunct-OK"},
+  {NULL, NULL}
+};
 
 /******************************************************************************
  * INITIALIZATION
@@ -51,14 +132,51 @@ void ObjInit()
   Dbg(DBGOBJ, DBGDETAIL, "ObjInit", E);
   IncreaseMsg = 0;
   ObjParentLinkCnt = 0;
+  IsaEpoch = 1;
+  IsaLinkEpoch = 0;
+  ObjNextId = 0;
   Objs = NULL;
-  ObjHash = HashTableCreate(30001L);
+  ObjHash = HashTableCreate(30001L, "ObjHash");
   ObjWild = NameToObj("?", OBJ_CREATE_A);
   ObjNA = N("na");
   ObjAddIsa(ObjWild, NameToObj("concept", OBJ_CREATE_A));
   OBJDEFER = NameToObj("OBJDEFER", OBJ_CREATE_A);
 }
 
+/* Resolve the concepts named in ObjHandles as soon as the object table
+ * exists, so that code run while the database is being read (ISAP,
+ * DbGenIsPruned, DbRestrictValidate) can already compare against N_xxx.
+ * The database later fills in these same objects by name.
+ */
+void ObjHandlesInit()
+{
+  ObjHandle	*oh;
+  for (oh = ObjHandles; oh->obj; oh++) {
+    *oh->obj = N(oh->name);
+  }
+}
+
+/* Once the database is loaded, report any handle the database does not
+ * define, rather than leaving it to silently misbehave during a parse.
+ */
+void ObjHandlesCheck()
+{
+  ObjHandle	*oh;
+  int		missing;
+  missing = 0;
+  for (oh = ObjHandles; oh->obj; oh++) {
+    if ((*oh->obj)->u1.nlst.numparents == 0 &&
+        (*oh->obj)->u1.nlst.numchildren == 0) {
+      Dbg(DBGOBJ, DBGBAD, "ObjHandlesCheck: <%s> not defined", oh->name);
+      missing++;
+    }
+  }
+  if (missing) {
+    Dbg(DBGOBJ, DBGBAD, "ObjHandlesCheck: %d undefined handle(s)", missing);
+  }
+  FeatToConInit();
+}
+
 /******************************************************************************
  * CREATING
  ******************************************************************************/
@@ -70,12 +188,12 @@ Obj *ObjCreateRawNonlist()
   obj->u1.nlst.numparents = obj->u1.nlst.numchildren = 0;
   obj->u1.nlst.maxparents = obj->u1.nlst.maxchildren = 0;
   obj->u1.nlst.parents = obj->u1.nlst.children = NULL;
+  obj->u1.nlst.ancestors = NULL;
+  obj->u1.nlst.numancestors = obj->u1.nlst.ancepoch = 0;
+  obj->u1.nlst.id = ATOMICFETCHADD(&ObjNextId, 1);
   obj->u2.any = NULL;
-  obj->next = Objs;
-  if (Objs) Objs->prev = obj;
-  obj->prev = NULL;
   obj->ole = NULL;
-  Objs = obj;
+  ObjLink(obj);
   return(obj);
 }
 
@@ -88,12 +206,24 @@ Obj *ObjCreateRawList(int force_malloc)
   obj->u1.lst.justification = NULL;
   obj->u1.lst.superseded_by = NULL;
   TsRangeSetNa(&obj->u2.tsr);
+  obj->ole = NULL;
+  ObjLink(obj);
+  return(obj);
+}
+
+/* Objects in scratch memory are not entered in Objs, which outlives them. */
+void ObjLink(Obj *obj)
+{
+  if (MemScratchContains(obj)) {
+    obj->next = obj->prev = NULL;
+    return;
+  }
+  ThreadLock();
   obj->next = Objs;
   if (Objs) Objs->prev = obj;
   obj->prev = NULL;
-  obj->ole = NULL;
   Objs = obj;
-  return(obj);
+  ThreadUnlock();
 }
 
 void ObjFindUnusedName(Obj *parent, char *prefix,
@@ -299,15 +429,22 @@ Obj *NameToObj(char *name, int flag)
 {
   Obj *obj;
 
-  if ((obj = (Obj *)HashTableGet(ObjHash, name))) return(obj);
-  if (flag == OBJ_NO_CREATE) return(NULL);
+  ThreadLock();
+  NameToObjCnt++;
+  if ((obj = (Obj *)HashTableGet(ObjHash, name)) || flag == OBJ_NO_CREATE) {
+    ThreadUnlock();
+    return(obj);
+  }
   Dbg(DBGOBJ, DBGHYPER, "creating <%s>", name);
+  MemScratchSuspend();
   obj = ObjCreateRawNonlist();
   obj->u1.nlst.name = StringCopy(name, "char Obj name");
   HashTableSet(ObjHash, obj->u1.nlst.name, obj);
+  MemScratchResume();
   if (flag == OBJ_CREATE_AC) obj->type = OBJTYPEACSYMBOL;
   else if (flag == OBJ_CREATE_C) obj->type = OBJTYPECSYMBOL;
   else obj->type = OBJTYPEASYMBOL;
+  ThreadUnlock();
   return(obj);
 }
 
@@ -521,6 +658,7 @@ void ObjFree(Obj *obj)
     Stop();
     return;
   }
+  ThreadLock();
   if (obj == Objs) {
     Objs = obj->next;
     if (obj->next) obj->next->prev = NULL;
@@ -528,6 +666,7 @@ void ObjFree(Obj *obj)
     obj->prev->next = obj->next;
     if (obj->next) obj->next->prev = obj->prev;
   }
+  ThreadUnlock();
   MemFree(obj->u1.lst.list, "Obj* list");
   if (obj->u1.lst.pn_list) {
     MemFree(obj->u1.lst.pn_list, "PNode* list");
@@ -936,8 +1075,8 @@ void ObjAddParent(Obj *obj, Obj *parent)
 #endif
     obj->u1.nlst.maxparents = 1;
     obj->u1.nlst.parents =
-      (Obj **)MemAlloc(obj->u1.nlst.maxparents*sizeof(Obj *),
-                       "Obj* parents");
+      (Obj **)MemAlloc1(obj->u1.nlst.maxparents*sizeof(Obj *),
+                        "Obj* parents", !MemScratchContains(obj));
   } else if (obj->u1.nlst.numparents >= obj->u1.nlst.maxparents) {
 #ifdef maxchecking
     if (obj->u1.nlst.numparents > obj->u1.nlst.maxparents) {
@@ -951,6 +1090,7 @@ void ObjAddParent(Obj *obj, Obj *parent)
                          obj->u1.nlst.maxparents*sizeof(Obj *),
                          "Obj* parents");
   }
+  if (!MemScratchContains(obj)) MemScratchPin(parent);
   obj->u1.nlst.parents[obj->u1.nlst.numparents] = parent;
   obj->u1.nlst.numparents++;
 }
@@ -972,8 +1112,8 @@ void ObjAddChild(Obj *obj, Obj *child)
 #endif
     obj->u1.nlst.maxchildren = 1;
     obj->u1.nlst.children =
-      (Obj **)MemAlloc(obj->u1.nlst.maxchildren*sizeof(Obj *),
-                       "Obj* children");
+      (Obj **)MemAlloc1(obj->u1.nlst.maxchildren*sizeof(Obj *),
+                        "Obj* children", !MemScratchContains(obj));
   } else if (obj->u1.nlst.numchildren >= obj->u1.nlst.maxchildren) {
 #ifdef maxchecking
     if (obj->u1.nlst.numchildren > obj->u1.nlst.maxchildren) {
@@ -986,6 +1126,7 @@ void ObjAddChild(Obj *obj, Obj *child)
                                obj->u1.nlst.maxchildren*sizeof(Obj *),
                                "Obj* children");
   }
+  if (!MemScratchContains(obj)) MemScratchPin(child);
   obj->u1.nlst.children[obj->u1.nlst.numchildren] = child;
   obj->u1.nlst.numchildren++;
 }
@@ -995,6 +1136,8 @@ void ObjAddIsa1(Obj *obj, Obj *parent)
   Dbg(DBGOBJ, DBGHYPER, "ObjAddIsa <%s> <%s>", M(obj), M(parent), E);
   ObjAddParent(obj, parent);
   ObjAddChild(parent, obj);
+  ObjAncestorsInvalidate(obj);
+  IsaLinkEpoch++;
 }
 
 void ObjAddIsa(Obj *obj, Obj *parent)
@@ -1084,10 +1227,127 @@ Bool ISA1(Obj *anc, Obj *des, int depth)
   return(0);
 }
 
+/* ISA cache
+ *
+ * Once loading is finished, the ancestors of an object within MAXISADEPTH
+ * links are computed on first use and kept sorted by address, so that ISA
+ * is a binary search. Adding a parent to a leaf (the common case of a new
+ * instance) invalidates only that leaf; adding a parent to an object with
+ * children invalidates every cache by advancing IsaEpoch.
+ */
+
+#define ISASEENSIZE	8192	/* power of 2 */
+#define ISAMAXANC	(ISASEENSIZE/2)
+
+Obj	*IsaSeenObj[ISASEENSIZE];
+int	IsaSeenGen[ISASEENSIZE];
+int	IsaGen;
+Obj	*IsaQueue[ISAMAXANC];
+
+void ObjAncestorsInvalidate(Obj *obj)
+{
+  if (obj->u1.nlst.numchildren == 0) obj->u1.nlst.ancepoch = 0;
+  else IsaEpoch++;
+}
+
+/* Adds <obj> to the set of objects seen by the current computation.
+ * Returns 1 if it was already there.
+ */
+Bool ObjAncestorsSeen(Obj *obj)
+{
+  size_t	i;
+  for (i = (((unsigned long)obj) >> 4) & (ISASEENSIZE-1);
+       IsaSeenGen[i] == IsaGen;
+       i = (i + 1) & (ISASEENSIZE-1)) {
+    if (IsaSeenObj[i] == obj) return(1);
+  }
+  IsaSeenObj[i] = obj;
+  IsaSeenGen[i] = IsaGen;
+  return(0);
+}
+
+int ObjAncestorsCompare(const void *p1, const void *p2)
+{
+  unsigned long	a1, a2;
+  a1 = (unsigned long)*((Obj **)p1);
+  a2 = (unsigned long)*((Obj **)p2);
+  if (a1 < a2) return(-1);
+  if (a1 > a2) return(1);
+  return(0);
+}
+
+/* Breadth-first over parents to the same depth as ISA1. Returns 0 if
+ * <obj> has too many ancestors to cache.
+ */
+Bool ObjAncestorsCompute(Obj *obj)
+{
+  int	head, tail, levelend, depth, i;
+  Obj	*anc, *parent;
+  IsaGen++;
+  head = tail = 0;
+  IsaQueue[tail++] = obj;
+  ObjAncestorsSeen(obj);
+  for (depth = 0; depth < MAXISADEPTH && head < tail; depth++) {
+    for (levelend = tail; head < levelend; head++) {
+      anc = IsaQueue[head];
+      if (anc->type == OBJTYPELIST) continue;
+      for (i = 0; i < anc->u1.nlst.numparents; i++) {
+        parent = anc->u1.nlst.parents[i];
+        if (ObjAncestorsSeen(parent)) continue;
+        if (tail >= ISAMAXANC) return(0);
+        IsaQueue[tail++] = parent;
+      }
+    }
+  }
+  qsort(IsaQueue, (size_t)tail, sizeof(Obj *), ObjAncestorsCompare);
+  if (obj->u1.nlst.ancestors == NULL) {
+    obj->u1.nlst.ancestors = (Obj **)MemAlloc1(tail*sizeof(Obj *),
+                                               "Obj* ancestors",
+                                               !MemScratchContains(obj));
+  } else if (obj->u1.nlst.numancestors != tail) {
+    obj->u1.nlst.ancestors = (Obj **)MemRealloc(obj->u1.nlst.ancestors,
+                                                tail*sizeof(Obj *),
+                                                "Obj* ancestors");
+  }
+  memcpy(obj->u1.nlst.ancestors, IsaQueue, tail*sizeof(Obj *));
+  obj->u1.nlst.numancestors = tail;
+  ATOMICSTORE(&obj->u1.nlst.ancepoch, IsaEpoch);
+  return(1);
+}
+
+/* ObjAncestorsCompute unless another server thread got there first. */
+Bool ObjAncestorsCache(Obj *obj)
+{
+  Bool	r;
+  ThreadLock();
+  if (obj->u1.nlst.ancepoch == IsaEpoch) r = 1;
+  else r = ObjAncestorsCompute(obj);
+  ThreadUnlock();
+  return(r);
+}
+
 Bool ISA(Obj *anc, Obj *des)
 {
+  register int		lo, hi, mid;
+  register Obj		**ancestors;
   if ((!anc) || (!des)) return(0);
-  return(ISA1(anc, des, MAXISADEPTH));
+  if (anc == des) return(1);
+  if (des->type == OBJTYPELIST) return(0);
+  if (Starting) return(ISA1(anc, des, MAXISADEPTH));
+  if (ATOMICLOAD(&des->u1.nlst.ancepoch) != IsaEpoch &&
+      (!ObjAncestorsCache(des))) {
+    return(ISA1(anc, des, MAXISADEPTH));
+  }
+  ancestors = des->u1.nlst.ancestors;
+  lo = 0;
+  hi = des->u1.nlst.numancestors - 1;
+  while (lo <= hi) {
+    mid = (lo + hi) >> 1;
+    if (ancestors[mid] == anc) return(1);
+    if ((unsigned long)ancestors[mid] < (unsigned long)anc) lo = mid + 1;
+    else hi = mid - 1;
+  }
+  return(0);
 }
 
 Bool ISAP(Obj *class, Obj *obj)
@@ -1096,22 +1356,22 @@ Bool ISAP(Obj *class, Obj *obj)
   Obj		*noun;
   ObjList	*props;
   if ((!class) || (!obj)) return(0);
-  if (ISA(N("F68"), I(obj, 0))) {
+  if (ISA(N_F68, I(obj, 0))) {
   /* Determiner: "the cat" recurse on "cat" */
     return(ISAP(class, I(obj, 1)));
   }
   if (ObjIsList(class)) {
-    if (I(class, 0) == N("or")) {
+    if (I(class, 0) == N_or) {
       for (i = 1, len = ObjLen(class); i < len; i++) {
         if (ISAP(I(class, i), obj)) return(1);
       }
       return(0);
-    } else if (I(class, 0) == N("and")) {
+    } else if (I(class, 0) == N_and) {
       for (i = 1, len = ObjLen(class); i < len; i++) {
         if (!ISAP(I(class, i), obj)) return(0);
       }
       return(1);
-    } else if (I(class, 0) == N("not")) {
+    } else if (I(class, 0) == N_not) {
       for (i = 1, len = ObjLen(class); i < len; i++) {
         if (ISAP(I(class, i), obj)) return(0);
       }
@@ -1120,27 +1380,27 @@ Bool ISAP(Obj *class, Obj *obj)
     return(0);
   }
   if (obj == ObjNA) return(1);
-  if (class == N("nonhuman")) return(!ISAP(N("human"), obj));
+  if (class == N_nonhuman) return(!ISAP(N_human, obj));
            /* todo: --> [not human] */
-  if (class == N("location")) {
-    return(ISAP(N("physical-object"), obj) ||
-           ISAP(N("polity"), obj));
+  if (class == N_location) {
+    return(ISAP(N_physical_object, obj) ||
+           ISAP(N_polity, obj));
   }
   if (ObjIsVar(obj)) return(1);
-  if (ISA(N("number"), class) && ObjIsNumber(obj)) return(1);
+  if (ISA(N_number, class) && ObjIsNumber(obj)) return(1);
   if (ObjIsNumber(class) && ObjIsNumber(obj)) {
     return(ObjToNumber(class) == ObjToNumber(obj));
   }
-  if (class == N("list")) return(ObjIsList(obj));
-  if (class == N("string")) return(ObjIsString(obj));
-  if (class == N("time-range") && ObjIsTsRange(obj)) return(1);
-  if (class == N("concept")) return(1);
+  if (class == N_list) return(ObjIsList(obj));
+  if (class == N_string) return(ObjIsString(obj));
+  if (class == N_time_range && ObjIsTsRange(obj)) return(1);
+  if (class == N_concept) return(1);
   if (ObjIsList(obj)) {
     if ((props = ObjIntensionParse(obj, 1, &noun))) {
     /* todo: Perhaps use props? For instance if props = [isa X C] */
       ObjListFree(props);
       return(ISAP(class, noun));
-    } else if (N("and") == I(obj, 0)) {
+    } else if (N_and == I(obj, 0)) {
       for (i = 0, len = ObjLen(obj); i < len; i++) {
         if (ISAP(class, I(obj, i))) {
           return(1);
@@ -1149,7 +1409,7 @@ Bool ISAP(Obj *class, Obj *obj)
       return(0); 
     } else {
     /* Recurse on proposition, so that
-     * 1 == ISAP(N("action"), L(N("ptrans"), E))
+     * 1 == ISAP(N_action, L(N("ptrans"), E))
      */
       return(ISAP(class, I(obj, 0)));
     }
@@ -1231,22 +1491,177 @@ ObjList *ObjCommonAncestors(Obj *obj1, Obj *obj2)
                                                  NULL)));
 }
 
-ObjList *ObjDescendants1(Obj *obj, int type, int depth, int maxdepth,
-                         ObjList *r)
+/* Traversals
+ *
+ * Every nonlist object has a dense id, so that a traversal can mark the
+ * objects it has visited in an ObjMarks: an array, indexed by id, of the
+ * epoch of the last traversal to visit each object. Starting a traversal
+ * only advances the epoch. ObjMarks are pooled so that traversals may nest
+ * and server threads may run them at the same time.
+ */
+
+ObjMarks *ObjMarksPool;
+
+/* Reserves <n> epochs, so that a traversal may label each object it visits
+ * with a number from 0 to <n>-1. cf ObjMarksSet.
+ */
+ObjMarks *ObjMarksBegin1(int n)
+{
+  ObjMarks	*om;
+  ThreadLock();
+  if ((om = ObjMarksPool)) ObjMarksPool = om->next;
+  ThreadUnlock();
+  if (om == NULL) {
+    om = CREAT(ObjMarks, 1);
+    om->len = 1024;
+    om->epochs = (int *)MemAlloc1(om->len*sizeof(int), "int ObjMarks", 1);
+    memset(om->epochs, 0, om->len*sizeof(int));
+    om->epoch = 0;
+  }
+  if (om->epoch > INTPOSINF - n) {
+    memset(om->epochs, 0, om->len*sizeof(int));
+    om->epoch = 0;
+  }
+  om->base = om->epoch + 1;
+  om->epoch += n;
+  return(om);
+}
+
+ObjMarks *ObjMarksBegin()
+{
+  return(ObjMarksBegin1(1));
+}
+
+void ObjMarksEnd(ObjMarks *om)
+{
+  ThreadLock();
+  om->next = ObjMarksPool;
+  ObjMarksPool = om;
+  ThreadUnlock();
+}
+
+int *ObjMarksSlot(ObjMarks *om, Obj *obj)
+{
+  int	id, len;
+  id = obj->u1.nlst.id;
+  if (id >= om->len) {
+    len = IntMax(2*om->len, ATOMICLOAD(&ObjNextId));
+    om->epochs = (int *)MemRealloc(om->epochs, len*sizeof(int),
+                                   "int ObjMarks");
+    memset(om->epochs + om->len, 0, (len - om->len)*sizeof(int));
+    om->len = len;
+  }
+  return(om->epochs + id);
+}
+
+/* Marks <obj> as visited. Returns 1 if it already was. */
+Bool ObjMarksSeen(ObjMarks *om, Obj *obj)
+{
+  int	*slot;
+  if (obj->type == OBJTYPELIST) return(0);
+  slot = ObjMarksSlot(om, obj);
+  if (*slot == om->epoch) return(1);
+  *slot = om->epoch;
+  return(0);
+}
+
+void ObjMarksSet(ObjMarks *om, Obj *obj, int label)
+{
+  if (obj->type == OBJTYPELIST) return;
+  *ObjMarksSlot(om, obj) = om->base + label;
+}
+
+/* Returns the label of <obj>, or -1 if it has not been visited. */
+int ObjMarksGet(ObjMarks *om, Obj *obj)
+{
+  int	*slot;
+  if (obj->type == OBJTYPELIST) return(-1);
+  slot = ObjMarksSlot(om, obj);
+  if (*slot < om->base) return(-1);
+  return(*slot - om->base);
+}
+
+/* Calls <fn>(obj1, <arg>) once for each descendant obj1 of <obj> of <type>,
+ * within <maxdepth> links, in depth-first order. An object already visited
+ * is only entered again when <maxdepth> is finite.
+ */
+void ObjDescendantsForeach1(ObjMarks *om, Obj *obj, int type, int depth,
+                            int maxdepth, void (*fn)(), void *arg)
 {
   int	i;
   Obj	*obj1;
-  if (obj->type == OBJTYPELIST) return(r);
-  if (depth >= maxdepth) return(r);
+  if (obj->type == OBJTYPELIST) return;
+  if (depth >= maxdepth) return;
   for (i = 0; i < obj->u1.nlst.numchildren; i++) {
     obj1 = obj->u1.nlst.children[i];
-    if (type == OBJTYPEANY || obj1->type == type) {
-      if (!ObjListIn(obj1, r)) {
-        r = ObjListCreate(obj1, r);
-      }
+    if (ObjMarksSeen(om, obj1)) {
+      if (maxdepth == INTPOSINF) continue;
+    } else if (type == OBJTYPEANY || obj1->type == type) {
+      (*fn)(obj1, arg);
     }
-    r = ObjDescendants1(obj1, type, depth+1, maxdepth, r);
+    ObjDescendantsForeach1(om, obj1, type, depth+1, maxdepth, fn, arg);
   }
+}
+
+void ObjDescendantsForeach(Obj *obj, int type, int maxdepth, void (*fn)(),
+                           void *arg)
+{
+  ObjMarks	*om;
+  om = ObjMarksBegin();
+  ObjMarksSeen(om, obj);
+  ObjDescendantsForeach1(om, obj, type, 0, maxdepth, fn, arg);
+  ObjMarksEnd(om);
+}
+
+/* Ancestors named :xxx are neither reported nor gone through. */
+void ObjAncestorsForeach1(ObjMarks *om, Obj *obj, int type, int depth,
+                          int maxdepth, void (*fn)(), void *arg)
+{
+  int	i;
+  Obj	*obj1;
+  if (obj->type == OBJTYPELIST) return;
+  if (depth >= maxdepth) return;
+  for (i = 0; i < obj->u1.nlst.numparents; i++) {
+    obj1 = obj->u1.nlst.parents[i];
+    if (obj1->u1.nlst.name[0] == ':') continue;
+    if (ObjMarksSeen(om, obj1)) {
+      if (maxdepth == INTPOSINF) continue;
+    } else if (type == OBJTYPEANY || obj1->type == type) {
+      (*fn)(obj1, arg);
+    }
+    ObjAncestorsForeach1(om, obj1, type, depth+1, maxdepth, fn, arg);
+  }
+}
+
+void ObjAncestorsForeach(Obj *obj, int type, int maxdepth, void (*fn)(),
+                         void *arg)
+{
+  ObjMarks	*om;
+  om = ObjMarksBegin();
+  ObjMarksSeen(om, obj);
+  ObjAncestorsForeach1(om, obj, type, 0, maxdepth, fn, arg);
+  ObjMarksEnd(om);
+}
+
+void ObjListPrepend(Obj *obj, ObjList **r)
+{
+  *r = ObjListCreate(obj, *r);
+}
+
+void ObjCount(Obj *obj, long *r)
+{
+  (*r)++;
+}
+
+/* Prepends to <r> the descendants of <obj> not yet visited. */
+ObjList *ObjDescendants1(Obj *obj, int type, int depth, int maxdepth,
+                         ObjList *r)
+{
+  ObjMarks	*om;
+  om = ObjMarksBegin();
+  ObjMarksSeen(om, obj);
+  ObjDescendantsForeach1(om, obj, type, depth, maxdepth, ObjListPrepend, &r);
+  ObjMarksEnd(om);
   return(r);
 }
 
@@ -1262,16 +1677,11 @@ ObjList *ObjChildren(Obj *obj, int type)
 
 ObjList *ObjAncestors1(Obj *obj, int type, int depth, int maxdepth, ObjList *r)
 {
-  int	i;
-  Obj	*obj1;
-  if (obj->type == OBJTYPELIST) return(r);
-  if (depth >= maxdepth) return(r);
-  for (i = 0; i < obj->u1.nlst.numparents; i++) {
-    obj1 = obj->u1.nlst.parents[i];
-    if (obj1->u1.nlst.name[0] == ':') continue;
-    if (type == OBJTYPEANY || obj1->type == type) r = ObjListCreate(obj1, r);
-    r = ObjAncestors1(obj1, type, depth+1, maxdepth, r);
-  }
+  ObjMarks	*om;
+  om = ObjMarksBegin();
+  ObjMarksSeen(om, obj);
+  ObjAncestorsForeach1(om, obj, type, depth, maxdepth, ObjListPrepend, &r);
+  ObjMarksEnd(om);
   return(r);
 }
 
@@ -1309,18 +1719,12 @@ ObjList *ObjParents(Obj *obj, int type)
   return(ObjAncestors1(obj, type, 0, 1, NULL));
 }
 
+/* Counts each descendant once, however many paths lead to it. */
 long ObjNumDescendants(Obj *obj, int type)
 {
-  int	i;
   long	r;
-  Obj	*obj1;
-  if (obj->type == OBJTYPELIST) return(0L);
   r = 0L;
-  for (i = 0; i < obj->u1.nlst.numchildren; i++) {
-    obj1 = obj->u1.nlst.children[i];
-    if (type == OBJTYPEANY || obj1->type == type) r++;
-    r += ObjNumDescendants(obj1, type);
-  }
+  ObjDescendantsForeach(obj, type, INTPOSINF, ObjCount, &r);
   return(r);
 }
 
@@ -1330,11 +1734,13 @@ long ObjNumDescendants(Obj *obj, int type)
 ObjList *ObjCutClasses(ObjList *objs)
 {
   ObjList	*ancest, *p1, *p2, *r;
+  ObjMarks	*om;
   r = NULL;
+  om = ObjMarksBegin();
   for (p1 = objs; p1; p1 = p1->next) {
     ancest = ObjAncestors(p1->obj, OBJTYPEANY);
     for (p2 = ancest; p2; p2 = p2->next) {
-      if (ObjListIn(p2->obj, r)) continue;
+      if (ObjMarksSeen(om, p2->obj)) continue;
       if (ObjIsContrast(p2->obj)) continue;
       if (!ObjList_AndISA(p2->obj, objs)) {
         r = ObjListCreate(p2->obj, r);
@@ -1342,6 +1748,7 @@ ObjList *ObjCutClasses(ObjList *objs)
     }
     ObjListFree(ancest);
   }
+  ObjMarksEnd(om);
   return(ObjListRemoveLessGeneralISA(r));
 }
 
@@ -1460,112 +1867,259 @@ Float ObjSimilarity(Obj *obj1, Obj *obj2)
   return(r);
 }
 
-ObjList *ObjShortestPath(Obj *from, Obj *to, int depth, int maxdepth,
-                         /* RESULT */ ObjList **visited)
-{
-  ObjList *parents, *children, *p, *path, *minpath;
-  if (ObjBarrierISA(from)) return NULL;
-  if (depth >= maxdepth) return NULL;
-  if (ObjListIn(from, *visited)) return NULL;
+/* Shortest paths
+ *
+ * ObjShortestPath1 is a breadth-first search over parent and child links
+ * from both ends at once, a level at a time from whichever end has the
+ * smaller frontier. Each end labels the objects it reaches with their
+ * distance from it, so the search stops at the first level that reaches an
+ * object labeled by the other end. Barrier objects are not entered.
+ *
+ * Similarity scoring asks for the same pairs over and over, so
+ * ObjShortestPathLen keeps recent lengths in an LRU cache, which is emptied
+ * whenever an ISA link is added.
+ */
 
-  if (from == to) return ObjListCreate(from, NULL);
-  *visited = ObjListCreate(from, *visited);
+#define OBJPATHMAXLEN	5	/* nodes */
+#define PATHCACHESIZE	4096
+#define PATHCACHEHASH	8192	/* power of 2 */
 
-  minpath = NULL;
+ObjPathEntry	PathCache[PATHCACHESIZE+1];
+int		PathCacheHash[PATHCACHEHASH];
+int		PathCacheUsed, PathCacheFirst, PathCacheLast, PathCacheEpoch;
 
-  parents = ObjParents(from, OBJTYPEANY);
-  for (p = parents; p; p = p->next) {
-    if (NULL != (path = ObjShortestPath(p->obj, to, depth+1, maxdepth,
-                                        visited))) {
-      if (minpath == NULL || ObjListLen(path) < ObjListLen(minpath)) {
-        minpath = path;
-      }
+/* Returns the <i>th neighbor of <obj>, or NULL if the link may not be
+ * followed. Going <forward>, parents named :xxx are skipped (cf
+ * ObjAncestorsForeach1); going backward, the same links are followed the
+ * other way.
+ */
+Obj *ObjPathNeighbor(Obj *obj, Bool forward, int i)
+{
+  Obj	*obj1;
+  if (i < obj->u1.nlst.numparents) {
+    obj1 = obj->u1.nlst.parents[i];
+    if (forward && obj1->u1.nlst.name[0] == ':') return(NULL);
+    return(obj1);
+  }
+  if ((!forward) && obj->u1.nlst.name[0] == ':') return(NULL);
+  return(obj->u1.nlst.children[i - obj->u1.nlst.numparents]);
+}
+
+/* Returns a neighbor of <obj> labeled <label> in <om>. */
+Obj *ObjPathStep(ObjMarks *om, Obj *obj, Bool forward, int label)
+{
+  int	i, n;
+  Obj	*obj1;
+  n = obj->u1.nlst.numparents + obj->u1.nlst.numchildren;
+  for (i = 0; i < n; i++) {
+    if ((obj1 = ObjPathNeighbor(obj, forward, i)) &&
+        ObjMarksGet(om, obj1) == label) {
+      return(obj1);
     }
   }
-  ObjListFree(parents);
+  return(NULL);
+}
 
-  children = ObjChildren(from, OBJTYPEANY);
-  for (p = children; p; p = p->next) {
-    if (NULL != (path = ObjShortestPath(p->obj, to, depth+1, maxdepth,
-                                        visited))) {
-      if (minpath == NULL || ObjListLen(path) < ObjListLen(minpath)) {
-        minpath = path;
+/* Returns the number of nodes in a shortest path from <from> to <to> of at
+ * most <maxlen> nodes, or -1 if there is none. The path itself is returned
+ * in <path> if not NULL.
+ */
+int ObjShortestPath1(Obj *from, Obj *to, int maxlen,
+                     /* RESULTS */ ObjList **path)
+{
+  int		side, i, j, n, k, best, nextlen, maxnext;
+  int		depth[2], len[2], maxfront[2];
+  Obj		*obj, *obj1, *meet, **next, **t, **front[2];
+  ObjMarks	*om[2];
+  ObjList	*r, *r1;
+  if (path) *path = NULL;
+  if (from == to) {
+    if (path) *path = ObjListCreate(from, NULL);
+    return(1);
+  }
+  if (from->type == OBJTYPELIST || to->type == OBJTYPELIST) return(-1);
+  if (ObjBarrierISA(from) || ObjBarrierISA(to)) return(-1);
+
+  /* Labels 0 to maxlen-1 are distances; maxlen marks a barrier. */
+  for (side = 0; side < 2; side++) {
+    om[side] = ObjMarksBegin1(maxlen+1);
+    depth[side] = 0;
+    len[side] = 1;
+    maxfront[side] = 16;
+    front[side] = (Obj **)MemAlloc(maxfront[side]*sizeof(Obj *),
+                                   "Obj* frontier");
+  }
+  front[0][0] = from;
+  front[1][0] = to;
+  ObjMarksSet(om[0], from, 0);
+  ObjMarksSet(om[1], to, 0);
+  maxnext = 16;
+  next = (Obj **)MemAlloc(maxnext*sizeof(Obj *), "Obj* frontier");
+
+  best = -1;
+  meet = NULL;
+  while (best == -1 && len[0] > 0 && len[1] > 0 &&
+         depth[0] + depth[1] + 1 < maxlen) {
+    side = (len[1] < len[0]);
+    nextlen = 0;
+    for (i = 0; i < len[side]; i++) {
+      obj = front[side][i];
+      n = obj->u1.nlst.numparents + obj->u1.nlst.numchildren;
+      for (j = 0; j < n; j++) {
+        if (!(obj1 = ObjPathNeighbor(obj, side == 0, j))) continue;
+        if (ObjMarksGet(om[side], obj1) != -1) continue;
+        if (ObjBarrierISA(obj1)) {
+          ObjMarksSet(om[side], obj1, maxlen);
+          continue;
+        }
+        ObjMarksSet(om[side], obj1, depth[side]+1);
+        k = ObjMarksGet(om[1-side], obj1);
+        if (k != -1 && k < maxlen &&
+            (best == -1 || depth[side]+1+k < best)) {
+          best = depth[side]+1+k;
+          meet = obj1;
+        }
+        if (nextlen >= maxnext) {
+          maxnext = 2*maxnext;
+          next = (Obj **)MemRealloc(next, maxnext*sizeof(Obj *),
+                                    "Obj* frontier");
+        }
+        next[nextlen++] = obj1;
       }
     }
+    depth[side]++;
+    t = front[side];
+    front[side] = next;
+    next = t;
+    len[side] = nextlen;
+    k = maxfront[side];
+    maxfront[side] = maxnext;
+    maxnext = k;
+  }
+
+  if (best != -1 && path) {
+    /* From <meet> forward to <to>, then from <meet> back to <from>. */
+    r = NULL;
+    obj = meet;
+    for (k = ObjMarksGet(om[1], meet); k > 0; k--) {
+      obj = ObjPathStep(om[1], obj, 1, k-1);
+      r = ObjListCreate(obj, r);
+    }
+    r1 = ObjListReverse(r);
+    ObjListFree(r);
+    r = ObjListCreate(meet, r1);
+    obj = meet;
+    for (k = ObjMarksGet(om[0], meet); k > 0; k--) {
+      obj = ObjPathStep(om[0], obj, 0, k-1);
+      r = ObjListCreate(obj, r);
+    }
+    *path = r;
   }
-  ObjListFree(children);
 
-  if (minpath == NULL) return NULL;
-  return ObjListCreate(from, minpath);
+  for (side = 0; side < 2; side++) {
+    ObjMarksEnd(om[side]);
+    MemFree(front[side], "Obj* frontier");
+  }
+  MemFree(next, "Obj* frontier");
+  if (best == -1) return(-1);
+  return(best+1);
 }
 
-int ObjShortestPathLen1(Obj *from, Obj *to, int depth, int maxdepth,
-                        /* RESULT */ ObjList **visited)
+ObjList *ObjShortestPath(Obj *from, Obj *to, int maxlen)
 {
-  int t, min;
-  ObjList *parents, *children, *p;
-  if (ObjBarrierISA(from)) return -1;
-  if (depth >= maxdepth) return -1;
-  if (ObjListIn(from, *visited)) return -1;
-  if (ObjListLen(*visited) > 100) return -1;
+  ObjList	*path;
+  ObjShortestPath1(from, to, maxlen, &path);
+  return(path);
+}
 
-  if (from == to) return 1;
-  *visited = ObjListCreate(from, *visited);
+void ObjPathCacheClear()
+{
+  memset(PathCacheHash, 0, sizeof(PathCacheHash));
+  PathCacheUsed = PathCacheFirst = PathCacheLast = 0;
+  PathCacheEpoch = IsaLinkEpoch;
+}
 
-  min = -1;
+int ObjPathCacheHashOf(Obj *from, Obj *to)
+{
+  return((int)(((((unsigned long)from) >> 4) * 31 +
+                (((unsigned long)to) >> 4)) & (PATHCACHEHASH-1)));
+}
 
-  parents = ObjParents(from, OBJTYPEANY);
-  for (p = parents; p; p = p->next) {
-    if (-1 != (t = ObjShortestPathLen1(p->obj, to, depth+1, maxdepth,
-                                       visited))) {
-      if (min == -1 || t < min) {
-        min = t;
-      }
-    }
-  }
-  ObjListFree(parents);
+void ObjPathCacheUnlink(int e)
+{
+  if (PathCache[e].prev) PathCache[PathCache[e].prev].next = PathCache[e].next;
+  else PathCacheFirst = PathCache[e].next;
+  if (PathCache[e].next) PathCache[PathCache[e].next].prev = PathCache[e].prev;
+  else PathCacheLast = PathCache[e].prev;
+}
 
-  children = ObjChildren(from, OBJTYPEANY);
-  for (p = children; p; p = p->next) {
-    if (-1 != (t = ObjShortestPathLen1(p->obj, to, depth+1, maxdepth,
-                                       visited))) {
-      if (min == -1 || t < min) {
-        min = t;
-      }
+void ObjPathCacheLinkFirst(int e)
+{
+  PathCache[e].prev = 0;
+  PathCache[e].next = PathCacheFirst;
+  if (PathCacheFirst) PathCache[PathCacheFirst].prev = e;
+  else PathCacheLast = e;
+  PathCacheFirst = e;
+}
+
+/* Returns 1 and sets <len> if the length from <from> to <to> is cached. */
+Bool ObjPathCacheGet(Obj *from, Obj *to, /* RESULTS */ int *len)
+{
+  int	e;
+  Bool	r;
+  r = 0;
+  ThreadLock();
+  if (PathCacheEpoch != IsaLinkEpoch) ObjPathCacheClear();
+  for (e = PathCacheHash[ObjPathCacheHashOf(from, to)]; e;
+       e = PathCache[e].hnext) {
+    if (PathCache[e].from == from && PathCache[e].to == to) {
+      ObjPathCacheUnlink(e);
+      ObjPathCacheLinkFirst(e);
+      *len = PathCache[e].len;
+      r = 1;
+      break;
     }
   }
-  ObjListFree(children);
+  ThreadUnlock();
+  return(r);
+}
 
-  if (min == -1) return min;
-  return min + 1;
+/* Evicts the least recently used entry when full. */
+void ObjPathCachePut(Obj *from, Obj *to, int len)
+{
+  int	e, *p;
+  ThreadLock();
+  if (PathCacheEpoch != IsaLinkEpoch) ObjPathCacheClear();
+  if (PathCacheUsed < PATHCACHESIZE) {
+    e = ++PathCacheUsed;
+  } else {
+    e = PathCacheLast;
+    ObjPathCacheUnlink(e);
+    for (p = &PathCacheHash[ObjPathCacheHashOf(PathCache[e].from,
+                                                PathCache[e].to)];
+         *p != e;
+         p = &PathCache[*p].hnext);
+    *p = PathCache[e].hnext;
+  }
+  PathCache[e].from = from;
+  PathCache[e].to = to;
+  PathCache[e].len = len;
+  p = &PathCacheHash[ObjPathCacheHashOf(from, to)];
+  PathCache[e].hnext = *p;
+  *p = e;
+  ObjPathCacheLinkFirst(e);
+  ThreadUnlock();
 }
 
 /* Returns number of nodes in path. */
 int ObjShortestPathLen(Obj *from, Obj *to)
 {
-  int     maxdepth, r;
-  ObjList *visited;
-/*
-  ObjList *path;
-*/
+  int	r;
   if (from == to) return 1;
-  for (maxdepth = 2; maxdepth <= 5; maxdepth++) {
-/*
-    visited = NULL;
-    path = ObjShortestPath(from, to, 0, maxdepth, &visited);
-    if (path != NULL) {
-      fprintf(Log, "\nPATH:\n");
-      ObjListPrint(Log, path);
-    }
-    ObjListFree(visited);
-*/
-
-    visited = NULL;
-    r = ObjShortestPathLen1(from, to, 0, maxdepth, &visited);
-    ObjListFree(visited);
-    if (r != -1) return r;
-  }
-  return -1;
+  if (ObjPathCacheGet(from, to, &r)) return r;
+  r = ObjShortestPath1(from, to, OBJPATHMAXLEN, NULL);
+  ObjPathCachePut(from, to, r);
+  return r;
 }
 
 /* cf Leacock and Chodorow (1998, p. 275) */
@@ -2805,10 +3359,10 @@ ObjList *ObjIntensionParse(Obj *obj, int article_ok, /* RESULTS */ Obj **noun)
   int		i, len;
   Obj		*prop;
   ObjList	*r;
-  if (I(obj, 0) != N("such-that") || ObjLen(obj) < 3) goto failure;
+  if (I(obj, 0) != N_such_that || ObjLen(obj) < 3) goto failure;
   if (ObjIsList(I(obj, 1))) {
     if (article_ok &&
-        ISA(N("determiner-article"), I(I(obj, 1), 0)) &&
+        ISA(N_determiner_article, I(I(obj, 1), 0)) &&
         I(I(obj, 1), 1)) {
       *noun = I(I(obj, 1), 1);
       r = NULL;
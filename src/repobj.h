@@ -1,7 +1,10 @@
 /* repobj.c */
 void ObjInit(void);
+void ObjHandlesInit(void);
+void ObjHandlesCheck(void);
 Obj *ObjCreateRawNonlist(void);
 Obj *ObjCreateRawList(int force_malloc);
+void ObjLink(Obj *obj);
 void ObjFindUnusedName(Obj *parent, char *prefix, char *name, int *is_le0);
 Obj *ObjCreateInstanceText(Obj *parent, char *text, int existing_ok, int create_flag, int *is_le0, int *existing);
 Obj *ObjCreateInstanceNamed(Obj *parent, char *name, int create_flag);
@@ -75,12 +78,30 @@ Bool ObjReclassify(Obj *obj, Obj *fromparent, Obj *toparent);
 Bool ObjSetIth(Obj *obj, int i, Obj *value);
 Bool ObjSetIthPNode(Obj *obj, int i, PNode *value);
 Bool ISA1(Obj *anc, Obj *des, int depth);
+void ObjAncestorsInvalidate(Obj *obj);
+Bool ObjAncestorsSeen(Obj *obj);
+int ObjAncestorsCompare(const void *p1, const void *p2);
+Bool ObjAncestorsCompute(Obj *obj);
+Bool ObjAncestorsCache(Obj *obj);
 Bool ISA(Obj *anc, Obj *des);
 Bool ISAP(Obj *class, Obj *obj);
 Bool ISADeep(Obj *anc, Obj *obj);
 Bool ObjBarrierISA(Obj *obj);
 ObjList *ObjCommonAncestors1(Obj *obj1, Obj *obj2, int depth, int maxdepth, ObjList *r);
 ObjList *ObjCommonAncestors(Obj *obj1, Obj *obj2);
+ObjMarks *ObjMarksBegin1(int n);
+ObjMarks *ObjMarksBegin(void);
+void ObjMarksEnd(ObjMarks *om);
+int *ObjMarksSlot(ObjMarks *om, Obj *obj);
+Bool ObjMarksSeen(ObjMarks *om, Obj *obj);
+void ObjMarksSet(ObjMarks *om, Obj *obj, int label);
+int ObjMarksGet(ObjMarks *om, Obj *obj);
+void ObjDescendantsForeach1(ObjMarks *om, Obj *obj, int type, int depth, int maxdepth, void (*fn)(), void *arg);
+void ObjDescendantsForeach(Obj *obj, int type, int maxdepth, void (*fn)(), void *arg);
+void ObjAncestorsForeach1(ObjMarks *om, Obj *obj, int type, int depth, int maxdepth, void (*fn)(), void *arg);
+void ObjAncestorsForeach(Obj *obj, int type, int maxdepth, void (*fn)(), void *arg);
+void ObjListPrepend(Obj *obj, ObjList **r);
+void ObjCount(Obj *obj, long *r);
 ObjList *ObjDescendants1(Obj *obj, int type, int depth, int maxdepth, ObjList *r);
 ObjList *ObjDescendants(Obj *obj, int type);
 ObjList *ObjChildren(Obj *obj, int type);
@@ -99,6 +120,17 @@ Bool ObjAnalogize1(Obj *src, Obj *tgt, /* OUTPUT */ ObjList **mapp);
 Bool ObjIsSpecifPart(Obj *spec, Obj *gen);
 Bool ObjIsSpecif(Obj *obj1, Obj *obj2);
 Float ObjSimilarity(Obj *obj1, Obj *obj2);
+Obj *ObjPathNeighbor(Obj *obj, Bool forward, int i);
+Obj *ObjPathStep(ObjMarks *om, Obj *obj, Bool forward, int label);
+int ObjShortestPath1(Obj *from, Obj *to, int maxlen, ObjList **path);
+ObjList *ObjShortestPath(Obj *from, Obj *to, int maxlen);
+void ObjPathCacheClear(void);
+int ObjPathCacheHashOf(Obj *from, Obj *to);
+void ObjPathCacheUnlink(int e);
+void ObjPathCacheLinkFirst(int e);
+Bool ObjPathCacheGet(Obj *from, Obj *to, int *len);
+void ObjPathCachePut(Obj *from, Obj *to, int len);
+int ObjShortestPathLen(Obj *from, Obj *to);
 Float ObjPathLengthSimilarity(Obj *obj1, Obj *obj2);
 int ObjFindInList(Obj *obj, Obj *objlist);
 Bool ObjIn(Obj *obj1, Obj *obj2);
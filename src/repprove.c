@@ -5,11 +5,13 @@
  *
  * 19940821: begun
  * 19940822: debugging
+ * 20261017T220000: rule index and answer table
  */
 
 #include "tt.h"
 #include "repbasic.h"
 #include "repdb.h"
+#include "repinfer.h"
 #include "repobj.h"
 #include "repobjl.h"
 #include "repprove.h"
@@ -366,6 +368,92 @@ Bool ProveComparative(Ts *ts, TsRange *tsr, Obj *goal, ObjList *rules,
   }
 }
 
+/* Rule index
+ *
+ * ProveFact need only unify a goal with the rules whose consequent could
+ * match it. ProveRuleIndex maps the goal's predicate, and its first
+ * argument if that is bound, to those rules, in ProofRules order. A rule
+ * is left out only if some element of its consequent is neither a
+ * variable nor an ancestor of the corresponding goal element, in which
+ * case ObjUnify2 would fail. Entries are built on first use, and the
+ * index is cleared when ProofRules changes or any ISA link is added
+ * (IsaLinkEpoch): a leaf gaining a parent leaves IsaEpoch alone.
+ */
+
+DbIndex	*ProveRuleIndex;
+int	ProveRuleIndexEpoch;
+
+Bool ProveRuleKeyable(Obj *obj)
+{
+  return(obj != NULL && ObjIsSymbol(obj) && !ObjIsVar(obj));
+}
+
+Bool ProveRuleMayMatch(Obj *consequent, Obj *pred, Obj *arg)
+{
+  Obj	*elem;
+  if (ObjLen(consequent) > 0) {
+    elem = I(consequent, 0);
+    if (!(ObjIsVar(elem) || ISA(elem, pred))) return(0);
+  }
+  if (arg && ObjLen(consequent) > 1) {
+    elem = I(consequent, 1);
+    if (!(ObjIsVar(elem) || ISA(elem, arg))) return(0);
+  }
+  return(1);
+}
+
+/* Returns the rules of <rules> which might prove <goal>. */
+ObjList *ProveRuleCandidates(Obj *goal, ObjList *rules)
+{
+  Obj		*pred, *arg;
+  ObjList	*p, *r;
+  DbIndexEntry	*de;
+  if (rules != ProofRules || Starting) return(rules);
+  pred = I(goal, 0);
+  if (!ProveRuleKeyable(pred)) return(rules);
+  arg = I(goal, 1);
+  if (!ProveRuleKeyable(arg)) arg = NULL;
+  ThreadLock();
+  MemScratchSuspend();
+  if (ProveRuleIndex == NULL) {
+    ProveRuleIndex = DbIndexCreate(64L, "ProveRuleIndex");
+    ProveRuleIndexEpoch = IsaLinkEpoch;
+  } else if (ProveRuleIndexEpoch != IsaLinkEpoch) {
+    DbIndexClear(ProveRuleIndex);
+    ProveRuleIndexEpoch = IsaLinkEpoch;
+  }
+  de = DbIndexSlot(ProveRuleIndex, DbIndexKey(pred), DbIndexKey(arg));
+  if (de->objs == NULL) {
+    r = NULL;
+    for (p = rules; p; p = p->next) {
+      if (ProveRuleMayMatch(I(p->obj, 2), pred, arg)) {
+        r = ObjListCreate(p->obj, r);
+      }
+    }
+    /* The entry starts with <pred> so that it is nonempty. */
+    de->objs = ObjListCreate(pred, ObjListReverseDest(r));
+    de->a = DbIndexKey(pred);
+    de->b = DbIndexKey(arg);
+    ProveRuleIndex->count++;
+    r = de->objs->next;
+    if (ProveRuleIndex->count > (size_t)(HASHMAXLOAD*ProveRuleIndex->size)) {
+      DbIndexGrow(ProveRuleIndex);
+    }
+  } else {
+    r = de->objs->next;
+  }
+  MemScratchResume();
+  ThreadUnlock();
+  return(r);
+}
+
+void ProveRuleIndexClear()
+{
+  ThreadLock();
+  if (ProveRuleIndex) DbIndexClear(ProveRuleIndex);
+  ThreadUnlock();
+}
+
 /* todo: Add symmetric relations, opposites. Cycle prevention.
  * todo: Not sure of BdCopy correctness.
  * todoFREE: Lots of freeing to do.
@@ -446,7 +534,7 @@ Bool ProveFact(Ts *ts, TsRange *tsr, Obj *goal, ObjList *rules, ObjList *more,
   }
 
   /* Backward chain on rules. */
-  for (p = rules; p; p = p->next) {
+  for (p = ProveRuleCandidates(goal, rules); p; p = p->next) {
     if ((new_bd = ObjUnify2(I(p->obj, 2), goal, BdCreate()))) {
       obj = ObjInstan(I(p->obj, 1), new_bd);	/* todoFREE: obj */
       score = ObjScoreGet(p->obj);
@@ -465,13 +553,173 @@ Bool ProveFact(Ts *ts, TsRange *tsr, Obj *goal, ObjList *rules, ObjList *more,
   return(0);
 }
 
+Bool Prove2(Ts *ts, TsRange *tsr, Obj *goal, ObjList *rules, ObjList *more,
+            Bool querydb, int depth, /* RESULTS */ Proof **out_pr)
+{
+  Obj	*head;
+  head = I(goal, 0);
+  if (N("isa") == head || N("ako") == head) {
+    return ProveISA(ts, tsr, goal, rules, more, querydb, depth, out_pr);
+  } else if (N("and") == head) {
+    return ProveAnd(ts, tsr, goal, rules, more, querydb, depth, out_pr);
+  } else if (N("or") == head) {
+    return ProveOr(ts, tsr, goal, rules, more, querydb, depth, out_pr);
+  } else if (N("not") == head) {
+    return ProveNot(ts, tsr, goal, rules, more, querydb, depth, out_pr);
+  } else if (ISA(N("arithmetic-relation"), head)) {
+    return ProveComparative(ts, tsr, goal, rules, more, querydb, depth,
+                            out_pr);
+  } else {
+    return ProveFact(ts, tsr, goal, rules, more, querydb, depth, out_pr);
+  }
+}
+
+/* Answer table
+ *
+ * Within one top-level Prove, ts, tsr, rules, more, and querydb are fixed,
+ * so the proofs of a subgoal depend only on the subgoal. Prove1 records
+ * them in ProveTableCur, keyed on the goal (cf ObjSimilarList), and reuses
+ * them whenever the same subgoal comes up again, successful or not.
+ *
+ * A subgoal that comes up again while it is still being proved is cut
+ * off: the recursion could only rederive the answers the subgoal has
+ * without it. But the subgoals proved in between then lack any answers
+ * that depend on the one cut off, so they are not reused (cf low), nor
+ * are subgoals whose proofs ran into MAXDEPTH.
+ */
+
+ProveTable	*ProveTableCur;
+
+unsigned long ProveGoalHash(Obj *goal)
+{
+  int		i, len;
+  unsigned long	h;
+  if (!ObjIsList(goal)) return(DbIndexKey(goal));
+  h = len = ObjLen(goal);
+  for (i = 0; i < len; i++) {
+    h = DbIndexHash(h, ProveGoalHash(I(goal, i)));
+  }
+  return(h);
+}
+
+ProveTable *ProveTableCreate()
+{
+  ProveTable	*pt;
+  size_t	i;
+  pt = CREATE(ProveTable);
+  pt->size = 64;
+  pt->count = 0;
+  pt->entries = (ProveEntry **)MemAlloc(pt->size*sizeof(ProveEntry *),
+                                        "ProveEntry *");
+  for (i = 0; i < pt->size; i++) pt->entries[i] = NULL;
+  pt->height = 0;
+  pt->low = INTPOSINF;
+  pt->cutoffs = 0L;
+  return(pt);
+}
+
+void ProveTableFree(ProveTable *pt)
+{
+  size_t	i;
+  ProveEntry	*pe, *n;
+  for (i = 0; i < pt->size; i++) {
+    for (pe = pt->entries[i]; pe; pe = n) {
+      n = pe->next;
+      MemFree(pe, "ProveEntry");
+    }
+  }
+  MemFree(pt->entries, "ProveEntry *");
+  MemFree(pt, "ProveTable");
+}
+
+void ProveTableGrow(ProveTable *pt)
+{
+  size_t	i, oldsize;
+  ProveEntry	**old, *pe, *n;
+  old = pt->entries;
+  oldsize = pt->size;
+  pt->size = oldsize << 1;
+  pt->entries = (ProveEntry **)MemAlloc(pt->size*sizeof(ProveEntry *),
+                                        "ProveEntry *");
+  for (i = 0; i < pt->size; i++) pt->entries[i] = NULL;
+  for (i = 0; i < oldsize; i++) {
+    for (pe = old[i]; pe; pe = n) {
+      n = pe->next;
+      pe->next = pt->entries[pe->hash & (pt->size-1)];
+      pt->entries[pe->hash & (pt->size-1)] = pe;
+    }
+  }
+  MemFree(old, "ProveEntry *");
+}
+
+/* Returns the entry for <goal>, entering it (with state 0) if need be. */
+ProveEntry *ProveTableGet(ProveTable *pt, Obj *goal)
+{
+  unsigned long	hash;
+  ProveEntry	*pe;
+  hash = ProveGoalHash(goal);
+  for (pe = pt->entries[hash & (pt->size-1)]; pe; pe = pe->next) {
+    if (pe->hash == hash && ObjSimilarList(pe->goal, goal)) return(pe);
+  }
+  if (pt->count >= pt->size) ProveTableGrow(pt);
+  pe = CREATE(ProveEntry);
+  pe->goal = goal;
+  pe->hash = hash;
+  pe->state = 0;
+  pe->index = 0;
+  pe->r = 0;
+  pe->proofs = NULL;
+  pe->next = pt->entries[hash & (pt->size-1)];
+  pt->entries[hash & (pt->size-1)] = pe;
+  pt->count++;
+  return(pe);
+}
+
+Bool ProveTabled(ProveTable *pt, Ts *ts, TsRange *tsr, Obj *goal,
+                 ObjList *rules, ObjList *more, Bool querydb, int depth,
+                 /* RESULTS */ Proof **out_pr)
+{
+  int		low;
+  long		cutoffs;
+  Bool		r;
+  Proof		*proofs;
+  ProveEntry	*pe;
+  pe = ProveTableGet(pt, goal);
+  if (pe->state == PROVECOMPLETE) {
+    if (pe->r) *out_pr = pe->proofs;
+    return(pe->r);
+  }
+  if (pe->state == PROVEACTIVE) {
+    if (pe->index < pt->low) pt->low = pe->index;
+    return(0);
+  }
+  pe->state = PROVEACTIVE;
+  pe->index = ++pt->height;
+  low = pt->low;
+  pt->low = INTPOSINF;
+  cutoffs = pt->cutoffs;
+  proofs = NULL;
+  r = Prove2(ts, tsr, goal, rules, more, querydb, depth, &proofs);
+  pt->height--;
+  pe->r = r;
+  pe->proofs = r ? proofs : NULL;
+  if (pt->low >= pe->index && pt->cutoffs == cutoffs) {
+    pe->state = PROVECOMPLETE;
+  } else {
+    pe->state = PROVEINCOMPLETE;
+  }
+  if (low < pt->low) pt->low = low;
+  if (r) *out_pr = proofs;
+  return(r);
+}
+
 Bool Prove1(Ts *ts, TsRange *tsr, Obj *goal, ObjList *rules, ObjList *more,
             Bool querydb, int depth, /* RESULTS */ Proof **out_pr)
 {
   Bool	r;
-  Obj	*head;
   if (depth > MAXDEPTH) {
     Dbg(DBGOBJ, DBGBAD, "Prove1: max depth reached");
+    if (ProveTableCur) ProveTableCur->cutoffs++;
     return 0;
   }
   if (DbgOn(DBGOBJ, DBGHYPER)) {
@@ -480,19 +728,11 @@ Bool Prove1(Ts *ts, TsRange *tsr, Obj *goal, ObjList *rules, ObjList *more,
     ObjPrint(Log, goal);
     fputc(NEWLINE, Log);
   }
-  head = I(goal, 0);
-  if (N("isa") == head || N("ako") == head) {
-    r = ProveISA(ts, tsr, goal, rules, more, querydb, depth, out_pr);
-  } else if (N("and") == head) {
-    r = ProveAnd(ts, tsr, goal, rules, more, querydb, depth, out_pr);
-  } else if (N("or") == head) {
-    r = ProveOr(ts, tsr, goal, rules, more, querydb, depth, out_pr);
-  } else if (N("not") == head) {
-    r = ProveNot(ts, tsr, goal, rules, more, querydb, depth, out_pr);
-  } else if (ISA(N("arithmetic-relation"), head)) {
-    r = ProveComparative(ts, tsr, goal, rules, more, querydb, depth, out_pr);
+  if (ProveTableCur && rules == ProofRules) {
+    r = ProveTabled(ProveTableCur, ts, tsr, goal, rules, more, querydb, depth,
+                    out_pr);
   } else {
-    r = ProveFact(ts, tsr, goal, rules, more, querydb, depth, out_pr);
+    r = Prove2(ts, tsr, goal, rules, more, querydb, depth, out_pr);
   }
   if (DbgOn(DBGOBJ, DBGHYPER)) {
     StreamPrintSpaces(Log, depth);
@@ -509,10 +749,22 @@ Bool Prove1(Ts *ts, TsRange *tsr, Obj *goal, ObjList *rules, ObjList *more,
 
 ObjList *ProofRules;
 
+/* Nested calls get their own answer table. The table is shared state, so
+ * concurrent server threads prove one goal at a time.
+ */
 Bool Prove(Ts *ts, TsRange *tsr, Obj *goal, ObjList *more, Bool querydb,
            /* RESULTS */ Proof **out_pr)
 {
-  if (Prove1(ts, tsr, goal, ProofRules, more, querydb, 0, out_pr)) {
+  Bool		r;
+  ProveTable	*save;
+  ThreadLock();
+  save = ProveTableCur;
+  ProveTableCur = ProveTableCreate();
+  r = Prove1(ts, tsr, goal, ProofRules, more, querydb, 0, out_pr);
+  ProveTableFree(ProveTableCur);
+  ProveTableCur = save;
+  ThreadUnlock();
+  if (r) {
     if (DbgOn(DBGOBJ, DBGHYPER)) {
       fprintf(Log, "found proofs of ");
       ObjPrint(Log, goal);
@@ -585,10 +837,12 @@ Bool InferenceAdd(Obj *obj)
   head = I(obj, 0);
   if (head == N("if")) {
     InferenceRules = ObjListCreate(obj, InferenceRules);
+    InferenceAlphaClear();
   } else if (head == N("if-activate")) {
     ActivationRules = ObjListCreate(obj, ActivationRules);
   } else if (head == N("ifthen")) {
     ProofRules = ObjListCreate(obj, ProofRules);
+    ProveRuleIndexClear();
   } else return(0);
   return(1);
 }
@@ -16,7 +16,18 @@ Proof *ProofAppendEach(Proof *head, Proof *tails, Proof *r);
 Bool ProveAnd(Ts *ts, TsRange *tsr, Obj *goal, ObjList *rules, ObjList *more, Bool querydb, int depth, Proof **out_pr);
 Bool ProveOr(Ts *ts, TsRange *tsr, Obj *goal, ObjList *rules, ObjList *more, Bool querydb, int depth, Proof **out_pr);
 Bool ProveNot(Ts *ts, TsRange *tsr, Obj *goal, ObjList *rules, ObjList *more, Bool querydb, int depth, Proof **out_pr);
+Bool ProveRuleKeyable(Obj *obj);
+Bool ProveRuleMayMatch(Obj *consequent, Obj *pred, Obj *arg);
+ObjList *ProveRuleCandidates(Obj *goal, ObjList *rules);
+void ProveRuleIndexClear(void);
 Bool ProveFact(Ts *ts, TsRange *tsr, Obj *goal, ObjList *rules, ObjList *more, Bool querydb, int depth, Proof **out_pr);
+Bool Prove2(Ts *ts, TsRange *tsr, Obj *goal, ObjList *rules, ObjList *more, Bool querydb, int depth, Proof **out_pr);
+unsigned long ProveGoalHash(Obj *goal);
+ProveTable *ProveTableCreate(void);
+void ProveTableFree(ProveTable *pt);
+void ProveTableGrow(ProveTable *pt);
+ProveEntry *ProveTableGet(ProveTable *pt, Obj *goal);
+Bool ProveTabled(ProveTable *pt, Ts *ts, TsRange *tsr, Obj *goal, ObjList *rules, ObjList *more, Bool querydb, int depth, Proof **out_pr);
 Bool Prove1(Ts *ts, TsRange *tsr, Obj *goal, ObjList *rules, ObjList *more, Bool querydb, int depth, Proof **out_pr);
 Bool Prove(Ts *ts, TsRange *tsr, Obj *goal, ObjList *more, Bool querydb, Proof **out_pr);
 ObjList *ProveRetrieve(Ts *ts, TsRange *tsr, Obj *ptn, Bool freeptn);
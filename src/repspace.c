@@ -5,6 +5,7 @@
  *
  * 19940129: begun
  * 19940525: added Intergrid path search
+ * 20261018T160000: spatial index of at-grid assertions
  */
 
 #include "tt.h"
@@ -481,6 +482,199 @@ Bool SpaceEncloses(Ts *ts, TsRange *tsr, Obj *encloser, Obj *enclosed,
   return(0);
 }
 
+/******************************************************************************
+ * SPATIAL INDEX
+ *
+ * The at-grid assertions of each grid are kept in buckets, one for each
+ * SPACECELL x SPACECELL block of cells, so that a query near a cell need
+ * only look at the blocks within its radius. An assertion is entered, when
+ * made, in every block its subspace's bounding box meets. Whether it holds
+ * at the time and in the context of a query is checked as in DbRetrieval.
+ ******************************************************************************/
+
+/* Returns the block containing row or column <cell>, clipped to the grid. */
+int SpaceCellsBlock(Float cell, int blocks)
+{
+  cell = floor(cell/(Float)SPACECELL);
+  if (cell < 0.0) return(0);
+  if (cell >= (Float)blocks) return(blocks-1);
+  return((int)cell);
+}
+
+/* Sets the bounding box of <se> to that of nonempty <gs>. */
+void SpaceEntryBounds(SpaceEntry *se, GridSubspace *gs)
+{
+  int	i;
+  se->row1 = se->row2 = gs->rows[0];
+  se->col1 = se->col2 = gs->cols[0];
+  for (i = 1; i < gs->len; i++) {
+    if (gs->rows[i] < se->row1) se->row1 = gs->rows[i];
+    if (gs->rows[i] > se->row2) se->row2 = gs->rows[i];
+    if (gs->cols[i] < se->col1) se->col1 = gs->cols[i];
+    if (gs->cols[i] > se->col2) se->col2 = gs->cols[i];
+  }
+}
+
+/* Enters <obj> if it is an at-grid assertion. */
+void SpaceCellsEnter(Obj *obj)
+{
+  int		i, brow, bcol;
+  Grid		*gr;
+  GridSubspace	*gs;
+  SpaceCells	*sc;
+  SpaceEntry	*se, e;
+  if (ObjLen(obj) < 4 || !streq(ObjToName(I(obj, 0)), "at-grid")) return;
+  gs = ObjToGridSubspace(I(obj, 3));
+  if (!(gr = ObjToGrid(I(obj, 2)))) {
+    /* GridRead asserts at-grid before the grid object is typed. */
+    if (!gs || !(gr = gs->grid)) return;
+  }
+  if (!(sc = gr->cells)) {
+    sc = CREAT(SpaceCells, 1);
+    sc->rows = gr->rows/SPACECELL + 1;
+    sc->cols = gr->cols/SPACECELL + 1;
+    sc->blocks = (SpaceEntry **)MemAlloc1(sc->rows*sc->cols*
+                                          sizeof(SpaceEntry *),
+                                          "SpaceEntry* blocks", 1);
+    for (i = 0; i < sc->rows*sc->cols; i++) sc->blocks[i] = NULL;
+    sc->unplaced = NULL;
+    gr->cells = sc;
+  }
+  e.assertion = obj;
+  e.seq = DbAssertionCnt;
+  if (!gs || gs->len == 0) {
+    se = CREAT(SpaceEntry, 1);
+    *se = e;
+    se->next = sc->unplaced;
+    sc->unplaced = se;
+    return;
+  }
+  SpaceEntryBounds(&e, gs);
+  for (brow = SpaceCellsBlock((Float)e.row1, sc->rows);
+       brow <= SpaceCellsBlock((Float)e.row2, sc->rows); brow++) {
+    for (bcol = SpaceCellsBlock((Float)e.col1, sc->cols);
+         bcol <= SpaceCellsBlock((Float)e.col2, sc->cols); bcol++) {
+      se = CREAT(SpaceEntry, 1);
+      *se = e;
+      se->next = sc->blocks[brow*sc->cols + bcol];
+      sc->blocks[brow*sc->cols + bcol] = se;
+    }
+  }
+}
+
+/* Returns the distance from <row> <col> to the nearest cell of the bounding
+ * box of <se>. No cell of the box is nearer by GridDistance1.
+ */
+Float SpaceEntryDistance(SpaceEntry *se, Float rowdist, Float coldist,
+                         GridCoord row, GridCoord col)
+{
+  GridCoord	row2, col2;
+  if (row < se->row1) row2 = se->row1;
+  else if (row > se->row2) row2 = se->row2;
+  else row2 = row;
+  if (col < se->col1) col2 = se->col1;
+  else if (col > se->col2) col2 = se->col2;
+  else col2 = col;
+  return(GridDistance1(rowdist, coldist, row, col, row2, col2));
+}
+
+int SpaceEntryCompare(const void *p1, const void *p2)
+{
+  long	seq1, seq2;
+  seq1 = (*((SpaceEntry **)p1))->seq;
+  seq2 = (*((SpaceEntry **)p2))->seq;
+  if (seq1 < seq2) return(-1);
+  if (seq1 > seq2) return(1);
+  return(0);
+}
+
+/* Returns the at-grid assertions of <grid> holding at <ts> or during <tsr>
+ * whose subspaces may lie within <radius> of <row> <col>, in the order
+ * DbRetrieval would return them. Assertions without a subspace are always
+ * returned.
+ */
+ObjList *SpaceCellsRetrieve(Ts *ts, TsRange *tsr, Obj *grid, GridCoord row,
+                            GridCoord col, Float radius)
+{
+  int		brow, bcol, brow1, brow2, bcol1, bcol2, len, maxlen, i;
+  Float		rowdist, coldist;
+  Grid		*gr;
+  SpaceCells	*sc;
+  SpaceEntry	*se, **found;
+  Context	*cx;
+  ObjList	*r;
+  if (!(gr = ObjToGrid(grid))) return(NULL);
+  if (!(sc = gr->cells)) return(NULL);
+  cx = (tsr ? tsr->cx : ts->cx);
+  GridRowColDist(grid, &rowdist, &coldist);
+  brow1 = SpaceCellsBlock(((Float)row) - radius/rowdist - 1.0, sc->rows);
+  brow2 = SpaceCellsBlock(((Float)row) + radius/rowdist + 1.0, sc->rows);
+  bcol1 = SpaceCellsBlock(((Float)col) - radius/coldist - 1.0, sc->cols);
+  bcol2 = SpaceCellsBlock(((Float)col) + radius/coldist + 1.0, sc->cols);
+  len = 0;
+  maxlen = 64;
+  found = (SpaceEntry **)MemAlloc(maxlen*sizeof(SpaceEntry *), "SpaceEntry*");
+  for (brow = brow1; brow <= brow2; brow++) {
+    for (bcol = bcol1; bcol <= bcol2; bcol++) {
+      for (se = sc->blocks[brow*sc->cols + bcol]; se; se = se->next) {
+        if (SpaceEntryDistance(se, rowdist, coldist, row, col) > radius) {
+          continue;
+        }
+        if (len >= maxlen) {
+          maxlen = 2*maxlen;
+          found = (SpaceEntry **)MemRealloc(found, maxlen*sizeof(SpaceEntry *),
+                                            "SpaceEntry*");
+        }
+        found[len++] = se;
+      }
+    }
+  }
+  for (se = sc->unplaced; se; se = se->next) {
+    if (len >= maxlen) {
+      maxlen = 2*maxlen;
+      found = (SpaceEntry **)MemRealloc(found, maxlen*sizeof(SpaceEntry *),
+                                        "SpaceEntry*");
+    }
+    found[len++] = se;
+  }
+  qsort(found, (size_t)len, sizeof(SpaceEntry *), SpaceEntryCompare);
+  r = NULL;
+  for (i = len-1; i >= 0; i--) {
+    /* An assertion spanning several blocks was found in each. */
+    if (i > 0 && found[i-1]->seq == found[i]->seq) continue;
+    if (DbAssertionHolds(cx, ts, tsr, found[i]->assertion)) {
+      r = ObjListCreate(found[i]->assertion, r);
+    }
+  }
+  MemFree(found, "SpaceEntry*");
+  return(r);
+}
+
+/* Returns a lower bound on the distance from <row1> <col1> at which
+ * SpaceLocateObject, preferring <grid1>, would locate <obj>, or 0.0 if
+ * <obj> is not at-grid in <grid1>. This avoids the grid state
+ * SpaceAtGridGet may need to choose a cell.
+ */
+Float SpaceAtGridBound(Ts *ts, TsRange *tsr, Obj *obj, Obj *grid1,
+                       GridCoord row1, GridCoord col1)
+{
+  Float		rowdist, coldist, r;
+  ObjList	*gas;
+  GridSubspace	*gs;
+  SpaceEntry	e;
+  if (!(gas = REB(ts, tsr, L(N("at-grid"), obj, grid1, ObjWild, E)))) {
+    return(0.0);
+  }
+  r = 0.0;
+  if ((gs = ObjToGridSubspace(I(gas->obj, 3))) && gs->len > 0) {
+    SpaceEntryBounds(&e, gs);
+    GridRowColDist(grid1, &rowdist, &coldist);
+    r = SpaceEntryDistance(&e, rowdist, coldist, row1, col1);
+  }
+  ObjListFree(gas);
+  return(r);
+}
+
 /******************************************************************************
  * LOCATING OBJECTS
  * todo: These routines should be merged into one general routine
@@ -672,6 +866,22 @@ ObjList *SpaceGetAllInGrid(Ts *ts, TsRange *tsr, Obj *grid)
   return(r);
 }
 
+/* Returns the objects at-grid in <grid> that may lie within <radius> of
+ * <row> <col>, in the order of SpaceGetAllInGrid.
+ */
+ObjList *SpaceGetAllInGridNear(Ts *ts, TsRange *tsr, Obj *grid, GridCoord row,
+                               GridCoord col, Float radius)
+{
+  ObjList	*r, *objs, *p;
+  r = NULL;
+  objs = SpaceCellsRetrieve(ts, tsr, grid, row, col, radius);
+  for (p = objs; p; p = p->next) {
+    r = ObjListCreate(I(p->obj, 1), r);
+  }
+  ObjListFree(objs);
+  return(r);
+}
+
 ObjList *SpaceFindWithinRadiusOwned1(Ts *ts, TsRange *tsr, Obj *desired,
                                      Obj *nearx, Float radius, Obj *owner)
 {
@@ -687,10 +897,14 @@ ObjList *SpaceFindWithinRadiusOwned1(Ts *ts, TsRange *tsr, Obj *desired,
   if (desired) {
     objs = SpaceFindAll(ts, tsr, desired);
   } else {
-    objs = SpaceGetAllInGrid(ts, tsr, grid1);
+    objs = SpaceGetAllInGridNear(ts, tsr, grid1, row1, col1, radius);
   }
   for (p = objs; p; p = p->next) {
     if (owner && !REB(ts, tsr, L(N("owner-of"), p->obj, owner, E))) continue;
+    if (desired &&
+        SpaceAtGridBound(ts, tsr, p->obj, grid1, row1, col1) > radius) {
+      continue;
+    }
     dist = SpaceDistance1(ts, tsr, polity1, grid1, row1, col1, p->obj);
     Dbg(DBGSPACE, DBGHYPER, "distance between <%s> <%s> = %g", M(nearx),
         M(p->obj), dist);
@@ -744,6 +958,10 @@ Obj *SpaceFindNearestOwnedInPolity(Ts *ts, TsRange *tsr, Obj *desired,
     if (owner && !IsOwnerOf(ts, tsr, p->obj, owner)) {
       continue;
     }
+    if (nearx && mindist != FLOATPOSINF &&
+        SpaceAtGridBound(ts, tsr, p->obj, grid1, row1, col1) >= mindist) {
+      continue;
+    }
     if (!SpaceLocateObject(ts, tsr, p->obj, grid1, 0, &polity2, &grid2, &row2,
                            &col2)) {
       if (polity) continue;
@@ -801,28 +1019,42 @@ Obj *SpaceFindNearestOwnedIfPossible(Ts *ts, TsRange *tsr, Obj *desired,
   return(SpaceFindNearestOwned(ts, tsr, desired, nearx, NULL));
 }
 
+/* Searches blocks within a radius of <row1> <col1>, doubling the radius
+ * until an object is found within it.
+ */
 Obj *SpaceFindNearestInGrid(Ts *ts, TsRange *tsr, Obj *not_equal, Obj *grid,
                             GridCoord row1, GridCoord col1)
 {
   Obj			*nearest;
-  Float			mindist, dist;
+  Float			mindist, dist, radius, maxradius, rowdist, coldist;
   ObjList		*objs, *p;
+  Grid			*gr;
   GridSubspace	*gs;
-  nearest = NULL;
-  mindist = FLOATPOSINF;
-  objs = RDB(ts, tsr, L(N("at-grid"), ObjWild, grid, ObjWild, E), 1);
-  for (p = objs; p; p = p->next) {
-    if (not_equal == I(p->obj, 1)) continue;
-    if ((gs = ObjToGridSubspace(I(p->obj, 3)))) {
-      dist = GridDistance(grid, row1, col1, gs->rows[0], gs->cols[0]);
-      if (dist < mindist) {
-        nearest = I(p->obj, 1);
-        mindist = dist;
+  if (!(gr = ObjToGrid(grid))) return(NULL);
+  GridRowColDist(grid, &rowdist, &coldist);
+  maxradius = GridDistance1(rowdist, coldist, 0, 0, gr->rows, gr->cols);
+  radius = SPACECELL*FloatMax(rowdist, coldist);
+  while (1) {
+    if (radius >= maxradius) radius = FLOATPOSINF;
+    nearest = NULL;
+    mindist = FLOATPOSINF;
+    objs = SpaceCellsRetrieve(ts, tsr, grid, row1, col1, radius);
+    for (p = objs; p; p = p->next) {
+      if (not_equal == I(p->obj, 1)) continue;
+      if ((gs = ObjToGridSubspace(I(p->obj, 3)))) {
+        dist = GridDistance(grid, row1, col1, gs->rows[0], gs->cols[0]);
+        if (dist < mindist) {
+          nearest = I(p->obj, 1);
+          mindist = dist;
+        }
       }
     }
+    ObjListFree(objs);
+    if ((nearest && mindist <= radius) || radius == FLOATPOSINF) {
+      return(nearest);
+    }
+    radius = 2.0*radius;
   }
-  ObjListFree(objs);
-  return(nearest);
 }
 
 /* <desired> is abstract. <nearx> is concrete.
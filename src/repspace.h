@@ -23,6 +23,13 @@ ObjList *SpaceFindEnclosePolity(Ts *ts, TsRange *tsr, TsRange *ga_tsr, Obj *phys
 ObjList *SpaceFindEnclose1(Ts *ts, TsRange *tsr, TsRange *ga_tsr, Obj *physobj, Obj *encl_grid, GridCoord encl_row, GridCoord encl_col, Obj *enclose_restriction, ObjList *r);
 ObjList *SpaceFindEnclose(Ts *ts, TsRange *tsr, Obj *physobj, Obj *enclose_restriction, ObjList *r);
 Bool SpaceEncloses(Ts *ts, TsRange *tsr, Obj *encloser, Obj *enclosed, TsRange *tsr_r);
+int SpaceCellsBlock(Float cell, int blocks);
+void SpaceEntryBounds(SpaceEntry *se, GridSubspace *gs);
+void SpaceCellsEnter(Obj *obj);
+Float SpaceEntryDistance(SpaceEntry *se, Float rowdist, Float coldist, GridCoord row, GridCoord col);
+int SpaceEntryCompare(const void *p1, const void *p2);
+ObjList *SpaceCellsRetrieve(Ts *ts, TsRange *tsr, Obj *grid, GridCoord row, GridCoord col, Float radius);
+Float SpaceAtGridBound(Ts *ts, TsRange *tsr, Obj *obj, Obj *grid1, GridCoord row1, GridCoord col1);
 ObjList *SpaceLocateObject1(Ts *ts, TsRange *tsr, Obj *obj, Obj *gridprefer, int desc_ok);
 Bool SpaceFindResidence(Ts *ts, TsRange *tsr, Obj *human, Obj **residence, Obj **polityp, Obj **gridp, GridCoord *rowp, GridCoord *colp);
 Bool SpaceLocateHuman(Ts *ts, TsRange *tsr, Obj *human, Obj **residence, Obj **polityp, Obj **gridp, GridCoord *rowp, GridCoord *colp);
@@ -31,6 +38,7 @@ Bool SpaceObjectIsLocated(Ts *ts, TsRange *tsr, Obj *obj);
 Obj *SpaceCountryOfObject(Ts *ts, TsRange *tsr, Obj *obj);
 ObjList *SpaceFindAll(Ts *ts, TsRange *tsr, Obj *desired);
 ObjList *SpaceGetAllInGrid(Ts *ts, TsRange *tsr, Obj *grid);
+ObjList *SpaceGetAllInGridNear(Ts *ts, TsRange *tsr, Obj *grid, GridCoord row, GridCoord col, Float radius);
 ObjList *SpaceFindWithinRadiusOwned1(Ts *ts, TsRange *tsr, Obj *desired, Obj *nearx, Float radius, Obj *owner);
 ObjList *SpaceFindWithinRadiusOwned(Ts *ts, TsRange *tsr, Obj *desired, Obj *nearx, Float radius, Obj *owner);
 Obj *SpaceFindNearestOwnedInPolity(Ts *ts, TsRange *tsr, Obj *desired, Obj *nearx, Obj *owner, Obj *polity);
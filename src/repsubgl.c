@@ -53,6 +53,10 @@ Subgoal *SubgoalCreate(Actor *ac, Obj *actor, Ts *ts, Subgoal *supergoal,
   sg->success_causes = sg->failure_causes = NULL;
   sg->demons = NULL;
   sg->trigger = NULL;
+  sg->demon_mark = 0L;
+  sg->order = PA_QueueOrder();
+  sg->queue_ts = sg->ts;
+  sg->queue_i = QUEUENONE;
 
   sg->hand1 = sg->hand2 = NULL;
   sg->obj1 = NULL;
@@ -107,6 +111,11 @@ Subgoal *SubgoalCopy(Subgoal *sg_parent, Actor *ac_child, Context *cx_parent,
   sg_child->failure_causes = NULL;
   sg_child->demons = NULL;
   sg_child->trigger = NULL;
+  sg_child->demon_mark = 0L;
+  sg_child->order = -sg_parent->order;
+    /* SubgoalCopyAll reverses the order of the subgoals. */
+  sg_child->queue_ts = sg_child->ts;
+  sg_child->queue_i = QUEUENONE;
 
   /* Very temporary. */
   sg_child->hand1 = sg_child->hand2 = NULL;
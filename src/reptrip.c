@@ -10,6 +10,7 @@
  * 19940814: more work
  * 19940815: more work
  * 19940825: some minor redoing to meld with planner
+ * 20261018T230000: next best intergrid route tried if a leg fails
  *
  * todo:
  * - Select best trip.
@@ -320,10 +321,9 @@ Bool TripGridTraverse(int leave_immed, Obj *action, Ts *sched_arrive,
   int		i;
   Dur		dur;
   Float		dist, speed;
-  Ts		ts_cur, depart;
-  IntergridPath	*igp;
-  Obj		*obj_cur, *grid_next, *polity_next, *grid_cur;
-  GridCoord	row_next, col_next, row_cur, col_cur;
+  int		npaths;
+  Ts		ts_cur, ts_legs;
+  IntergridPath	*igps[INTERGRIDPATHS];
   TripLeg	*legs, *leg;
   *out_tr = in_tr;
   Dbg(DBGSPACE, DBGDETAIL, "TripGridTraverse using <%s> from <%s> to <%s>",
@@ -376,65 +376,24 @@ Bool TripGridTraverse(int leave_immed, Obj *action, Ts *sched_arrive,
 
   legs = NULL;
   if (grid1 != grid2) {
-    if (!(igp = IntergridFindPath(leave_after, NULL, grid2, grid1))) {
+    if (0 == (npaths = IntergridFindPaths(leave_after, NULL, grid1, row1,
+                                          col1, grid2, row2, col2,
+                                          INTERGRIDPATHS, igps))) {
       Dbg(DBGSPACE, DBGDETAIL, "no intergrid path found from <%s> to <%s>",
           M(obj1), M(obj2), E);
       return(0);
     }
-    if (igp->grids[0] != grid1) {
-      Dbg(DBGSPACE, DBGBAD, "TripGridTraverse 1");
-      /* todo: More recovery? */
-      return(0);
-    }
-    obj_cur = obj1;
-    row_cur = row1;
-    col_cur = col1;
-    grid_cur = igp->grids[0];
-    for (i = 0; i < igp->len-1; i++) {
-      if (!SpaceLocateObject(&ts_cur, NULL, igp->wormholes[i+1], grid_cur, 0,
-                             &polity_next, &grid_next, &row_next, &col_next)) {
-        return(0);
-      }
-      if (!(leg = TripGridTraverse1((i == 0), action, prop, actor, driver,
-                                    transporter, script, obj_cur,
-                                    igp->wormholes[i+1], grid_cur, row_cur,
-                                    col_cur, row_next, col_next, speed, cost,
-                                    &ts_cur))) {
-        return(0);
-      }
-      if (i == 0 && sched_arrive) leg->depart = *leave_after;
-      ts_cur = leg->arrive;
-      cost = NULL;
-      legs = TripLegAppend(legs, leg);
-      depart = ts_cur;
-      TsIncrement(&ts_cur, DurationOf(N("warp")));
-      leg = TripLegCreate(0, N("warp"), NULL, NULL, NULL, NULL, grid_cur,
-                          igp->grids[i+1], igp->wormholes[i+1], NULL, &depart,
-                          &ts_cur, NULL, NULL, 1);
-      legs = TripLegAppend(legs, leg);
-      if (!SpaceLocateObject(&ts_cur, NULL, igp->wormholes[i+1],
-                             igp->grids[i+1], 0, &polity_next, &grid_next,
-                             &row_next, &col_next)) {
-        return(0);
-      }
-      grid_cur = igp->grids[i+1];
-      obj_cur = igp->wormholes[i+1];
-      row_cur = row_next;
-      col_cur = col_next;
-    }
-    if (!(leg = TripGridTraverse1((i == 0), action, prop, actor, driver,
-                                  transporter, script, obj_cur, obj2, grid_cur,
-                                  row_cur, col_cur, row2, col2, speed, NULL,
-                                  &ts_cur))) {
-      return(0);
-    }
-    if (sched_arrive) {
-      ts_cur = *sched_arrive;
-      leg->arrive = *sched_arrive;
-    } else {
-      ts_cur = leg->arrive;
+    /* Fall back on the next best route if a leg cannot be traversed. */
+    for (i = 0; i < npaths && legs == NULL; i++) {
+      ts_legs = ts_cur;
+      legs = TripIntergridTraverse(igps[i], action, sched_arrive, actor,
+                                   driver, transporter, script, prop, obj1,
+                                   obj2, leave_after, row1, col1, row2, col2,
+                                   speed, cost, &ts_legs);
     }
-    legs = TripLegAppend(legs, leg);
+    for (i = 0; i < npaths; i++) IntergridPathFree(igps[i]);
+    if (legs == NULL) return(0);
+    ts_cur = ts_legs;
   } else {
     if (!(leg = TripGridTraverse1(1, action, prop, actor, driver, transporter,
                                   script, obj1, obj2, grid1, row1, col1, row2,
@@ -465,6 +424,81 @@ Bool TripGridTraverse(int leave_immed, Obj *action, Ts *sched_arrive,
   return(1);
 }
 
+/* Returns the legs of a traversal from <obj1> to <obj2> along <igp>, with
+ * the arrival time in <ts_cur>, or NULL if some leg cannot be traversed.
+ */
+TripLeg *TripIntergridTraverse(IntergridPath *igp, Obj *action,
+                               Ts *sched_arrive, Obj *actor, Obj *driver,
+                               Obj *transporter, Obj *script, Obj *prop,
+                               Obj *obj1, Obj *obj2, Ts *leave_after,
+                               GridCoord row1, GridCoord col1, GridCoord row2,
+                               GridCoord col2, Float speed, Obj *cost,
+                               /* RESULTS */ Ts *ts_cur)
+{
+  int		i;
+  Ts		depart;
+  Obj		*obj_cur, *grid_next, *polity_next, *grid_cur;
+  GridCoord	row_next, col_next, row_cur, col_cur;
+  TripLeg	*legs, *leg;
+  /* <legs> is freed if a later leg fails, as the caller tries another
+   * route.
+   */
+  legs = NULL;
+  obj_cur = obj1;
+  row_cur = row1;
+  col_cur = col1;
+  grid_cur = igp->grids[0];
+  for (i = 0; i < igp->len-1; i++) {
+    if (!SpaceLocateObject(ts_cur, NULL, igp->wormholes[i+1], grid_cur, 0,
+                           &polity_next, &grid_next, &row_next, &col_next)) {
+      TripLegFree(legs);
+      return(NULL);
+    }
+    if (!(leg = TripGridTraverse1((i == 0), action, prop, actor, driver,
+                                  transporter, script, obj_cur,
+                                  igp->wormholes[i+1], grid_cur, row_cur,
+                                  col_cur, row_next, col_next, speed, cost,
+                                  ts_cur))) {
+      TripLegFree(legs);
+      return(NULL);
+    }
+    if (i == 0 && sched_arrive) leg->depart = *leave_after;
+    *ts_cur = leg->arrive;
+    cost = NULL;
+    legs = TripLegAppend(legs, leg);
+    depart = *ts_cur;
+    TsIncrement(ts_cur, DurationOf(N("warp")));
+    leg = TripLegCreate(0, N("warp"), NULL, NULL, NULL, NULL, grid_cur,
+                        igp->grids[i+1], igp->wormholes[i+1], NULL, &depart,
+                        ts_cur, NULL, NULL, 1);
+    legs = TripLegAppend(legs, leg);
+    if (!SpaceLocateObject(ts_cur, NULL, igp->wormholes[i+1],
+                           igp->grids[i+1], 0, &polity_next, &grid_next,
+                           &row_next, &col_next)) {
+      TripLegFree(legs);
+      return(NULL);
+    }
+    grid_cur = igp->grids[i+1];
+    obj_cur = igp->wormholes[i+1];
+    row_cur = row_next;
+    col_cur = col_next;
+  }
+  if (!(leg = TripGridTraverse1((i == 0), action, prop, actor, driver,
+                                transporter, script, obj_cur, obj2, grid_cur,
+                                row_cur, col_cur, row2, col2, speed, NULL,
+                                ts_cur))) {
+    TripLegFree(legs);
+    return(NULL);
+  }
+  if (sched_arrive) {
+    *ts_cur = *sched_arrive;
+    leg->arrive = *sched_arrive;
+  } else {
+    *ts_cur = leg->arrive;
+  }
+  return(TripLegAppend(legs, leg));
+}
+
 TripLeg *TripGridTraverse1(Bool start, Obj *action, Obj *prop, Obj *actor,
                            Obj *driver, Obj *transporter, Obj *script,
                            Obj *obj1, Obj *obj2, Obj *grid, GridCoord row1,
@@ -19,6 +19,7 @@ Bool Trip2(int leave_immed, Obj *actor, Obj *obj1, Obj *obj2, Ts *leave_after, T
 Bool Trip1(int leave_immed, Obj *actor, Obj *obj1, Obj *obj2, Ts *leave_after, Ts *arrive_before, int drive_ok, Trip *in_tr, Trip **out_tr);
 Trip *TripFind(Obj *actor, Obj *obj1, Obj *obj2, Ts *leave_after, Ts *arrive_before);
 Bool TripGridTraverse(int leave_immed, Obj *action, Ts *sched_arrive, Obj *actor, Obj *driver, Obj *transporter, Obj *script, Obj *prop, Obj *obj1, Obj *obj2, Ts *leave_after, Ts *arrive_before, Obj *polity1, Obj *grid1, GridCoord row1, GridCoord col1, Obj *polity2, Obj *grid2, GridCoord row2, GridCoord col2, Obj *cost, Trip *in_tr, Trip **out_tr);
+TripLeg *TripIntergridTraverse(IntergridPath *igp, Obj *action, Ts *sched_arrive, Obj *actor, Obj *driver, Obj *transporter, Obj *script, Obj *prop, Obj *obj1, Obj *obj2, Ts *leave_after, GridCoord row1, GridCoord col1, GridCoord row2, GridCoord col2, Float speed, Obj *cost, Ts *ts_cur);
 TripLeg *TripGridTraverse1(Bool start, Obj *action, Obj *prop, Obj *actor, Obj *driver, Obj *transporter, Obj *script, Obj *obj1, Obj *obj2, Obj *grid, GridCoord row1, GridCoord col1, GridCoord row2, GridCoord col2, Float speed, Obj *cost, Ts *depart);
 Bool TripDrive(Obj *actor, Obj *obj1, Obj *obj2, Ts *leave_after, Ts *arrive_before, Obj *polity1, Obj *grid1, GridCoord row1, GridCoord col1, Obj *polity2, Obj *grid2, GridCoord row2, GridCoord col2, Trip *in_tr, Trip **out_tr);
 Bool TripGetDepArr(Obj *script, Obj *prop, Ts *leave_after, Ts *arrive_before, Dur *checkdurp, Ts *checkin, Ts *depart, Ts *arrive);
@@ -381,7 +381,7 @@ ObjList *Sem_AnaphoraPronounIntersentential(Obj *pronoun, PNode *pn, Obj *class,
   Actor		*ac;
   Antecedent	*ant;
   Anaphor	*anaphors;
-  for (ac = cx->actors; ac; ac = ac->next) {
+  for (ac = ContextActors(cx); ac; ac = ac->next) {
     if (!ISAP(class, ac->actor)) continue;
     ant = &ACTOR_ANTECEDENT(ac, cx);
     salience = SALIENCE(ant);
@@ -397,7 +397,7 @@ ObjList *Sem_AnaphoraPronounIntersentential(Obj *pronoun, PNode *pn, Obj *class,
   }
   if (number == F_PLURAL) {
     objs = NULL;
-    for (ac = cx->actors; ac; ac = ac->next) {
+    for (ac = ContextActors(cx); ac; ac = ac->next) {
       if (!ISAP(class, ac->actor)) continue;
       ant = &ACTOR_ANTECEDENT(ac, cx);
       salience = SALIENCE(ant);
@@ -105,7 +105,7 @@ int CaseFrameIsClause(PNode *z)
  */
 int CaseFrameSubcatOK(CaseFrame *cf, Obj *cas, int subcat)
 {
-  if (cas != N("obj") && cas != N("iobj")) return(1);
+  if (cas != N_obj && cas != N_iobj) return(1);
   if (subcat == F_NULL) {
     return(!CaseFrameIsClause(cf->sp.pn));
   } else {
@@ -176,7 +176,7 @@ Obj *CaseFrameGetLe_DoNotMark(CaseFrame *cf, Obj *cas, LexEntry *le,
 Bool CaseFrameThetaMarkExpletive(CaseFrame *cf, LexEntry *le)
 {
   for (; cf; cf = cf->next) {
-    if (cf->cas == N("expl") && (!cf->theta_marked) &&
+    if (cf->cas == N_expl && (!cf->theta_marked) &&
         ((!le) || le == PNodeLeftmostLexEntry(cf->sp.pn))) {
       cf->theta_marked = 1;
       return(1);
@@ -222,7 +222,7 @@ Bool CaseFrameDisobeysThetaCriterion(CaseFrame *cf, Obj *obj)
   for (; cf; cf = cf->next) {
   /* todo: This is too drastic in the case of iobjs? */
     if ((!cf->theta_marked) &&
-        (cf->cas == N("obj") || cf->cas == N("iobj") || cf->cas == N("expl"))) {
+        (cf->cas == N_obj || cf->cas == N_iobj || cf->cas == N_expl)) {
       if (DbgOn(DBGSEMPAR, DBGDETAIL)) {
         fprintf(Log, "<%s> rejected because ",  M(obj));
         CaseFramePrint1(Log, cf);
@@ -183,6 +183,8 @@ Discourse *DiscourseCreate(char *langs, char *dialects)
   dc->mode = DC_MODE_PROGRAMMER|DC_MODE_CONV;
   dc->last_answers = NULL;
   dc->run_agencies = AGENCY_ALL;
+  dc->understand_workers = 0;
+  dc->understand_stopped = 0;
   DiscourseDeicticStackClear(dc);
   dc->relax = 0;
   dc->defer_ok = 0;
@@ -483,7 +485,7 @@ void DiscourseEndOfSentence(Discourse *dc)
 
   /* Grid */
   gridstate = NULL;
-  for (ac = cx->actors; ac; ac = ac->next) {
+  for (ac = ContextActors(cx); ac; ac = ac->next) {
     if (!ISA(N("animal"), ac->actor)) continue;
     if (ac->actor == Me) continue;
     Dbg(DBGGEN, DBGDETAIL, "next actor:");
@@ -506,7 +508,7 @@ void DiscourseEndOfSentence(Discourse *dc)
   }
 
   /* Actor emotions and active subgoals */
-  for (ac = cx->actors; ac; ac = ac->next) {
+  for (ac = ContextActors(cx); ac; ac = ac->next) {
     if (!ISA(N("animal"), ac->actor)) continue;
     if (ac->actor == Me) continue;
     fprintf(Display, "%s ", M(ac->actor));
@@ -168,11 +168,11 @@ Obj *Sem_ParseToCanonical1(Obj *in)
 {
   int		i, len;
   Obj		*out;
-  if (N("action") == I(in, 0) &&
-      ISA(N("object-interrogative-pronoun"), I(in, 2))) {
+  if (N_action == I(in, 0) &&
+      ISA(N_object_interrogative_pronoun, I(in, 2))) {
     out = L(N("action-interrogative-pronoun"), I(in, 1), E);
-  } else if (N("appearance-copula") == I(in, 0) &&
-             ISA(N("object-interrogative-pronoun"), I(in, 2))) {
+  } else if (N_appearance_copula == I(in, 0) &&
+             ISA(N_object_interrogative_pronoun, I(in, 2))) {
     out = L(N("attribute-interrogative-pronoun"), I(in, 1), E);
   } else {
     out = in;
@@ -192,7 +192,7 @@ Obj *Sem_ParseToCanonical1(Obj *in)
 
 Obj *Sem_ParseToCanonical(Obj *obj, Discourse *dc)
 {
-  if (ISA(N("intervention"), obj)) {
+  if (ISA(N_intervention, obj)) {
     return(Sem_ParseToCanonical1(L(obj, DiscourseSpeaker(dc),
                                    DiscourseListener(dc), E)));
   }
@@ -397,8 +397,8 @@ ObjList *Sem_CartProduct(PNode *pnfrom, PNode *pnto, Obj *from_max, Obj *to_max,
    * Je veux [X [Z m'en aller]]
    * Je dcide [Y de [X [Z m'en aller]]]
    */
-    if ((subjcon = CaseFrameGet(cf, N("subj"), &subj_sp))) {
-      cf_from = CaseFrameAddSP(NULL, N("subj"), subjcon, &subj_sp);
+    if ((subjcon = CaseFrameGet(cf, N_subj, &subj_sp))) {
+      cf_from = CaseFrameAddSP(NULL, N_subj, subjcon, &subj_sp);
       cf_from_removeme = 1;
     } else {
       cf_from = NULL;
@@ -415,26 +415,26 @@ ObjList *Sem_CartProduct(PNode *pnfrom, PNode *pnto, Obj *from_max, Obj *to_max,
   }
   fromcons = Sem_ParseParse1(pnfrom, cf_from, dc);
   if (cf_from_removeme) CaseFrameRemove(cf_from);
-  if (N("X-MAX") == from_max) {
+  if (N_X_MAX == from_max) {
   /* todo: It is awkward for the caller to have to specify <from_max>.
    * It would be easier if every PNode pointed to its parent. But this
    * will not work since multiple parses share the same structure.
    * Perhaps we should make a copy and set up its parent pointers
    * before calling Sem_Parse.
    */
-  } else if (N("Y-MAX") == from_max) {
-    if (cas == N("iobj") && pnfrom->pn1 &&
+  } else if (N_Y_MAX == from_max) {
+    if (cas == N_iobj && pnfrom->pn1 &&
                             pnfrom->pn1->feature == F_PREPOSITION &&
                             pnfrom->pn2 &&
                             pnfrom->pn2->type == PNTYPE_TSRANGE) {
-      cas = N("tsrobj");
+      cas = N_tsrobj;
     }
   }
   r = NULL;
   for (p = fromcons; p; p = p->next) {
-    if (cas == N("subj") &&
-        (ISA(N("relative-pronoun"), p->obj) ||
-         ISA(N("determining-interrogative-pronoun"), p->obj))) {
+    if (cas == N_subj &&
+        (ISA(N_relative_pronoun, p->obj) ||
+         ISA(N_determining_interrogative_pronoun, p->obj))) {
       continue;
     }
     cf_to = CaseFrameAdd(cf, cas, p->obj, p->u.sp.score,
@@ -445,17 +445,17 @@ ObjList *Sem_CartProduct(PNode *pnfrom, PNode *pnto, Obj *from_max, Obj *to_max,
                              Sem_ParseSubjectOf(pnfrom, p->obj),
                              &p->u.sp);
     }
-    if (N("W-MAX") == to_max) {
+    if (N_W_MAX == to_max) {
       save_cth = dc->cth;
       CompTenseHolderInit(&dc->cth);
     }
     if ((r1 = Sem_ParseParse1(pnto, cf_to, dc))) {
-      if (N("W-MAX") == to_max) {
+      if (N_W_MAX == to_max) {
         r1 = ObjListTenseAddSP(r1, dc->cth.tense_r);
       }
       r = ObjListAppendDestructive(r, r1);
     }
-    if (N("W-MAX") == to_max) {
+    if (N_W_MAX == to_max) {
       dc->cth = save_cth;
     }
     if (subjcas) {
@@ -1014,7 +1014,7 @@ ObjList *Sem_Parse_PrepositionAdjunct1(Float score, Obj *prep, ObjList *args1,
   ObjList	*p, *r, *props;
   restrict_r1 = DbGetRestriction(prep, 1);
   restrict_r2 = DbGetRestriction(prep, 2);
-  if (!ISA(N("prep-adjunct-OK"), prep)) {
+  if (!ISA(N_prep_adjunct_OK, prep)) {
     if (DbgOn(DBGSEMPAR, DBGDETAIL)) {
       fprintf(Log, "<%s> rejected because not a <prep-adjunct-OK>\n", M(prep));
     }
@@ -1118,7 +1118,7 @@ ObjList *Sem_ParseThetaMarkingAdjuncts(Float score, LexEntryToObj *leo,
   for (cf1 = cf; cf1; cf1 = cf1->next) {
     if (cf1->theta_marked) continue;
     /************************************************************************/
-    if (is_pred && cf1->cas == N("expl")) {
+    if (is_pred && cf1->cas == N_expl) {
       if (cf1->sp.pn && cf1->sp.pn->feature == F_ADVERB) {
       /* An untheta-marked "expl" adverb argument upgrades from expletive
        * status to normal adverb status.
@@ -1127,7 +1127,7 @@ ObjList *Sem_ParseThetaMarkingAdjuncts(Float score, LexEntryToObj *leo,
         cf1->theta_marked = 1;
       }
     /************************************************************************/
-    } else if (cf1->cas == N("iobj")) {
+    } else if (cf1->cas == N_iobj) {
       if ((le_prep = PNodeLeftmostPreposition(cf1->sp.pn))) {
         if ((r1 = Sem_Parse_PrepositionAdjunct(score, leo, le_prep, r,
                                                cf1->concept, is_pred,
@@ -1137,7 +1137,7 @@ ObjList *Sem_ParseThetaMarkingAdjuncts(Float score, LexEntryToObj *leo,
         }
       }
     /************************************************************************/
-    } else if (is_pred && cf1->cas == N("tsrobj")) {
+    } else if (is_pred && cf1->cas == N_tsrobj) {
       tsr = ObjToTsRange(cf1->concept);
       /* Example:
        * tsr: 1000tod
@@ -1267,9 +1267,9 @@ Bool Sem_ParseIsImperative(Obj *comptense, int lang)
   /* Imperatives are not represented as distinct inflections in English, since
    * the form is always the same as the infinitive.
    */
-    return(N("infinitive") == comptense);
+    return(N_infinitive == comptense);
   } else {
-    return(N("imperative") == comptense);
+    return(N_imperative == comptense);
   }
 }
 
@@ -1298,7 +1298,7 @@ Obj *Sem_ParseThetaMarking_Pred(LexEntryToObj *leo, int pos, Obj *comptense,
        theta_roles;
        slotnum++, theta_roles = theta_roles->next) {
     ThetaRoleGet(theta_roles, &tr_le, &cas, &subcat, &isoptional);
-    if (cas == N("expl")) {
+    if (cas == N_expl) {
       if (!CaseFrameThetaMarkExpletive(cf, tr_le)) {
       /* All expl in ThetaRole must be found. A possible exception to implement:
        * "not" may be omitted in which case [not <r>] would be the result.
@@ -1313,12 +1313,12 @@ Obj *Sem_ParseThetaMarking_Pred(LexEntryToObj *leo, int pos, Obj *comptense,
       slotnum--;
       continue;
     }
-    if (cas == N("aobj") &&
+    if (cas == N_aobj &&
         ((aobj == NULL) ||
          (aobj_sp == NULL))) {
       Dbg(DBGSEMPAR, DBGBAD, "NULL aobj?!");
     }
-    if (cas == N("aobj") && aobj && aobj_sp) {
+    if (cas == N_aobj && aobj && aobj_sp) {
       con_elem = aobj;
       score_elem = aobj_sp->score;
       pn_elem = aobj_sp->pn;
@@ -1331,20 +1331,20 @@ Obj *Sem_ParseThetaMarking_Pred(LexEntryToObj *leo, int pos, Obj *comptense,
       con_elem = CaseFrameGetLe(cf, cas, tr_le, subcat, &elem_sp);
       pn_elem = elem_sp.pn;
       score_elem = elem_sp.score;
-      if (dc->defer_ok && con_elem == NULL && cas == N("subj")) {
+      if (dc->defer_ok && con_elem == NULL && cas == N_subj) {
         return(OBJDEFER);
       }
       if (con_elem == NULL && 
-          ISA(N("spatial"), leo->obj) &&
-          tr_le && LexEntryConceptIsAncestor(N("spatial-preposition"), tr_le)) {
+          ISA(N_spatial, leo->obj) &&
+          tr_le && LexEntryConceptIsAncestor(N_spatial_preposition, tr_le)) {
       /* "She went where?" satisfies ==ptrans/spatial/go* to+.Vz/ etc. */
-        con_elem = CaseFrameGetClass(cf, N("obj"),
-                                     N("location-interrogative-pronoun"),
+        con_elem = CaseFrameGetClass(cf, N_obj,
+                                     N_location_interrogative_pronoun,
                                      &elem_sp);
         pn_elem = elem_sp.pn;
         score_elem = elem_sp.score;
       }
-      if (con_elem == NULL && cas == N("subj")) {
+      if (con_elem == NULL && cas == N_subj) {
       /* For "Un temps  s'offrir un petit schnaps".
        * todoSCORE: If this is too relaxed, we could instead set an na
        * subject in NP PP -> NP.
@@ -1359,7 +1359,7 @@ Obj *Sem_ParseThetaMarking_Pred(LexEntryToObj *leo, int pos, Obj *comptense,
           pn_elem = NULL;
         }
       }
-      if (con_elem && cas != N("subj") && cas != N("aobj") &&
+      if (con_elem && cas != N_subj && cas != N_aobj &&
           !Sem_ParseSatisfiesSSubcategRestrict(pn_elem, subcat, dc)) {
         if (isoptional) {
           con_elem = NULL;
@@ -1375,7 +1375,7 @@ Obj *Sem_ParseThetaMarking_Pred(LexEntryToObj *leo, int pos, Obj *comptense,
       *anaphors = AnaphorAppendDestructive(*anaphors,
                                            AnaphorCopyAll(elem_sp.anaphors));
     }
-    if (cas == N("subj") || cas == N("aobj")) {
+    if (cas == N_subj || cas == N_aobj) {
       subj = con_elem;
     }
     if (!con_elem) {
@@ -1427,7 +1427,7 @@ ObjList *Sem_ParseThetaMarking1(Float head_score, LexEntryToObj *head_leo,
   Anaphor	*anaphors;
   *accepted = 0;
   CaseFrameThetaMarkClear(cf);
-  if (ISA(N("F68"), I(aobj, 0))) {
+  if (ISA(N_F68, I(aobj, 0))) {
   /* aobj: [definite-article woman]
    * aobj1: woman
    */
@@ -1437,7 +1437,7 @@ ObjList *Sem_ParseThetaMarking1(Float head_score, LexEntryToObj *head_leo,
     aobj1 = aobj;
   }
   if ((is_pred = (pos != F_NOUN || head_leo->theta_roles ||
-                  ISA(N("action"), head_leo->obj)))) {
+                  ISA(N_action, head_leo->obj)))) {
     con = Sem_ParseThetaMarking_Pred(head_leo, pos, comptense,
                                      aobj1, aobj_sp, cf, dc,
                                      &args_score, &anaphors);
@@ -1454,7 +1454,7 @@ ObjList *Sem_ParseThetaMarking1(Float head_score, LexEntryToObj *head_leo,
 
   r = NULL;
   if (pos == F_ADJECTIVE) {
-    /* aobj: N("human")
+    /* aobj: N_human
      * con:   [stupid human]
      * props: [NAME-of human NAME:"Jim Garnier"]
      */
@@ -1527,22 +1527,22 @@ void Sem_ParseGetCopulaArgs(LexEntryToObj *leo, CaseFrame *cf,
   for (theta_roles = leo->theta_roles;
        theta_roles;
        theta_roles = theta_roles->next) {
-    if (theta_roles->cas == N("obj")) {
-      o = CaseFrameGet(cf, N("obj"), obj_sp);
-      if ((N("such-that") == I(o, 0)) && ISA(N("relation"), I(o, 1)) &&
-          N("one") == I(I(o, 2), 0) && I(o, 1) == I(I(o, 2), 1)) {
+    if (theta_roles->cas == N_obj) {
+      o = CaseFrameGet(cf, N_obj, obj_sp);
+      if ((N_such_that == I(o, 0)) && ISA(N_relation, I(o, 1)) &&
+          N_one == I(I(o, 2), 0) && I(o, 1) == I(I(o, 2), 1)) {
       /* [such-that vice-president-of [one vice-president-of]] =>
        * vice-president-of
        */
         o = I(o, 1);
       }
       *obj = o;
-      *iobj = CaseFrameGet(cf, N("iobj"), iobj_sp);
+      *iobj = CaseFrameGet(cf, N_iobj, iobj_sp);
               /* Relaxed. We accept any preposition. */
       return;
-    } else if (theta_roles->cas == N("iobj")) {
-      *obj = CaseFrameGetLe(cf, N("iobj"), theta_roles->le, F_NULL, obj_sp);
-      *iobj = CaseFrameGetNonThetaMarked(cf, N("iobj"), iobj_sp);
+    } else if (theta_roles->cas == N_iobj) {
+      *obj = CaseFrameGetLe(cf, N_iobj, theta_roles->le, F_NULL, obj_sp);
+      *iobj = CaseFrameGetNonThetaMarked(cf, N_iobj, iobj_sp);
               /* Relaxed. We accept any preposition. */
       return;
     }
@@ -1686,7 +1686,7 @@ ObjList *Sem_ParseCopula(Float head_score, LexEntryToObj *leo, PNode *head_pn,
 
   CaseFrameThetaMarkClear(cf);
   *accepted = 0;
-  if ((subj = CaseFrameGet(cf, N("subj"), &subj_sp))) {
+  if ((subj = CaseFrameGet(cf, N_subj, &subj_sp))) {
     Sem_ParseGetCopulaArgs(leo, cf, &obj, &obj_sp, &iobj, &iobj_sp);
     if (obj) {
 #ifdef notdef
@@ -1698,7 +1698,7 @@ ObjList *Sem_ParseCopula(Float head_score, LexEntryToObj *leo, PNode *head_pn,
         iobj_sp.score = obj_sp.score;
       } else if ((props = ObjIntensionParse(obj, 0, &class)) &&
                  ObjListIsLengthOne(props) &&
-                 ISA(N("relation"), I(props->obj, 0))) {
+                 ISA(N_relation, I(props->obj, 0))) {
       /* todo: This is hopelessly nongeneral. */
         obj = I(props->obj, 0);
         obj_sp.pn = PNI(props->obj, 0);
@@ -1764,7 +1764,7 @@ ObjList *Sem_ParseThetaMarking(Float head_score, LexEntryToObj *head_leo,
                                CaseFrame *cf, Discourse *dc,
                                /* RESULTS */ int *accepted)
 {
-  if (ISA(N("copula"), head_leo->obj)) {
+  if (ISA(N_copula, head_leo->obj)) {
     if (props) Dbg(DBGSEMPAR, DBGBAD, "Sem_ParseThetaMarking: copula & props");
     return(Sem_ParseCopula(head_score, head_leo, head_pn, comptense, r, cf, dc,
                            accepted));
@@ -3314,9 +3314,9 @@ ObjList *Sem_ParseVerb1(PNode *pn_mainverb, Obj *comptense, CaseFrame *cf,
     return(NULL);
   }
   r = NULL;
-  progressive = ISA(N("progressive-tense"), comptense);
+  progressive = ISA(N_progressive_tense, comptense);
   for (leo = LexEntryGetLeo(le); leo; leo = leo->next) {
-    if (ISA(N("auxiliary-verb"), leo->obj)) continue;
+    if (ISA(N_auxiliary_verb, leo->obj)) continue;
     if (progressive && !ProgressiveIsOK(leo->obj, leo->features)) {
     /* todoSCORE? "I have dinner" => [part-of Jim dinner] */
       continue;
@@ -48,25 +48,25 @@ Obj *TenseFindInflTense(int lang, Obj *tense, Obj *mood)
   Obj		*r;
   ObjList	*objs, *p;
   if (lang == F_ENGLISH) {
-    if (mood == N("F63") && tense != N("F100") && tense != N("F101") &&
-        tense != N("F102")) {
+    if (mood == N_F63 && tense != N_F100 && tense != N_F101 &&
+        tense != N_F102) {
     /* This is because English inflections except for "be" do not specify
      * mood. Indicative is assumed.
      */ 
-      mood = N("F71");
+      mood = N_F71;
     }
-    if (mood == N("F63")) mood = N("F71");
+    if (mood == N_F63) mood = N_F71;
       /* This is because of inflection collapsing. */
-    objs = RE(&TsNA, L(N("eng-infl-tense-of"), ObjWild, tense, E));
+    objs = RE(&TsNA, L(N_eng_infl_tense_of, ObjWild, tense, E));
     for (p = objs; p; p = p->next) {
-      if (YES(RE(&TsNA, L(N("eng-infl-mood-of"), I(p->obj, 1), mood, E)))) {
+      if (YES(RE(&TsNA, L(N_eng_infl_mood_of, I(p->obj, 1), mood, E)))) {
         r = I(p->obj, 1);
         ObjListFree(objs);
         return(r);
       }
     }
   } else {
-    if (mood == N("F63")) mood = N("F71");
+    if (mood == N_F63) mood = N_F71;
       /* This is because of inflection collapsing. */
     objs = RE(&TsNA, L(N("fr-infl-tense-of"), ObjWild, tense, E));
     for (p = objs; p; p = p->next) {
@@ -269,7 +269,7 @@ Bool TenseParse_IsOnlyAnAuxiliary(LexEntry *le)
 {
   LexEntryToObj	*leo;
   for (leo = le->leo; leo; leo = leo->next) {
-    if (!ISA(N("auxiliary-verb"), leo->obj)) return(0);
+    if (!ISA(N_auxiliary_verb, leo->obj)) return(0);
   }
   return(1);
 }
@@ -23,6 +23,8 @@
  * 19951212: added OBJLISTRULEDOUT and call to Sem_AnaphoraParses
  * 19951213: integrated parsing ifdefed out
  * 19980630: mods for compound noun parsing
+ * 20261017T170000: chart-indexed parse
+ * 20261017T190000: (feature, feature) rule dispatch table
  */
 
 #include "tt.h"
@@ -66,8 +68,104 @@ void StopAtSet(int sa1, int sa2, int safeat)
   SAFEAT = safeat;
 }
 
+/* Rule dispatch. Syn_ParseHeads[i][j] lists, in increasing order, the
+ * k for which there is a base rule k -> i j, so the parser tries only
+ * those. Syn_ParseFilters[i][j][k] is the filter Syn_ParseDoesRuleFire
+ * applies to that rule, or NULL.
+ */
+typedef Float (*Syn_ParseFilterFn)(PNode *pn1, PNode *pn2, int lang);
+
+typedef struct {
+  char			f1, f2, f;
+  Syn_ParseFilterFn	filter;
+} Syn_ParseFilterDef;
+
+Syn_ParseFilterDef Syn_ParseFilterDefs[] = {
+  {F_ADVERB, F_ADJP, F_ADJP, Syn_ParseFilterBE_E},
+  {F_DETERMINER, F_ADJP, F_ADJP, Syn_ParseFilterDE_E},
+  {F_ADJP, F_PP, F_ADJP, Syn_ParseFilterEY_E},
+  {F_ADJP, F_ADJP, F_ADJP, Syn_ParseFilterEE_E},
+  {F_CONJUNCTION, F_ADJP, F_ADJP, Syn_ParseFilterKE_E},
+  {F_VP, F_ADJP, F_VP, Syn_ParseFilterWE_W},
+  {F_DETERMINER, F_NP, F_NP, Syn_ParseFilterDX_X},
+  {F_ADJP, F_NP, F_NP, Syn_ParseFilterEX_X},
+  {F_NP, F_ADJP, F_NP, Syn_ParseFilterXE_X},
+  {F_VP, F_PP, F_VP, Syn_ParseFilterWY_W},
+  {F_VP, F_VERB, F_VP, Syn_ParseFilterWV_W},
+  {F_ADVERB, F_VP, F_VP, Syn_ParseFilterBW_W},
+  {F_VP, F_ADVERB, F_VP, Syn_ParseFilterWB_W},
+  {F_PRONOUN, F_VP, F_VP, Syn_ParseFilterHW_W},
+  {F_PP, F_S, F_S, Syn_ParseFilterYZ_Z},
+  {F_VP, F_PRONOUN, F_VP, Syn_ParseFilterWH_W},
+  {F_VP, F_NP, F_VP, Syn_ParseFilterWX_W},
+  {F_CONJUNCTION, F_NP, F_NP, Syn_ParseFilterKX_X},
+  {F_CONJUNCTION, F_PP, F_PP, Syn_ParseFilterKY_Y},
+  {F_PREPOSITION, F_NP, F_PP, Syn_ParseFilterRX_Y},
+  {F_PREPOSITION, F_ADVERB, F_PP, Syn_ParseFilterRB_Y},
+  {F_NP, F_PP, F_NP, Syn_ParseFilterXY_X},
+  {F_NP, F_S, F_NP, Syn_ParseFilterXZ_X},
+  {F_NP, F_VP, F_NP, Syn_ParseFilterXW_X},
+  {F_NP, F_NP, F_NP, Syn_ParseFilterXX_X},
+  {F_NP, F_ELEMENT, F_NP, Syn_ParseFilterX9_X},
+  {F_PP, F_PP, F_PP, Syn_ParseFilterYY_Y},
+  {F_NP, F_VP, F_S, Syn_ParseFilterXW_Z},
+  {F_NP, F_ADJP, F_S, Syn_ParseFilterXE_Z},
+  {F_PRONOUN, F_NP, F_S, Syn_ParseFilterHX_Z},
+  {F_S, F_S, F_S, Syn_ParseFilterZZ_Z},
+  {F_NP, F_S, F_S, Syn_ParseFilterXZ_Z},
+  {F_ADJP, F_VP, F_S, Syn_ParseFilterEW_Z},
+  {F_ADJP, F_S, F_S, Syn_ParseFilterEZ_Z},
+  {F_ADVERB, F_S, F_S, Syn_ParseFilterBZ_Z},
+  {F_S, F_ADVERB, F_S, Syn_ParseFilterZB_Z},
+  {F_NULL, F_NULL, F_NULL, NULL}
+};
+
+char			Syn_ParseHeads[NUMPOS][NUMPOS][NUMPOS];
+int			Syn_ParseHeadsLen[NUMPOS][NUMPOS];
+Syn_ParseFilterFn	Syn_ParseFilters[NUMPOS][NUMPOS][NUMPOS];
+
+/* Counters for parsestats. */
+long Syn_ParseParses, Syn_ParseRuleCandidates, Syn_ParseRuleAttempts;
+long Syn_ParseRuleFires;
+
 /* EXTERNAL FUNCTIONS */
 
+/* Called after BaseRuleCompile. */
+void Syn_ParseRuleTableInit()
+{
+  int			i, j, k, len;
+  Syn_ParseFilterDef	*fd;
+  for (i = 0; i < NUMPOS; i++) {
+    for (j = 0; j < NUMPOS; j++) {
+      len = 0;
+      for (k = 0; k < NUMPOS; k++) {
+        if (0 < BaseRules[i][j][k]) Syn_ParseHeads[i][j][len++] = k;
+        Syn_ParseFilters[i][j][k] = NULL;
+      }
+      Syn_ParseHeadsLen[i][j] = len;
+    }
+  }
+  for (fd = Syn_ParseFilterDefs; fd->filter; fd++) {
+    Syn_ParseFilters[POSGI(fd->f1)][POSGI(fd->f2)][POSGI(fd->f)] = fd->filter;
+  }
+}
+
+void Syn_ParseStatsPrint(FILE *stream)
+{
+  double	n;
+  n = (Syn_ParseParses > 0L) ? (double)Syn_ParseParses : 1.0;
+  fprintf(stream, "%ld syntactic parse(s)\n", Syn_ParseParses);
+  fprintf(stream, "%10ld candidate node(s) and pair(s)  %10.1f per parse\n",
+          Syn_ParseRuleCandidates, Syn_ParseRuleCandidates/n);
+  fprintf(stream, "%10ld rule attempts undispatched   %10.1f per parse\n",
+          Syn_ParseRuleCandidates*NUMPOS,
+          (Syn_ParseRuleCandidates*NUMPOS)/n);
+  fprintf(stream, "%10ld rule attempts dispatched     %10.1f per parse\n",
+          Syn_ParseRuleAttempts, Syn_ParseRuleAttempts/n);
+  fprintf(stream, "%10ld rule(s) fired                %10.1f per parse\n",
+          Syn_ParseRuleFires, Syn_ParseRuleFires/n);
+}
+
 void Syn_ParseSem_Parse(PNode *pn, Channel *ch, int tgtlang, Discourse *dc)
 {
   ObjList *concepts;
@@ -92,8 +190,8 @@ void Syn_ParseFragments(Channel *ch, int tgtlang, Discourse *dc, int eoschar)
     /* Find longest PNodes starting at start_lowerb. */
     max_upperb = SIZENEGINF;
     max_pns_len = 0;
-    for (pn = ch->synparse_pns; pn; pn = pn->next) {
-      if (pn->lowerb != start_lowerb) continue;
+    for (pn = ch->synparse_startat[start_lowerb-ch->synparse_lowerb]; pn;
+         pn = pn->next_startat) {
       if (pn->upperb > max_upperb) {
         max_upperb = pn->upperb;
         max_pns_len = 0;
@@ -140,16 +238,20 @@ void Syn_ParseParse(Channel *ch, Discourse *dc, size_t in_lowerb,
 {
   int		changed, lang, tgtlang;
   size_t	lowerb,	upperb;
+  long		ntocnt;
   PNode		*pn;
   ABrainTask	*abt;
 
   Dbg(DBGGEN, DBGDETAIL, "**** SYNTACTIC PARSE BEGIN ****");
 
-  abt = BBrainBegin(N("parse"), 120L, INTNA);
+  ntocnt = NameToObjCnt;
+  Syn_ParseParses++;
+  abt = BBrainBegin(N_parse, 120L, INTNA);
   lang = DC(dc).lang;
   tgtlang = FeatureFlipLanguage(lang);
   ch->synparse_pns = NULL;
   ch->synparse_pnnnext = PNUMSTART;
+  ch->synparse_seqnext = 1L;
   ch->synparse_sentences = 0;
   lowerb = SIZEPOSINF;
   upperb = SIZENEGINF;
@@ -174,6 +276,7 @@ void Syn_ParseParse(Channel *ch, Discourse *dc, size_t in_lowerb,
   }
   ch->synparse_lowerb = lowerb;
   ch->synparse_upperb = upperb;
+  Syn_ParseChartBegin(ch);
 
   if (in_lowerb < lowerb) {
     TranslateSpitUntranslated(ch, in_lowerb, lowerb-1);
@@ -215,11 +318,14 @@ void Syn_ParseParse(Channel *ch, Discourse *dc, size_t in_lowerb,
     Syn_ParsePrintPNodes(Log, ch);
   }
   Syn_ParseCnt += ch->synparse_sentences;
+  Syn_ParseChartEnd(ch);
 
   Dbg(DBGGEN, DBGDETAIL, "**** SYNTACTIC PARSE END ****");
 
   Dbg(DBGGEN, DBGDETAIL, "%d syntactic parse(s) [session total %ld] of <%.10s>",
       ch->synparse_sentences, Syn_ParseCnt, ch->buf + lowerb);
+  Dbg(DBGGEN, DBGDETAIL, "%ld NameToObj call(s) during parse of <%.10s>",
+      NameToObjCnt - ntocnt, ch->buf + lowerb);
 }
 
 void Syn_ParseParseDone(Channel *ch)
@@ -246,6 +352,59 @@ void Syn_ParseAssignPnum(Channel *ch, PNode *pn)
 {
   pn->num = ch->synparse_pnnnext;
   ch->synparse_pnnnext++;
+  pn->seq = ch->synparse_seqnext;
+  ch->synparse_seqnext++;
+}
+
+/* The chart indexes the PNodes of the current sentence by the position
+ * at which they start and by the position at which they end, so that
+ * Syn_ParseApplyRules only visits adjacent PNodes. Each position's list,
+ * like ch->synparse_pns, is newest (highest seq) first.
+ */
+void Syn_ParseChartBegin(Channel *ch)
+{
+  size_t	len, i;
+  PNode		*pn, **pns;
+  if (ch->synparse_upperb >= ch->synparse_lowerb) {
+    len = ch->synparse_upperb - ch->synparse_lowerb + 1;
+  } else {
+    len = 1;
+  }
+  ch->synparse_startat = (PNode **)MemAlloc(len*sizeof(PNode *),
+                                            "PNode* chart");
+  ch->synparse_endat = (PNode **)MemAlloc(len*sizeof(PNode *),
+                                          "PNode* chart");
+  for (i = 0; i < len; i++) {
+    ch->synparse_startat[i] = NULL;
+    ch->synparse_endat[i] = NULL;
+  }
+  /* Enter the initial PNodes oldest first. */
+  for (len = 0, pn = ch->synparse_pns; pn; pn = pn->next) len++;
+  if (len == 0) return;
+  pns = (PNode **)MemAlloc(len*sizeof(PNode *), "PNode* chart");
+  for (i = 0, pn = ch->synparse_pns; pn; pn = pn->next) pns[i++] = pn;
+  while (i > 0) Syn_ParseChartAdd(ch, pns[--i]);
+  MemFree(pns, "PNode* chart");
+}
+
+void Syn_ParseChartAdd(Channel *ch, PNode *pn)
+{
+  size_t	i;
+  pn->pairedthru = 0L;
+  i = pn->lowerb - ch->synparse_lowerb;
+  pn->next_startat = ch->synparse_startat[i];
+  ch->synparse_startat[i] = pn;
+  i = pn->upperb - ch->synparse_lowerb;
+  pn->next_endat = ch->synparse_endat[i];
+  ch->synparse_endat[i] = pn;
+}
+
+void Syn_ParseChartEnd(Channel *ch)
+{
+  if (ch->synparse_startat) MemFree(ch->synparse_startat, "PNode* chart");
+  if (ch->synparse_endat) MemFree(ch->synparse_endat, "PNode* chart");
+  ch->synparse_startat = NULL;
+  ch->synparse_endat = NULL;
 }
 
 Bool Syn_ParseIsTopLevelSentence(PNode *pn)
@@ -326,6 +485,7 @@ void Syn_ParseAdd(Channel *ch, Discourse *dc, char feature,
     fputc(NEWLINE, Log);
   }
 
+  Syn_ParseRuleFires++;
   pn = PNodeCreate(feature, NULL, pn1, pn2, lowerb, upperb, NULL, NULL);
   pn->type = PNTYPE_CONSTITUENT;
   pn->score = score;
@@ -380,6 +540,7 @@ void Syn_ParseAdd(Channel *ch, Discourse *dc, char feature,
 
   pn->next = ch->synparse_pns;
   ch->synparse_pns = pn;
+  Syn_ParseChartAdd(ch, pn);
   return;
 /*
 failure:
@@ -392,9 +553,12 @@ Bool Syn_ParseApplySingletonRules(Channel *ch, Discourse *dc, PNode *pn,
                                   int lang)
 {
   Float	score;
-  int	k, changed;
+  int	h, i, k, changed;
   changed = 0;
-  for (k = 0; k < NUMPOS; k++) {
+  Syn_ParseRuleCandidates++;
+  i = POSGI(pn->feature);
+  for (h = 0; h < Syn_ParseHeadsLen[i][0]; h++) {
+    k = Syn_ParseHeads[i][0][h];
     if (0.0 < (score = Syn_ParseDoesRuleFire(pn, NULL, k, lang, dc))) {
       score = ScoreCombine(score, pn->score);
       Syn_ParseAdd(ch, dc, IPOSG(k), pn, NULL, score, pn->lowerb,
@@ -405,18 +569,50 @@ Bool Syn_ParseApplySingletonRules(Channel *ch, Discourse *dc, PNode *pn,
   return(changed);
 }
 
+/* Try the binary rules on <pn1> and each adjacent PNode it has not yet
+ * been paired with. <pn1> was already paired with neighbors older than
+ * its pairedthru; a neighbor <pn2> already paired with <pn1> if <pn1> is
+ * older than <pn2>'s pairedthru. So each pair is considered exactly once.
+ * Left and right neighbors are merged newest first, which is the order
+ * in which the full ch->synparse_pns scan used to consider them.
+ */
 Bool Syn_ParseApplyRules(Channel *ch, Discourse *dc, PNode *pn1, int lang)
 {
-  int	k, changed;
+  int	h, i, j, k, changed, isleft;
+  long	pairedthru;
   Float	score;
-  PNode *pn2;
+  PNode *left, *right, *pn2;
   changed = 0;
-  for (pn2 = ch->synparse_pns; pn2; pn2 = pn2->next) {
-    if (pn2 == pn1) continue;
-    if (pn2->upperb == (pn1->lowerb-1)) {
-      if (PNodeDidVersus(pn2, pn1)) continue;
-      PNodeAddVersus(pn2, pn1);
-      for (k = 0; k < NUMPOS; k++) {
+  pairedthru = pn1->pairedthru;
+  pn1->pairedthru = ch->synparse_seqnext;
+  if (pn1->lowerb > ch->synparse_lowerb) {
+    left = ch->synparse_endat[pn1->lowerb-1-ch->synparse_lowerb];
+  } else {
+    left = NULL;
+  }
+  if (pn1->upperb < ch->synparse_upperb) {
+    right = ch->synparse_startat[pn1->upperb+1-ch->synparse_lowerb];
+  } else {
+    right = NULL;
+  }
+  while (left || right) {
+    if (left && (right == NULL || left->seq > right->seq)) {
+      pn2 = left;
+      left = left->next_endat;
+      isleft = 1;
+    } else {
+      pn2 = right;
+      right = right->next_startat;
+      isleft = 0;
+    }
+    if (pn2->seq < pairedthru) break;
+    if (pn1->seq < pn2->pairedthru) continue;
+    Syn_ParseRuleCandidates++;
+    if (isleft) {
+      i = POSGI(pn2->feature);
+      j = POSGI(pn1->feature);
+      for (h = 0; h < Syn_ParseHeadsLen[i][j]; h++) {
+        k = Syn_ParseHeads[i][j][h];
         if (0.0 < (score = Syn_ParseDoesRuleFire(pn2, pn1, k, lang, dc))) {
           score = ScoreCombine(score, pn1->score);
           score = ScoreCombine(score, pn2->score);
@@ -425,10 +621,11 @@ Bool Syn_ParseApplyRules(Channel *ch, Discourse *dc, PNode *pn1, int lang)
           changed = 1;
         }
       }
-    } else if (pn2->lowerb == (pn1->upperb+1)) {
-      if (PNodeDidVersus(pn1, pn2)) continue;
-      PNodeAddVersus(pn1, pn2);
-      for (k = 0; k < NUMPOS; k++) {
+    } else {
+      i = POSGI(pn1->feature);
+      j = POSGI(pn2->feature);
+      for (h = 0; h < Syn_ParseHeadsLen[i][j]; h++) {
+        k = Syn_ParseHeads[i][j][h];
         if (0.0 < (score = Syn_ParseDoesRuleFire(pn1, pn2, k, lang, dc))) {
           score = ScoreCombine(score, pn1->score);
           score = ScoreCombine(score, pn2->score);
@@ -439,7 +636,6 @@ Bool Syn_ParseApplyRules(Channel *ch, Discourse *dc, PNode *pn1, int lang)
       }
     }
   }
-             
   return(changed);
 }
 
@@ -496,12 +692,17 @@ Bool Syn_ParseIsValidMAX(PNode *pn1, PNode *pn2, int k, int lang)
 Float Syn_ParseDoesRuleFire(PNode *pn1, PNode *pn2, int k, int lang,
                             Discourse *dc)
 {
+  int			i, j;
+  Syn_ParseFilterFn	filter;
+  Syn_ParseRuleAttempts++;
   StopAtNodes(pn1, pn2, IPOSG(k));
   if (Syn_IsBadVP(pn1, lang)) return(0.0);
   if (Syn_IsBadVP(pn2, lang)) return(0.0);
   if (!Syn_ParseIsValidMAX(pn1, pn2, k, lang)) return(0.0);
+  i = POSGI(pn1->feature);
+  j = pn2 ? POSGI(pn2->feature) : POSGI(F_NULL);
   if (pn2 == NULL) {
-    if (0 < BaseRules[POSGI(pn1->feature)][POSGI(F_NULL)][k]) {
+    if (0 < BaseRules[i][j][k]) {
       if (pn1->feature == F_PRONOUN && k == POSGI(F_NP)) {
         return(Syn_ParseFilterH_X(pn1, lang));
       } else if (pn1->feature == F_S && k == POSGI(F_NP)) {
@@ -512,7 +713,7 @@ Float Syn_ParseDoesRuleFire(PNode *pn1, PNode *pn2, int k, int lang,
         return(1.0);
       }
     }
-  } else if (0 < BaseRules[POSGI(pn1->feature)][POSGI(pn2->feature)][k]) {
+  } else if (0 < BaseRules[i][j][k]) {
     if (dc->mode & DC_MODE_COMPOUND_NOUN) {
       if (pn1->feature == F_NP && pn2->feature == F_NP &&
           k == POSGI(F_NP)) {
@@ -524,117 +725,10 @@ Float Syn_ParseDoesRuleFire(PNode *pn1, PNode *pn2, int k, int lang,
     if (k == POSGI(F_VP)) {
       if (Syn_ParseIsVPRestrict(pn1, pn2)) return(0.0);
     }
-    if (pn1->feature == F_ADVERB && pn2->feature == F_ADJP &&
-        k == POSGI(F_ADJP)) {
-      return(Syn_ParseFilterBE_E(pn1, pn2, lang));
-    } else if (pn1->feature == F_DETERMINER && pn2->feature == F_ADJP &&
-               k == POSGI(F_ADJP)) {
-      return(Syn_ParseFilterDE_E(pn1, pn2, lang));
-    } else if (pn1->feature == F_ADJP && pn2->feature == F_PP &&
-               k == POSGI(F_ADJP)) {
-      return(Syn_ParseFilterEY_E(pn1, pn2, lang));
-    } else if (pn1->feature == F_ADJP && pn2->feature == F_ADJP &&
-               k == POSGI(F_ADJP)) {
-      return(Syn_ParseFilterEE_E(pn1, pn2, lang));
-    } else if (pn1->feature == F_CONJUNCTION && pn2->feature == F_ADJP &&
-               k == POSGI(F_ADJP)) {
-      return(Syn_ParseFilterKE_E(pn1, pn2, lang));
-    } else if (pn1->feature == F_VP && pn2->feature == F_ADJP &&
-               k == POSGI(F_VP)) {
-      return(Syn_ParseFilterWE_W(pn1, pn2, lang));
-    } else if (pn1->feature == F_DETERMINER && pn2->feature == F_NP &&
-               k == POSGI(F_NP)) {
-      return(Syn_ParseFilterDX_X(pn1, pn2, lang));
-    } else if (pn1->feature == F_ADJP && pn2->feature == F_NP &&
-               k == POSGI(F_NP)) {
-      return(Syn_ParseFilterEX_X(pn1, pn2, lang));
-    } else if (pn1->feature == F_NP && pn2->feature == F_ADJP &&
-               k == POSGI(F_NP)) {
-      return(Syn_ParseFilterXE_X(pn1, pn2, lang));
-    } else if (pn1->feature == F_VP && pn2->feature == F_PP &&
-               k == POSGI(F_VP)) {
-      return(Syn_ParseFilterWY_W(pn1, pn2, lang));
-    } else if (pn1->feature == F_VP && pn2->feature == F_VERB &&
-               k == POSGI(F_VP)) {
-      return(Syn_ParseFilterWV_W(pn1, pn2, lang));
-    } else if (pn1->feature == F_ADVERB && pn2->feature == F_VP &&
-               k == POSGI(F_VP)) {
-      return(Syn_ParseFilterBW_W(pn1, pn2, lang));
-    } else if (pn1->feature == F_VP && pn2->feature == F_ADVERB &&
-               k == POSGI(F_VP)) {
-      return(Syn_ParseFilterWB_W(pn1, pn2, lang));
-    } else if (pn1->feature == F_PRONOUN && pn2->feature == F_VP &&
-               k == POSGI(F_VP)) {
-      return(Syn_ParseFilterHW_W(pn1, pn2, lang));
-    } else if (pn1->feature == F_PP && pn2->feature == F_S &&
-               k == POSGI(F_S)) {
-      return(Syn_ParseFilterYZ_Z(pn1, pn2, lang));
-    } else if (pn1->feature == F_VP && pn2->feature == F_PRONOUN &&
-               k == POSGI(F_VP)) {
-      return(Syn_ParseFilterWH_W(pn1, pn2, lang));
-    } else if (pn1->feature == F_VP && pn2->feature == F_NP &&
-               k == POSGI(F_VP)) {
-      return(Syn_ParseFilterWX_W(pn1, pn2, lang));
-    } else if (pn1->feature == F_CONJUNCTION && pn2->feature == F_NP &&
-               k == POSGI(F_NP)) {
-      return(Syn_ParseFilterKX_X(pn1, pn2, lang));
-    } else if (pn1->feature == F_CONJUNCTION && pn2->feature == F_PP &&
-               k == POSGI(F_PP)) {
-      return(Syn_ParseFilterKY_Y(pn1, pn2, lang));
-    } else if (pn1->feature == F_PREPOSITION && pn2->feature == F_NP &&
-               k == POSGI(F_PP)) {
-      return(Syn_ParseFilterRX_Y(pn1, pn2, lang));
-    } else if (pn1->feature == F_PREPOSITION && pn2->feature == F_ADVERB &&
-               k == POSGI(F_PP)) {
-      return(Syn_ParseFilterRB_Y(pn1, pn2, lang));
-    } else if (pn1->feature == F_NP && pn2->feature == F_PP &&
-               k == POSGI(F_NP)) {
-      return(Syn_ParseFilterXY_X(pn1, pn2, lang));
-    } else if (pn1->feature == F_NP && pn2->feature == F_S &&
-               k == POSGI(F_NP)) {
-      return(Syn_ParseFilterXZ_X(pn1, pn2, lang));
-    } else if (pn1->feature == F_NP && pn2->feature == F_VP &&
-               k == POSGI(F_NP)) {
-      return(Syn_ParseFilterXW_X(pn1, pn2, lang));
-    } else if (pn1->feature == F_NP && pn2->feature == F_NP &&
-               k == POSGI(F_NP)) {
-      return(Syn_ParseFilterXX_X(pn1, pn2, lang));
-    } else if (pn1->feature == F_NP && pn2->feature == F_ELEMENT &&
-               k == POSGI(F_NP)) {
-      return(Syn_ParseFilterX9_X(pn1, pn2, lang));
-    } else if (pn1->feature == F_PP && pn2->feature == F_PP &&
-               k == POSGI(F_PP)) {
-      return(Syn_ParseFilterYY_Y(pn1, pn2, lang));
-    } else if (pn1->feature == F_NP && pn2->feature == F_VP &&
-               k == POSGI(F_S)) {
-      return(Syn_ParseFilterXW_Z(pn1, pn2, lang));
-    } else if (pn1->feature == F_NP && pn2->feature == F_ADJP &&
-               k == POSGI(F_S)) {
-      return(Syn_ParseFilterXE_Z(pn1, pn2, lang));
-    } else if (pn1->feature == F_PRONOUN && pn2->feature == F_NP &&
-               k == POSGI(F_S)) {
-      return(Syn_ParseFilterHX_Z(pn1, pn2, lang));
-    } else if (pn1->feature == F_S && pn2->feature == F_S &&
-               k == POSGI(F_S)) {
-      return(Syn_ParseFilterZZ_Z(pn1, pn2, lang));
-    } else if (pn1->feature == F_NP && pn2->feature == F_S &&
-               k == POSGI(F_S)) {
-      return(Syn_ParseFilterXZ_Z(pn1, pn2, lang));
-    } else if (pn1->feature == F_ADJP && pn2->feature == F_VP &&
-               k == POSGI(F_S)) {
-      return(Syn_ParseFilterEW_Z(pn1, pn2, lang));
-    } else if (pn1->feature == F_ADJP && pn2->feature == F_S &&
-               k == POSGI(F_S)) {
-      return(Syn_ParseFilterEZ_Z(pn1, pn2, lang));
-    } else if (pn1->feature == F_ADVERB && pn2->feature == F_S &&
-               k == POSGI(F_S)) {
-      return(Syn_ParseFilterBZ_Z(pn1, pn2, lang));
-    } else if (pn1->feature == F_S && pn2->feature == F_ADVERB &&
-               k == POSGI(F_S)) {
-      return(Syn_ParseFilterZB_Z(pn1, pn2, lang));
-    } else {
-      return(1.0);
+    if ((filter = Syn_ParseFilters[i][j][k])) {
+      return(filter(pn1, pn2, lang));
     }
+    return(1.0);
   }
   return(0.0);
 }
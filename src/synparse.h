@@ -2,11 +2,16 @@
 void StopAtInit(void);
 void StopAtNodes(PNode *pn1, PNode *pn2, int feat);
 void StopAtSet(int sa1, int sa2, int safeat);
+void Syn_ParseRuleTableInit(void);
+void Syn_ParseStatsPrint(FILE *stream);
 void Syn_ParseSem_Parse(PNode *pn, Channel *ch, int tgtlang, Discourse *dc);
 void Syn_ParseFragments(Channel *ch, int tgtlang, Discourse *dc, int eoschar);
 void Syn_ParseParse(Channel *ch, Discourse *dc, size_t in_lowerb, size_t in_upperb, int eoschar);
 void Syn_ParseParseDone(Channel *ch);
 void Syn_ParseAssignPnum(Channel *ch, PNode *pn);
+void Syn_ParseChartBegin(Channel *ch);
+void Syn_ParseChartAdd(Channel *ch, PNode *pn);
+void Syn_ParseChartEnd(Channel *ch);
 Bool Syn_ParseIsTopLevelSentence(PNode *pn);
 PNode *Syn_ParseGetSemParseConstituent(PNode *pn, PNode *pn1, PNode *pn2);
 void Syn_ParseAdd(Channel *ch, Discourse *dc, char feature, PNode *pn1, PNode *pn2, Float score, size_t lowerb, size_t upperb, int lang);
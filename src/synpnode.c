@@ -344,10 +344,11 @@ PNode *PNodeCreate(char feature, Lexitem *lexitem, PNode *pn1, PNode *pn2,
   pn->upperb = upperb;
   pn->lowerb_subj = SIZENA;
   pn->upperb_subj = SIZENA;
-  pn->versuslen = 0;
-  pn->versusmaxlen = 0;
-  pn->versus = NULL;
+  pn->seq = 0L;
+  pn->pairedthru = 0L;
   pn->appliedsingletons = 0;
+  pn->next_startat = NULL;
+  pn->next_endat = NULL;
   pn->next = next;
   pn->next_altern = NULL;
   return(pn);
@@ -493,7 +494,6 @@ Bool PNodeIsPhrase(PNode *pn)
 void PNodeFree(PNode *pn)
 {
   PNodeIsOK(pn);
-  if (pn->versus) MemFree(pn->versus, "PNode* versus");
   /* todoFREE: Free Table, Article, and other types. */
   switch (pn->type) {
     case PNTYPE_COMMUNICON:
@@ -768,35 +768,6 @@ void PNodePrintShort(FILE *stream, Channel *ch, PNode *pn)
   fputc(NEWLINE, stream);
 }
 
-Bool PNodeAddVersus(PNode *pn1, PNode *pn2)
-{
-  if (pn1->versus == NULL) {
-    pn1->versusmaxlen = 16;
-    pn1->versus = (PNNumber *)MemAlloc(pn1->versusmaxlen*sizeof(PNNumber),
-                                       "PNode* versus");
-  } else if (pn1->versuslen >= pn1->versusmaxlen) {
-    pn1->versusmaxlen = 2*pn1->versusmaxlen;
-    pn1->versus = (PNNumber *)MemRealloc(pn1->versus,
-                                         pn1->versusmaxlen*sizeof(PNNumber),
-                                         "PNode* versus");
-  }
-  pn1->versus[pn1->versuslen] = pn2->num;
-  pn1->versuslen++;
-  return(1);
-}
-
-Bool PNodeDidVersus(PNode *pn1, PNode *pn2)
-{
-  int i, len;
-  for (i = 0, len = pn1->versuslen; i < len; i++) {
-    if (pn2->num == pn1->versus[i]) return(1);
-  }
-  for (i = 0, len = pn2->versuslen; i < len; i++) {
-    if (pn1->num == pn2->versus[i]) return(1);
-  }
-  return(0);
-}
-
 /* todoFREE: Also free lexitems? */
 void PNodeFreeTree(PNode *pn)
 {
@@ -38,8 +38,6 @@ void PNodePrint(FILE *stream, Channel *ch, PNode *pn);
 void PNodeSocketPrint(Socket *skt, PNode *pn);
 void ppn(PNode *pn);
 void PNodePrintShort(FILE *stream, Channel *ch, PNode *pn);
-Bool PNodeAddVersus(PNode *pn1, PNode *pn2);
-Bool PNodeDidVersus(PNode *pn1, PNode *pn2);
 void PNodeFreeTree(PNode *pn);
 int PNodeDepth(PNode *pn);
 PNode *PNodeConstit(char feature, PNode *pn1, PNode *pn2);
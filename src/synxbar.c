@@ -65,7 +65,7 @@ Bool XBarValidX_MAX(PNode *x)
   }
   if (x->pn1 && x->pn1->feature == F_PRONOUN && x->pn2 == NULL) {
   /* Reject [Z [X [H < peine de quoi.Hy>]] [W [W [V <remplir.fVy>]]]] */
-    if (!LexEntryConceptIsAncestor(N("noun-phrase-pronoun"),
+    if (!LexEntryConceptIsAncestor(N_noun_phrase_pronoun,
                                    PNodeLeftmostLexEntry(x))) {
       return(0);
     }
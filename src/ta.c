@@ -12,6 +12,7 @@
  * 19950209: TA_Scan
  * 19950726: TA_Product
  * 19950802: TA_Product redone
+ * 20261018T050000: TA_ScanAnywhere in one pass
  *
  * todo:
  * - Parse and generate numbers: "fifty five" <=> 55, "42nd", "82me".
@@ -215,9 +216,9 @@ Bool TA_DualValueRangeName1(char *phrase, Obj *class, HashTable *ht,
  */
 Bool TA_FilterOut(Obj *obj, char *feat)
 {
-  return((!FeatureTaskOK(feat, N("parse"))) ||
-         ISA(N("title"), obj) ||
-         ISA(N("human-name"), obj));
+  return((!FeatureTaskOK(feat, N_parse)) ||
+         ISA(N_title, obj) ||
+         ISA(N_human_name, obj));
   /* Was || (ObjIsConcrete(obj) && ISA(N("media-object"), obj))
    * but PNodeListOverrideLower(ch->pnf, PNTYPE_MEDIA_OBJ)
    * should do the trick and also not have the problem of eliminating
@@ -418,44 +419,80 @@ void TA_ScanWordBegin(Channel *ch, Discourse *dc)
   }
 }
 
-void TA_ScanAnywhere(Channel *ch, Discourse *dc)
+/* Recognizers of TA_ScanAnywhere, in the order they are tried. */
+#define TASCAN_MEDIAOBJ		0
+#define TASCAN_PRICE		1
+#define TASCAN_TELNO		2
+#define TASCAN_STARRATING	3
+#define TASCAN_COMMUNICON	4
+#define TASCAN_FRENCHPOLITY	5
+#define TASCAN_NUM		6
+
+/* For each character, the recognizers which can match starting with it. */
+int	TA_ScanTriggers[256];
+
+void TA_ScanInit()
 {
-  char	*p, *rest;
-  for (p = (char *)ch->buf; *p; ) {
-    if (TA_MediaObject(p, (char *)ch->buf, dc, ch, &rest)) p = rest;
-    else p++;
-  }
-  for (p = (char *)ch->buf; *p; ) {
-    if (TA_Price(p, (char *)ch->buf, dc, ch, &rest)) p = rest;
-    else p++;
-  }
-  for (p = (char *)ch->buf; *p; ) {
-    if (TA_Telno(p, dc, ch, &rest)) p = rest;
-    else p++;
-  }
-/* MRBEGIN */
-  for (p = (char *)ch->buf; *p; ) {
-    if (TA_StarRating(p, dc, ch, &rest)) p = rest;
-    else p++;
+  int	c, t;
+  for (c = 0; c < 256; c++) {
+    t = 0;
+    if (CharIsOpening(c) && c != SQUOTE) t |= 1 << TASCAN_MEDIAOBJ;
+    if (c == '$') t |= 1 << TASCAN_PRICE;
+    if (Char_isdigit(c) || c == LPAREN || c == '+') t |= 1 << TASCAN_TELNO;
+    if (StringIn(c, "RA1*")) t |= 1 << TASCAN_STARRATING;
+    if (StringIn(c, ":8;<(-")) t |= 1 << TASCAN_COMMUNICON;
+    if (c == '-' || CharIsLower(c) || CharIsUpper(c)) {
+      t |= 1 << TASCAN_FRENCHPOLITY;
+    }
+    TA_ScanTriggers[c] = t;
   }
-/* MREND */
-#ifdef TASLOW
-  /* This is very slow. */
-  for (p = (char *)ch->buf; *p; ) {
-    if (TA_Communicon(p, dc, ch, &rest)) p = rest;
-    else p++;
+}
+
+Bool TA_ScanAnywhere1(int i, char *in, char *in_base, Discourse *dc,
+                      /* RESULTS */ Channel *ch, char **nextp)
+{
+  switch (i) {
+    case TASCAN_MEDIAOBJ:
+      return(TA_MediaObject(in, in_base, dc, ch, nextp));
+    case TASCAN_PRICE:
+      return(TA_Price(in, in_base, dc, ch, nextp));
+    case TASCAN_TELNO:
+      return(TA_Telno(in, dc, ch, nextp));
+    case TASCAN_STARRATING:	/* MR */
+      return(TA_StarRating(in, dc, ch, nextp));
+    case TASCAN_COMMUNICON:
+      return(TA_Communicon(in, dc, ch, nextp));
+    case TASCAN_FRENCHPOLITY:
+      return(TA_FrenchPolity(in, dc, ch, nextp));
+    default:
+      break;
   }
-#endif
+  return(0);
+}
+
+/* Makes a single pass over <ch>, trying at each character only the
+ * recognizers which can match starting with it. Each recognizer resumes
+ * after its own last match, as if it had a pass of its own.
+ */
+void TA_ScanAnywhere(Channel *ch, Discourse *dc)
+{
+  int	i, on, t;
+  char	*p, *rest, *base, *next[TASCAN_NUM];
+  base = (char *)ch->buf;
+  on = (1 << TASCAN_NUM) - 1;
 #ifndef TASLOW
-  if (DC(dc).lang == F_FRENCH) {
+  if (DC(dc).lang != F_FRENCH) on &= ~(1 << TASCAN_FRENCHPOLITY);
 #endif
-    for (p = (char *)ch->buf; *p; ) {
-      if (TA_FrenchPolity(p, dc, ch, &rest)) p = rest;
-      else p++;
+  for (i = 0; i < TASCAN_NUM; i++) next[i] = base;
+  for (p = base; *p; p++) {
+    if (!(t = TA_ScanTriggers[*((uc *)p)] & on)) continue;
+    for (i = 0; i < TASCAN_NUM; i++) {
+      if ((t & (1 << i)) && p >= next[i] &&
+          TA_ScanAnywhere1(i, p, base, dc, ch, &rest)) {
+        next[i] = rest;
+      }
     }
-#ifndef TASLOW
   }
-#endif
 }
 
 /* "8 o'clock" "5 seconds" */
@@ -571,11 +608,8 @@ void TA_Scan(Channel *ch, Discourse *dc)
 
   TA_EmailProcessPostHeaders(ch);
 
-  /* todo: Optional. */
   if (DC(dc).lang == F_ENGLISH) {
-/*
-    TA_TaggerPrune(ch);
- */
+    TA_TaggerPrune(ch);	/* if a tagger model was loaded (tt -T) */
   }
 
   if (DbgOn(DBGGEN, DBGDETAIL)) {
@@ -19,6 +19,8 @@ Obj *TA_FindNearbyClassClue(char *start, char *end, char *base, Obj *superclass,
 Bool TA_StartLineArticle(char *in, Discourse *dc, Channel *ch, char **nextp);
 void TA_ScanLineBegin(Channel *ch, Discourse *dc);
 void TA_ScanWordBegin(Channel *ch, Discourse *dc);
+void TA_ScanInit(void);
+Bool TA_ScanAnywhere1(int i, char *in, char *in_base, Discourse *dc, Channel *ch, char **nextp);
 void TA_ScanAnywhere(Channel *ch, Discourse *dc);
 void TA_ScanPNodePatterns1(Channel *ch, Discourse *dc);
 void TA_ScanPNodePatterns2(Channel *ch, Discourse *dc);
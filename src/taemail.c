@@ -1516,6 +1516,11 @@ Bool TA_Communicon(char *in, Discourse *dc,
   } else {
     speaker = ObjWild;
   }
+  if (DCLISTENERS(dc)) {
+    listener = DCLISTENERS(dc)->obj;
+  } else {
+    listener = ObjWild;
+  }
   if (StringHeadEqualAdvance(":-)", in, &in)) {
     con = L(N("smile"), speaker, E);
   } else if (StringHeadEqualAdvance("8-)", in, &in)) {
@@ -6,6 +6,7 @@
  * Words and phrases.
  *
  * 19981022T081913: minor mods
+ * 20261018T040000: phrases found in one pass using the prefix index
  */
 
 #include "tt.h"
@@ -181,10 +182,86 @@ Bool TA_LexEntry1(char *phrase, char *postpunc, char *p,
   return(found);
 }
 
+void TA_LexEntry2(char *phrase, char *postpunc, char *p, char *rest,
+                  int prev, HashTable *ht, Channel *ch, Discourse *dc,
+                  int nofail)
+{
+  int	mods;
+  if (!TA_LexEntry1(phrase, postpunc, p, rest, prev, ht, ch, dc, nofail)) {
+    /* todo: Inelegant. This is required to deal with "." at end of
+     * sentence. This may eliminate needed dots. A better solution
+     * is to eliminate dots specifically where EOS is detected.
+     */
+    StringElims(phrase, LE_NONWHITESPACE, &mods);
+    if (mods) {
+      TA_LexEntry1(phrase, postpunc, p, rest, prev, ht, ch, dc, nofail);
+    }
+  }
+}
+
+/* Looks up the phrases of 1 to <max_words> words starting at <p>. */
+void TA_LexEntryEachLength(char *p, int prev, int max_words, HashTable *ht,
+                           Channel *ch, Discourse *dc)
+{
+  int	numwords;
+  char	*rest, phrase[PHRASELEN], postpunc[PUNCLEN];
+  for (numwords = 1; numwords <= max_words; numwords++) {
+    if (StringGetNWords_LeNonwhite(phrase, postpunc, p, PHRASELEN, numwords,
+                                   &rest)) {
+      TA_LexEntry2(phrase, postpunc, p, rest, prev, ht, ch, dc,
+                   numwords == 1);
+    }
+  }
+}
+
+/* Same as TA_LexEntryEachLength, but reads the words starting at <p> once,
+ * and looks up a phrase of 2 or more words only if it is in the prefix
+ * index (cf LexEntryPrefixAppend).
+ */
+void TA_LexEntryPrefix(char *p, int prev, int max_words, HashTable *ht,
+                       Channel *ch, Discourse *dc)
+{
+  int		numwords, len, prefix_len;
+  long		flags;
+  char		*in, *word, *rest, phrase[PHRASELEN], phrase1[PHRASELEN];
+  char		prefix[PHRASELEN], postpunc[PUNCLEN];
+  HashTable	*pht;
+  pht = LexEntryPrefixIndex(ht);
+  len = prefix_len = 0;
+  in = p;
+  for (numwords = 1; numwords <= max_words; numwords++) {
+    while (*in && (!LexEntryNonwhite(*((uc *)in)))) in++;
+    word = in;
+    while (*in && LexEntryNonwhite(*((uc *)in))) in++;
+    if (*in == TERM) return;
+    if (numwords > 1) {
+      if (len >= PHRASELEN-1) return;
+      phrase[len++] = SPACE;
+    }
+    if (len + (in-word) > PHRASELEN-1) return;
+    memcpy(phrase+len, word, in-word);
+    len += in-word;
+    phrase[len] = TERM;
+    if (numwords == 1) {
+      rest = StringReadWhitespace_LeNonwhite(postpunc, in, PUNCLEN);
+      StringCpy(phrase1, phrase, PHRASELEN);
+      TA_LexEntry2(phrase1, postpunc, p, rest, prev, ht, ch, dc, 1);
+    }
+    if (!LexEntryPrefixAppend(prefix, &prefix_len, word, in-word)) return;
+    flags = (long)HashTableGet(pht, prefix);
+    if (numwords > 1 && (flags & LEPREFIX_PHRASE)) {
+      rest = StringReadWhitespace_LeNonwhite(postpunc, in, PUNCLEN);
+      StringCpy(phrase1, phrase, PHRASELEN);
+      TA_LexEntry2(phrase1, postpunc, p, rest, prev, ht, ch, dc, 0);
+    }
+    if (!(flags & LEPREFIX_WORDS)) return;
+  }
+}
+
 void TA_LexEntry(Channel *ch, Discourse *dc)
 {
-  int		numwords, cur, prev, mods, max_words;
-  char		*p, *rest, phrase[PHRASELEN], postpunc[PUNCLEN];
+  int		cur, prev, max_words;
+  char		*p;
   HashTable	*ht;
   ht = DC(dc).ht;
   prev = TERM;
@@ -197,22 +274,13 @@ void TA_LexEntry(Channel *ch, Discourse *dc)
     cur = *((uc *)p);
     if (LexEntryNonwhite(cur) && (!LexEntryNonwhite(prev))) {
     /* At start of word/phrase. */
-      for (numwords = 1; numwords <= max_words; numwords++) {
-        if (StringGetNWords_LeNonwhite(phrase, postpunc, p, PHRASELEN, numwords,
-                                       &rest)) {
-          if (!TA_LexEntry1(phrase, postpunc, p, rest, prev, ht, ch, dc,
-                            numwords == 1)) {
-            /* todo: Inelegant. This is required to deal with "." at end of
-             * sentence. This may eliminate needed dots. A better solution
-             * is to eliminate dots specifically where EOS is detected.
-             */
-            StringElims(phrase, LE_NONWHITESPACE, &mods);
-            if (mods) {
-              TA_LexEntry1(phrase, postpunc, p, rest, prev, ht, ch, dc,
-                           numwords == 1);
-            }
-          }
-        }
+      if (SpellIndex) {
+      /* Spelling relaxation can match a phrase to an entry with other
+       * word boundaries.
+       */
+        TA_LexEntryEachLength(p, prev, max_words, ht, ch, dc);
+      } else {
+        TA_LexEntryPrefix(p, prev, max_words, ht, ch, dc);
       }
     }
     prev = cur;
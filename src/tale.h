@@ -3,6 +3,9 @@ void TA_LELAdd(LexEntry *le, char *features, int maxlen, LexEntry **le_le, char
 void FeatSubstPOS(char *in, int newpos, char *out);
 void TA_LexEntryEnter(Channel *ch, IndexEntry *ie, int prepunc, char *postpunc, char *phrase, char *begin, char *rest, HashTable *ht);
 Bool TA_LexEntry1(char *phrase, char *postpunc, char *p, char *rest, int prev, HashTable *ht, Channel *ch, Discourse *dc, int nofail);
+void TA_LexEntry2(char *phrase, char *postpunc, char *p, char *rest, int prev, HashTable *ht, Channel *ch, Discourse *dc, int nofail);
+void TA_LexEntryEachLength(char *p, int prev, int max_words, HashTable *ht, Channel *ch, Discourse *dc);
+void TA_LexEntryPrefix(char *p, int prev, int max_words, HashTable *ht, Channel *ch, Discourse *dc);
 void TA_LexEntry(Channel *ch, Discourse *dc);
 void TA_EndOfSentence(Channel *ch, Discourse *dc);
 Bool TA_BlankLine(char *in, Channel *ch, char **nextp);
@@ -3,11 +3,11 @@
  * Copyright 1996, 1997, 1998, 1999, 2015 Erik Thomas Mueller.
  * All Rights Reserved.
  *
- * Prune parse nodes by calling an external Penn Treebank compatible
- * part-of-speech tagger.
+ * Prune parse nodes using a Penn Treebank compatible part-of-speech tagger.
  *
  * 19960201: begun
  * 19960202: more work
+ * 20261018T060000: Brill tagger run in-process instead of ./tagger
  *
  * Approximate Penn Treebank to ThoughtTreasure correspondences:
  * 
@@ -77,6 +77,126 @@
 #include "utildbg.h"
 #include "utillrn.h"
 
+/* Tagger model, loaded once by TA_TaggerInit. */
+
+char		*TaggerModelDir;
+HashTable	*TaggerLexicon;	/* word -> tags, most likely first */
+HashTable	*TaggerTags;
+TaggerRule	*TaggerRules;
+long		TaggerNumRules;
+
+/* Names of contextual rule templates, indexed by TAGGER_PREVTAG ... */
+char *TaggerTemplates[] = {
+  "",
+  "PREVTAG", "NEXTTAG", "PREV2TAG", "NEXT2TAG", "PREV1OR2TAG", "NEXT1OR2TAG",
+  "PREV1OR2OR3TAG", "NEXT1OR2OR3TAG", "SURROUNDTAG", "PREVBIGRAM",
+  "NEXTBIGRAM", "CURWD", "PREVWD", "NEXTWD", "PREV2WD", "NEXT2WD",
+  "PREV1OR2WD", "NEXT1OR2WD", "WDPREVTAG", "WDNEXTTAG", "WDAND2BFR",
+  "WDAND2AFT", "WDAND2TAGBFR", "WDAND2TAGAFT", "LBIGRAM", "RBIGRAM", NULL
+};
+
+/* Interns Penn Treebank tags so they can be compared as pointers. */
+char *TaggerTag(char *tag)
+{
+  return(HashTableIntern(TaggerTags, tag));
+}
+
+/* Returns the TAGGER_ code of the template named <name>, or 0. */
+int TaggerTemplateCode(char *name)
+{
+  int	i;
+  for (i = 1; TaggerTemplates[i]; i++) {
+    if (streq(TaggerTemplates[i], name)) return(i);
+  }
+  return(0);
+}
+
+Bool TA_TaggerLoadLexicon(char *fn)
+{
+  char	line[LINELEN], word[PHRASELEN], *p;
+  FILE	*stream;
+  if (NULL == (stream = StreamOpen(fn, "r"))) return(0);
+  while (fgets(line, LINELEN, stream)) {
+    StringElims(line, "\r\n", NULL);
+    StringElimTrailingBlanks(line);
+    for (p = line; *p && *p != SPACE; p++);
+    if (*p == TERM || p == line || p - line >= PHRASELEN) continue;
+    memcpy(word, line, p - line);
+    word[p - line] = TERM;
+    HashTableSetDup(TaggerLexicon, word, StringCopy(p + 1, "char Tagger"));
+  }
+  StreamClose(stream);
+  return(1);
+}
+
+Bool TA_TaggerLoadRules(char *fn)
+{
+  int		n, template;
+  long		maxrules;
+  char		line[LINELEN], f[5][PHRASELEN];
+  FILE		*stream;
+  TaggerRule	*r;
+  if (NULL == (stream = StreamOpen(fn, "r"))) return(0);
+  maxrules = 256L;
+  TaggerRules = (TaggerRule *)MemAlloc(maxrules*sizeof(TaggerRule),
+                                       "TaggerRule");
+  TaggerNumRules = 0L;
+  while (fgets(line, LINELEN, stream)) {
+    f[3][0] = f[4][0] = TERM;
+    n = sscanf(line, "%127s %127s %127s %127s %127s", f[0], f[1], f[2], f[3],
+               f[4]);
+    if (n < 4) continue;
+    if (0 == (template = TaggerTemplateCode(f[2]))) {
+      Dbg(DBGGEN, DBGBAD, "tagger rule template <%s> unknown", f[2]);
+      continue;
+    }
+    if (TaggerNumRules >= maxrules) {
+      maxrules = maxrules*2;
+      TaggerRules = (TaggerRule *)MemRealloc(TaggerRules,
+                                             maxrules*sizeof(TaggerRule),
+                                             "TaggerRule");
+    }
+    r = &TaggerRules[TaggerNumRules++];
+    r->from = TaggerTag(f[0]);
+    r->to = TaggerTag(f[1]);
+    r->template = template;
+    r->arg1 = TaggerTag(f[3]);
+    r->arg2 = TaggerTag(f[4]);
+  }
+  StreamClose(stream);
+  return(1);
+}
+
+/* Loads the lexicon and contextual rules of a Brill tagger from
+ * <TaggerModelDir> (cf tt -T), as found in its Bin_and_Data directory.
+ */
+void TA_TaggerInit()
+{
+  char	fn[FILENAMELEN];
+  TaggerLexicon = NULL;
+  TaggerRules = NULL;
+  TaggerNumRules = 0L;
+  if (TaggerModelDir == NULL) return;
+  /* CONTEXTUALRULEFILE.BROWN is the longer of the two file names. */
+  if (snprintf(fn, FILENAMELEN, "%s/CONTEXTUALRULEFILE.BROWN",
+               TaggerModelDir) >= FILENAMELEN) {
+    Dbg(DBGGEN, DBGBAD, "tagger model directory <%s> too long",
+        TaggerModelDir);
+    return;
+  }
+  TaggerLexicon = HashTableCreate(10037L, "TaggerLexicon");
+  TaggerTags = HashTableCreate(101L, "TaggerTags");
+  snprintf(fn, FILENAMELEN, "%s/LEXICON.BROWN", TaggerModelDir);
+  if (!TA_TaggerLoadLexicon(fn)) {
+    TaggerLexicon = NULL;
+    return;
+  }
+  snprintf(fn, FILENAMELEN, "%s/CONTEXTUALRULEFILE.BROWN", TaggerModelDir);
+  TA_TaggerLoadRules(fn);
+  Dbg(DBGGEN, DBGOK, "tagger: %ld words, %ld rules", TaggerLexicon->count,
+      TaggerNumRules);
+}
+
 TaggerWords *TaggerWordsCreate()
 {
   TaggerWords	*tw;
@@ -87,16 +207,31 @@ TaggerWords *TaggerWordsCreate()
     (size_t *)MemAlloc(tw->maxlen*sizeof(size_t), "TaggerWords* positions");
   tw->firstchars =
     (char *)MemAlloc(tw->maxlen*sizeof(char), "TaggerWords* firstchars");
+  tw->words =
+    (char **)MemAlloc(tw->maxlen*sizeof(char *), "TaggerWords* words");
+  tw->tags =
+    (char **)MemAlloc(tw->maxlen*sizeof(char *), "TaggerWords* tags");
+  tw->guessed =
+    (Bool *)MemAlloc(tw->maxlen*sizeof(Bool), "TaggerWords* guessed");
   return(tw);
 }
 
 void TaggerWordsFree(TaggerWords *tw)
 {
+  long	i;
+  for (i = 0; i < tw->len; i++) {
+    MemFree(tw->words[i], "char TaggerWords");
+  }
   MemFree(tw->positions, "TaggerWords* positions");
+  MemFree(tw->firstchars, "TaggerWords* firstchars");
+  MemFree(tw->words, "TaggerWords* words");
+  MemFree(tw->tags, "TaggerWords* tags");
+  MemFree(tw->guessed, "TaggerWords* guessed");
   MemFree(tw, "TaggerWords");
 }
 
-void TaggerWordsAdd(TaggerWords *tw, size_t position, int firstchar)
+void TaggerWordsAdd(TaggerWords *tw, size_t position, int firstchar,
+                    char *word)
 {
   if (tw->len >= tw->maxlen) {
     tw->maxlen = tw->maxlen*2;
@@ -106,92 +241,242 @@ void TaggerWordsAdd(TaggerWords *tw, size_t position, int firstchar)
     tw->firstchars = (char *)MemRealloc(tw->firstchars,
                                         tw->maxlen*sizeof(char),
                                         "TaggerWords* firstchars");
+    tw->words = (char **)MemRealloc(tw->words, tw->maxlen*sizeof(char *),
+                                    "TaggerWords* words");
+    tw->tags = (char **)MemRealloc(tw->tags, tw->maxlen*sizeof(char *),
+                                   "TaggerWords* tags");
+    tw->guessed = (Bool *)MemRealloc(tw->guessed, tw->maxlen*sizeof(Bool),
+                                     "TaggerWords* guessed");
   }
   tw->positions[tw->len] = position;
   tw->firstchars[tw->len] = firstchar;
+  tw->words[tw->len] = StringCopy(word, "char TaggerWords");
+  tw->tags[tw->len] = NULL;
+  tw->guessed[tw->len] = 0;
   tw->len++;
 }
 
-void TA_TaggerWriteSentence(FILE *stream, TaggerWords *tw, Channel *ch,
-                            size_t lowerb, size_t upperb, int eoschar)
+/* Adds the tokens of a sentence of <ch> to <tw>, splitting them as Penn
+ * Treebank does. A comma is a token of its own.
+ */
+void TA_TaggerAddSentence(TaggerWords *tw, Channel *ch, size_t lowerb,
+                          size_t upperb, int eoschar)
 {
-  int		c, prev, inword, first;
-  size_t        pos;
+  int		c, prev, len;
+  char		word[PHRASELEN], eos[2];
+  size_t        pos, wordpos;
   prev = TERM;
-  inword = 0;
-  first = 1;
-  for (pos = lowerb; pos <= upperb; pos++) {
+  len = 0;
+  wordpos = lowerb;
+  for (pos = lowerb; pos < upperb; pos++) {
     c = *(((char *)ch->buf) + pos);
     if (LexEntryNonwhite(c)) {
-      if (!inword) {
-        if (first) {
-          first = 0;
-        } else {
-          fputc(' ', stream);
-        }
-        if (prev == '\'') fputc(prev, stream);
-        inword = 1;
-        TaggerWordsAdd(tw, pos, c);
+      if (len == 0) {
+        if (prev == '\'') word[len++] = prev;
+        wordpos = pos;
       }
-      fputc(c, stream);
+      if (len < PHRASELEN-1) word[len++] = c;
     } else {
-      inword = 0;
-      if (c == ',') fputs(" ,", stream);
+      if (len > 0) {
+        word[len] = TERM;
+        TaggerWordsAdd(tw, wordpos, word[0] == '\'' ? word[1] : word[0],
+                       word);
+        len = 0;
+      }
+      if (c == ',') TaggerWordsAdd(tw, pos, c, ",");
     }
     prev = c;
   }
-  fputc(' ', stream);
-  fputc(eoschar, stream);
-  TaggerWordsAdd(tw, pos, eoschar);
-  fputc(NEWLINE, stream);
+  if (len > 0) {
+    word[len] = TERM;
+    TaggerWordsAdd(tw, wordpos, word[0] == '\'' ? word[1] : word[0], word);
+  }
+  eos[0] = eoschar;
+  eos[1] = TERM;
+  TaggerWordsAdd(tw, upperb+1, eoschar, eos);
+}
+
+/* Tag of word <i> of the sentence <first> to <last> of <tw>, or the
+ * sentence boundary.
+ */
+char *TaggerTagAt(TaggerWords *tw, long first, long last, long i)
+{
+  if (i < first || i >= last) return(TaggerTag("STAART"));
+  return(tw->tags[i]);
+}
+
+char *TaggerWordAt(TaggerWords *tw, long first, long last, long i)
+{
+  if (i < first || i >= last) return("STAART");
+  return(tw->words[i]);
+}
+
+Bool TaggerLexiconHas(char *tags, char *tag)
+{
+  int	len;
+  len = strlen(tag);
+  while (*tags) {
+    if (0 == strncmp(tags, tag, len) &&
+        (tags[len] == SPACE || tags[len] == TERM)) {
+      return(1);
+    }
+    while (*tags && *tags != SPACE) tags++;
+    while (*tags == SPACE) tags++;
+  }
+  return(0);
 }
 
-int TA_TaggerWriteInput(char *fn, TaggerWords *tw, Channel *ch)
+/* Lexicon entry of word <i>, trying a sentence-initial word in lower case
+ * too.
+ */
+char *TaggerLexiconGet(TaggerWords *tw, long first, long i)
+{
+  char	*tags, buf[PHRASELEN];
+  if ((tags = (char *)HashTableGet(TaggerLexicon, tw->words[i]))) {
+    return(tags);
+  }
+  if (i != first) return(NULL);
+  StringToLower(tw->words[i], PHRASELEN, buf);
+  return((char *)HashTableGet(TaggerLexicon, buf));
+}
+
+/* Initial tag of an unknown word. */
+char *TaggerTagUnknown(char *word)
+{
+  if (Char_isdigit(*((uc *)word))) return(TaggerTag("CD"));
+  if (CharIsUpper(*((uc *)word))) return(TaggerTag("NNP"));
+  return(TaggerTag("NN"));
+}
+
+Bool TaggerRuleMatch(TaggerRule *r, TaggerWords *tw, long first, long last,
+                     long i)
+{
+#define TAG(j)	TaggerTagAt(tw, first, last, i+(j))
+#define WD(j)	TaggerWordAt(tw, first, last, i+(j))
+  switch (r->template) {
+    case TAGGER_PREVTAG:
+      return(TAG(-1) == r->arg1);
+    case TAGGER_NEXTTAG:
+      return(TAG(1) == r->arg1);
+    case TAGGER_PREV2TAG:
+      return(TAG(-2) == r->arg1);
+    case TAGGER_NEXT2TAG:
+      return(TAG(2) == r->arg1);
+    case TAGGER_PREV1OR2TAG:
+      return(TAG(-1) == r->arg1 || TAG(-2) == r->arg1);
+    case TAGGER_NEXT1OR2TAG:
+      return(TAG(1) == r->arg1 || TAG(2) == r->arg1);
+    case TAGGER_PREV1OR2OR3TAG:
+      return(TAG(-1) == r->arg1 || TAG(-2) == r->arg1 || TAG(-3) == r->arg1);
+    case TAGGER_NEXT1OR2OR3TAG:
+      return(TAG(1) == r->arg1 || TAG(2) == r->arg1 || TAG(3) == r->arg1);
+    case TAGGER_SURROUNDTAG:
+      return(TAG(-1) == r->arg1 && TAG(1) == r->arg2);
+    case TAGGER_PREVBIGRAM:
+      return(TAG(-2) == r->arg1 && TAG(-1) == r->arg2);
+    case TAGGER_NEXTBIGRAM:
+      return(TAG(1) == r->arg1 && TAG(2) == r->arg2);
+    case TAGGER_CURWD:
+      return(streq(WD(0), r->arg1));
+    case TAGGER_PREVWD:
+      return(streq(WD(-1), r->arg1));
+    case TAGGER_NEXTWD:
+      return(streq(WD(1), r->arg1));
+    case TAGGER_PREV2WD:
+      return(streq(WD(-2), r->arg1));
+    case TAGGER_NEXT2WD:
+      return(streq(WD(2), r->arg1));
+    case TAGGER_PREV1OR2WD:
+      return(streq(WD(-1), r->arg1) || streq(WD(-2), r->arg1));
+    case TAGGER_NEXT1OR2WD:
+      return(streq(WD(1), r->arg1) || streq(WD(2), r->arg1));
+    case TAGGER_WDPREVTAG:
+      return(TAG(-1) == r->arg1 && streq(WD(0), r->arg2));
+    case TAGGER_WDNEXTTAG:
+      return(streq(WD(0), r->arg1) && TAG(1) == r->arg2);
+    case TAGGER_WDAND2BFR:
+      return(streq(WD(-2), r->arg1) && streq(WD(0), r->arg2));
+    case TAGGER_WDAND2AFT:
+      return(streq(WD(0), r->arg1) && streq(WD(2), r->arg2));
+    case TAGGER_WDAND2TAGBFR:
+      return(TAG(-2) == r->arg1 && streq(WD(0), r->arg2));
+    case TAGGER_WDAND2TAGAFT:
+      return(streq(WD(0), r->arg1) && TAG(2) == r->arg2);
+    case TAGGER_LBIGRAM:
+      return(streq(WD(-1), r->arg1) && streq(WD(0), r->arg2));
+    case TAGGER_RBIGRAM:
+      return(streq(WD(0), r->arg1) && streq(WD(1), r->arg2));
+    default:
+      return(0);
+  }
+#undef TAG
+#undef WD
+}
+
+/* Tags the sentence <first> to <last> of <tw>: each word gets its most
+ * likely tag, then the contextual rules are applied in order. As in the
+ * Brill tagger, a rule only changes the tag of a known word to one of
+ * the tags it has in the lexicon. The tag of a word missing from the
+ * lexicon is marked as guessed, since the lexical rules that would
+ * refine it are not implemented.
+ */
+void TA_TaggerTagSentence(TaggerWords *tw, long first, long last)
+{
+  long		i, j;
+  char		*tags, buf[PHRASELEN];
+  TaggerRule	*r;
+  for (i = first; i < last; i++) {
+    if (streq(tw->words[i], ",")) {
+      tw->tags[i] = TaggerTag(",");
+    } else if (i == last-1) {
+      tw->tags[i] = TaggerTag(".");
+    } else if ((tags = TaggerLexiconGet(tw, first, i))) {
+      StringCpy(buf, tags, PHRASELEN);
+      for (j = 0; buf[j] && buf[j] != SPACE; j++);
+      buf[j] = TERM;
+      tw->tags[i] = TaggerTag(buf);
+    } else {
+      tw->tags[i] = TaggerTagUnknown(tw->words[i]);
+      tw->guessed[i] = 1;
+    }
+  }
+  for (j = 0; j < TaggerNumRules; j++) {
+    r = &TaggerRules[j];
+    for (i = first; i < last-1; i++) {
+      if (tw->tags[i] != r->from) continue;
+      if ((tags = TaggerLexiconGet(tw, first, i)) &&
+          !TaggerLexiconHas(tags, r->to)) {
+        continue;
+      }
+      if (TaggerRuleMatch(r, tw, first, last, i)) tw->tags[i] = r->to;
+    }
+  }
+}
+
+/* Adds the sentences of <ch> to <tw> and tags them. */
+void TA_TaggerTag(TaggerWords *tw, Channel *ch)
 {
   int		eoschar;
+  long		first;
   size_t	pos;
   PNode		*pn;
-  FILE		*stream;
-
-  if (NULL == (stream = StreamOpen(fn, "w+"))) {
-    return(0);
-  }
   pos = 0;
   pn = ch->pnf->first;
   while (pos < ch->len) {
     if (NULL == (pn = PNodeGetNext(pn, pos))) break;
     if (pn->type == PNTYPE_END_OF_SENT) {
       eoschar = ch->buf[pn->lowerb];
-      TA_TaggerWriteSentence(stream, tw, ch, pos, pn->lowerb, eoschar);
+      first = tw->len;
+      TA_TaggerAddSentence(tw, ch, pos, pn->lowerb, eoschar);
+      TA_TaggerTagSentence(tw, first, tw->len);
     }
     pos = pn->upperb+1;
   }
-  StreamClose(stream);
-  return(1);
-}
-
-int TA_TaggedWordRead(FILE *stream, /* RESULTS */ char *word, char *tag)
-{
-  int   c, pos;
-  pos = 0;
-  while (('/' != (c = getc(stream))) && (c != EOF)) {
-    if (c == NEWLINE) continue;
-    word[pos++] = c;
-  }
-  if (c == EOF) return(0);
-  word[pos] = TERM;
-  pos = 0;
-  while (' ' != (c = getc(stream))) {
-    tag[pos++] = c;
-  }
-  tag[pos] = TERM;
-  return(1);
 }
 
-
 int PennIsPunct(char *tag)
 {
-  return(streq(tag, ":") || streq(tag, "."));
+  return(streq(tag, ":") || streq(tag, ".") || streq(tag, ","));
 }
 
 /* Only returns a non-F_NULL part of speech when it is unambiguous.
@@ -382,84 +667,52 @@ void TA_TaggerPrune2(PNode *pn, PNode *prev, int dosplice, size_t pos,
   if (r_spliced) *r_spliced = spliced;
 }
 
-int TA_TaggerPrune1(char *fn, TaggerWords *tw, Channel *ch)
+void TA_TaggerPrune1(TaggerWords *tw, Channel *ch)
 {
   int		cnt, spliced;
   long		wordnum;
-  char		word[PHRASELEN], tag[FEATLEN];
   size_t	pos;
   int		firstchar;
-  FILE		*stream;
   PNode		*pn, *prev;
 
-  if (NULL == (stream = StreamOpen(fn, "r"))) {
-    return(0);
-  }
-  wordnum = 0L;
   pn = ch->pnf->first;
   prev = NULL;
-  while (pn) {
-    if (!TA_TaggedWordRead(stream, word, tag)) break;
-    Dbg(DBGGEN, DBGHYPER, "<%s>.<%s>", word, tag);
-    if (wordnum >= tw->len) {
-      Dbg(DBGGEN, DBGBAD, "TA_TaggerPrune1 length mismatch");
-      break;
-    }
-    if (!PennIsPunct(tag)) {
+  for (wordnum = 0L; pn && wordnum < tw->len; wordnum++) {
+    Dbg(DBGGEN, DBGHYPER, "<%s>.<%s>", tw->words[wordnum], tw->tags[wordnum]);
+    /* A guessed tag is not trusted to rule out readings. */
+    if (!PennIsPunct(tw->tags[wordnum]) && !tw->guessed[wordnum]) {
       pos = tw->positions[wordnum];
       firstchar = tw->firstchars[wordnum];
-      TA_TaggerPrune2(pn, prev, 0, pos, firstchar, ch, word, tag, NULL, NULL,
-                      &cnt, &spliced);
+      TA_TaggerPrune2(pn, prev, 0, pos, firstchar, ch, tw->words[wordnum],
+                      tw->tags[wordnum], NULL, NULL, &cnt, &spliced);
       if ((spliced > 0) &&
           (spliced < cnt) && /* Don't rule out all words. */
           (cnt > 1)) { /* Don't rule out the only instance of a word. */
-        TA_TaggerPrune2(pn, prev, 1, pos, firstchar, ch, word, tag, &pn, &prev,
-                        NULL, NULL);
+        TA_TaggerPrune2(pn, prev, 1, pos, firstchar, ch, tw->words[wordnum],
+                        tw->tags[wordnum], &pn, &prev, NULL, NULL);
       }
     }
-    wordnum++;
   }
-
-  StreamClose(stream);
-  return(1);
 }
 
-/* Top-level function of this file. */
+/* Top-level function of this file. Does nothing unless a tagger model
+ * was loaded.
+ */
 void TA_TaggerPrune(Channel *ch)
 {
   TaggerWords	*tw;
-  char		infn[FILENAMELEN], outfn[FILENAMELEN], cmd[96];
 
+  if (TaggerLexicon == NULL) return;
   Dbg(DBGGEN, DBGDETAIL, "TAGGER PRUNE BEGIN");
 
   tw = TaggerWordsCreate();
 
-  FileTemp("/tmp/Tag.In", FILENAMELEN, infn);
-  FileTemp("/tmp/Tag.Out", FILENAMELEN, outfn);
-
-  /* (1) Write all tokens in <ch->buf> to file in Penn Treebank format. */
-  if (!TA_TaggerWriteInput(infn, tw, ch)) {
-    goto done1;
-  }
-
-  /* (2) Run the tagger. */
-  sprintf(cmd, "./tagger %s %s", infn, outfn);
-  Dbg(DBGGEN, DBGDETAIL, "invoking: %s", cmd);
-  if (0 > system(cmd)) {
-    Dbg(DBGGEN, DBGBAD, "system: <%s> failed", cmd);
-    goto done;
-  }
-  Dbg(DBGGEN, DBGDETAIL, "done running: %s", cmd);
+  /* (1) Tag all tokens in <ch->buf>. */
+  TA_TaggerTag(tw, ch);
 
-  /* (3) Use the output of the tagger to prune <ch->pnf> */
-  if (!TA_TaggerPrune1(outfn, tw, ch)) {
-    goto done;
-  }
+  /* (2) Use the tags to prune <ch->pnf>. */
+  TA_TaggerPrune1(tw, ch);
 
-done:
-  unlink(infn);
-  unlink(outfn);
-done1:
   TaggerWordsFree(tw);
 
   Dbg(DBGGEN, DBGDETAIL, "TAGGER PRUNE END");
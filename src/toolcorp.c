@@ -7,6 +7,7 @@
  * 19950122: more work -- gender induction
  * 19950505: added word duplication indexing (under word "dupdup").
  * 19951023: added adverbial finder
+ * 20261018T080000: persistent directory index
  */
 
 #include "tt.h"
@@ -32,7 +33,13 @@ Corpus *CorpusCreate()
 {
   Corpus	*corpus;
   corpus = CREATE(Corpus);
-  corpus->ht = HashTableCreate(30021L);
+  corpus->ht = HashTableCreate(30021L, "Corpus");
+  corpus->maxarticles = 64L;
+  corpus->articles = (Article **)MemAlloc(corpus->maxarticles*
+                                          sizeof(Article *),
+                                          "Article* Corpus");
+  corpus->numarticles = 0;
+  corpus->idxs = NULL;
   return(corpus);
 }
 
@@ -42,6 +49,7 @@ Article *ArticleCreate(char *filename, size_t startpos, size_t stoppos,
 {
   Article	*article;
   article = CREATE(Article);
+  article->id = -1L;
   article->filename = filename;
   article->startpos = startpos;
   article->stoppos = stoppos;
@@ -99,6 +107,15 @@ void CorpusIndexWords(Corpus *corpus, Article *article)
 
 void CorpusIndexArticle(Corpus *corpus, Article *article)
 {
+  if (corpus->numarticles >= corpus->maxarticles) {
+    corpus->maxarticles = 2L*corpus->maxarticles;
+    corpus->articles = (Article **)MemRealloc(corpus->articles,
+                                              corpus->maxarticles*
+                                              sizeof(Article *),
+                                              "Article* Corpus");
+  }
+  article->id = corpus->numarticles;
+  corpus->articles[corpus->numarticles++] = article;
   CorpusIndexWords(corpus, article);
 }
 
@@ -196,16 +213,688 @@ Bool CorpusIndexFile(Corpus *corpus, char *fn, Ts *ts0)
   return(1);
 }
 
+/* PERSISTENT INDEX
+ *
+ * corpusload -dir keeps an index of the directory in <dir>/.ttcorpus
+ * (cf CorpusIdxHeader). Only files that are new or have changed since the
+ * index was written are parsed; their postings are merged with those of
+ * the unchanged files into a new index, which is then mapped in. Article
+ * text is read from the source files as queries reach it.
+ */
+
+#define CORPUSIDXFN	".ttcorpus"
+#define CORPUSIDXMAGIC	"ttcidx1"
+
+#ifdef GCC
+#include <sys/mman.h>
+#endif
+
+Corpus *CorpusBuild;
+
+Bool CorpusIdxIsIdxFile(char *basename)
+{
+  return(StringHeadEqual(CORPUSIDXFN, basename));
+}
+
+Bool CorpusFileStat(char *fn, /* RESULTS */ long *size, long *mtime)
+{
+  struct stat	statrec;
+  if (0 > stat(fn, &statrec)) return(0);
+  *size = (long)statrec.st_size;
+  *mtime = (long)statrec.st_mtime;
+  return(1);
+}
+
+int CorpusStringCompare(const void *s1, const void *s2)
+{
+  return(strcmp(*((char **)s1), *((char **)s2)));
+}
+
+long CorpusIdxVarintPut(FILE *stream, unsigned long v)
+{
+  long	n;
+  for (n = 1; v >= 0x80; n++) {
+    putc((int)((v & 0x7f) | 0x80), stream);
+    v >>= 7;
+  }
+  putc((int)v, stream);
+  return(n);
+}
+
+unsigned long CorpusIdxVarintGet(/* RESULTS */ unsigned char **p)
+{
+  int		shift;
+  unsigned long	v;
+  v = 0;
+  for (shift = 0; **p & 0x80; shift += 7) {
+    v |= ((unsigned long)(*((*p)++) & 0x7f)) << shift;
+  }
+  v |= ((unsigned long)(*((*p)++))) << shift;
+  return(v);
+}
+
+CorpusIdx *CorpusIdxMap(char *fn)
+{
+#ifdef GCC
+  int			fd;
+  char			*p;
+  size_t		len;
+  struct stat		statrec;
+  CorpusIdx		*idx;
+  CorpusIdxHeader	*hdr;
+  if (0 > (fd = open(fn, O_RDONLY))) return(NULL);
+  if (0 > fstat(fd, &statrec) ||
+      statrec.st_size < (off_t)sizeof(CorpusIdxHeader)) {
+    close(fd);
+    return(NULL);
+  }
+  len = (size_t)statrec.st_size;
+  p = mmap(NULL, len, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (p == MAP_FAILED) {
+    Dbg(DBGGEN, DBGBAD, "CorpusIdxMap: mmap failed for <%s>", fn);
+    return(NULL);
+  }
+  hdr = (CorpusIdxHeader *)p;
+  if (0 != memcmp(hdr->magic, CORPUSIDXMAGIC, sizeof(hdr->magic)) ||
+      hdr->len != (long)len) {
+    Dbg(DBGGEN, DBGBAD, "CorpusIdxMap: <%s> is not a corpus index", fn);
+    munmap(p, len);
+    return(NULL);
+  }
+  idx = CREATE(CorpusIdx);
+  StringCpy(idx->fn, fn, FILENAMELEN);
+  idx->base = p;
+  idx->len = len;
+  idx->hdr = hdr;
+  idx->files = (CorpusIdxFile *)(p + hdr->files);
+  idx->articles = (CorpusIdxArticle *)(p + hdr->articles);
+  idx->terms = (CorpusIdxTerm *)(p + hdr->terms);
+  idx->strings = p + hdr->strings;
+  idx->loaded = (Article **)MemAlloc((1+hdr->numarticles)*sizeof(Article *),
+                                     "Article* CorpusIdx");
+  memset(idx->loaded, 0, (1+hdr->numarticles)*sizeof(Article *));
+  idx->maps = (char **)MemAlloc((1+hdr->numfiles)*sizeof(char *),
+                                "char* CorpusIdx");
+  memset(idx->maps, 0, (1+hdr->numfiles)*sizeof(char *));
+  idx->next = NULL;
+  Dbg(DBGGEN, DBGOK, "corpus index <%s>: %ld files %ld articles %ld words",
+      fn, hdr->numfiles, hdr->numarticles, hdr->numterms);
+  return(idx);
+#else
+  return(NULL);
+#endif
+}
+
+void CorpusIdxUnmap(CorpusIdx *idx)
+{
+  long		i;
+  Article	*article;
+  for (i = 0; i < idx->hdr->numarticles; i++) {
+    if ((article = idx->loaded[i])) {
+      MemFree(article->text, "char CorpusIdx");
+      MemFree(article, "Article");
+    }
+  }
+#ifdef GCC
+  for (i = 0; i < idx->hdr->numfiles; i++) {
+    if (idx->maps[i]) munmap(idx->maps[i], (size_t)idx->files[i].size);
+  }
+  munmap(idx->base, idx->len);
+#endif
+  MemFree(idx->loaded, "Article* CorpusIdx");
+  MemFree(idx->maps, "char* CorpusIdx");
+  MemFree(idx, "CorpusIdx");
+}
+
+CorpusIdxFile *CorpusIdxFileFind(CorpusIdx *idx, char *fn)
+{
+  long	lo, hi, mid;
+  int	r;
+  lo = 0;
+  hi = idx->hdr->numfiles - 1;
+  while (lo <= hi) {
+    mid = (lo + hi)/2;
+    r = strcmp(fn, idx->strings + idx->files[mid].fn);
+    if (r == 0) return(&idx->files[mid]);
+    if (r < 0) hi = mid - 1;
+    else lo = mid + 1;
+  }
+  return(NULL);
+}
+
+CorpusIdxTerm *CorpusIdxTermFind(CorpusIdx *idx, char *word)
+{
+  long	lo, hi, mid;
+  int	r;
+  lo = 0;
+  hi = idx->hdr->numterms - 1;
+  while (lo <= hi) {
+    mid = (lo + hi)/2;
+    r = strcmp(word, idx->strings + idx->terms[mid].word);
+    if (r == 0) return(&idx->terms[mid]);
+    if (r < 0) hi = mid - 1;
+    else lo = mid + 1;
+  }
+  return(NULL);
+}
+
+/* Maps source file <i> of <idx>, unless it has changed since indexing. */
+char *CorpusIdxFileMap(CorpusIdx *idx, long i)
+{
+#ifdef GCC
+  int		fd;
+  char		*fn, *p;
+  long		size, mtime;
+  if (idx->maps[i]) return(idx->maps[i]);
+  fn = idx->strings + idx->files[i].fn;
+  if ((!CorpusFileStat(fn, &size, &mtime)) ||
+      size != idx->files[i].size || mtime != idx->files[i].mtime) {
+    Dbg(DBGGEN, DBGBAD, "<%s> has changed since indexed", fn);
+    return(NULL);
+  }
+  if (size == 0) return(NULL);
+  if (0 > (fd = open(fn, O_RDONLY))) return(NULL);
+  p = mmap(NULL, (size_t)size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (p == MAP_FAILED) {
+    Dbg(DBGGEN, DBGBAD, "CorpusIdxFileMap: mmap failed for <%s>", fn);
+    return(NULL);
+  }
+  idx->maps[i] = p;
+  return(p);
+#else
+  return(NULL);
+#endif
+}
+
+Article *CorpusIdxArticleGet(CorpusIdx *idx, long id)
+{
+  char			*map, *text;
+  size_t		len;
+  Ts			ts;
+  Obj			*speaker;
+  ObjList		*speakers;
+  Article		*article;
+  CorpusIdxArticle	*ia;
+  if ((article = idx->loaded[id])) return(article);
+  ia = &idx->articles[id];
+  if (NULL == (map = CorpusIdxFileMap(idx, ia->file))) return(NULL);
+  len = (size_t)(ia->stoppos - ia->startpos);
+  text = (char *)MemAlloc(len+1, "char CorpusIdx");
+  memcpy(text, map + ia->startpos, len);
+  text[len] = TERM;
+  TsSetUnixTs(&ts, (time_t)ia->unixts);
+  ts.flag = (char)ia->flag;
+  speakers = NULL;
+  if (ia->speaker >= 0 &&
+      (speaker = NameToObj(idx->strings + ia->speaker, OBJ_NO_CREATE))) {
+    speakers = ObjListCreate(speaker, NULL);
+  }
+  article = ArticleCreate(idx->strings + idx->files[ia->file].fn,
+                          (size_t)ia->startpos, (size_t)ia->stoppos, &ts,
+                          speakers, NULL, text);
+  article->id = id;
+  idx->loaded[id] = article;
+  return(article);
+}
+
+/* Files of the new index: the kept files of <old> and the files indexed
+ * into <build>, sorted by name.
+ */
+char **CorpusIdxFilenames(CorpusIdx *old, Bool *keep, Corpus *build,
+                          /* RESULTS */ long *numfiles)
+{
+  long	i, n;
+  char	**fns, *prev;
+  n = 0;
+  if (old) {
+    for (i = 0; i < old->hdr->numfiles; i++) if (keep[i]) n++;
+  }
+  fns = (char **)MemAlloc((1+n+build->numarticles)*sizeof(char *),
+                          "char* CorpusIdxFilenames");
+  n = 0;
+  if (old) {
+    for (i = 0; i < old->hdr->numfiles; i++) {
+      if (keep[i]) fns[n++] = old->strings + old->files[i].fn;
+    }
+  }
+  prev = NULL;
+  for (i = 0; i < build->numarticles; i++) {
+    if (build->articles[i]->filename != prev) {
+      fns[n++] = prev = build->articles[i]->filename;
+    }
+  }
+  qsort(fns, (size_t)n, sizeof(char *), CorpusStringCompare);
+  *numfiles = n;
+  return(fns);
+}
+
+long CorpusIdxFilenameFind(char **fns, long numfiles, char *fn)
+{
+  char	**p;
+  p = (char **)bsearch(&fn, fns, (size_t)numfiles, sizeof(char *),
+                       CorpusStringCompare);
+  if (p == NULL) return(-1L);
+  return((long)(p - fns));
+}
+
+/* Words indexed into <build>, sorted. */
+char **CorpusBuildWords(Corpus *build, /* RESULTS */ long *numwords)
+{
+  size_t	i;
+  long		n;
+  char		**words;
+  HashEntry	*he;
+  words = (char **)MemAlloc((1+build->ht->count)*sizeof(char *),
+                            "char* CorpusBuildWords");
+  n = 0;
+  for (i = 0; i < build->ht->size; i++) {
+    he = &build->ht->hashentries[i];
+    if (he->symbol && he->value) words[n++] = he->symbol;
+  }
+  qsort(words, (size_t)n, sizeof(char *), CorpusStringCompare);
+  *numwords = n;
+  return(words);
+}
+
+long CorpusIdxStringPut(FILE *stream, long strings, char *s)
+{
+  long	r;
+  r = ftell(stream) - strings;
+  fputs(s, stream);
+  putc(TERM, stream);
+  return(r);
+}
+
+void CorpusIdxAlign(FILE *stream)
+{
+  while (ftell(stream) % sizeof(long)) putc(TERM, stream);
+}
+
+void CorpusIdxPostingPut(FILE *stream, long a, long offset,
+                         /* RESULTS */ long *prev_a, long *prev_offset)
+{
+  if (a != *prev_a) *prev_offset = 0;
+  CorpusIdxVarintPut(stream, (unsigned long)(a - *prev_a));
+  CorpusIdxVarintPut(stream, (unsigned long)(offset - *prev_offset));
+  *prev_a = a;
+  *prev_offset = offset;
+}
+
+/* Writes the postings of <term> of <old> for the articles kept in
+ * <artmap>. Returns the number written.
+ */
+long CorpusIdxPostingsCopy(FILE *stream, CorpusIdx *old, CorpusIdxTerm *term,
+                           long *artmap, /* RESULTS */ long *prev_a,
+                           long *prev_offset)
+{
+  unsigned char	*p;
+  long		i, a, d, offset, count;
+  p = (unsigned char *)old->base + old->hdr->postings + term->postings;
+  a = offset = count = 0;
+  for (i = 0; i < term->count; i++) {
+    if ((d = (long)CorpusIdxVarintGet(&p))) {
+      a += d;
+      offset = 0;
+    }
+    offset += (long)CorpusIdxVarintGet(&p);
+    if (artmap[a] < 0) continue;
+    CorpusIdxPostingPut(stream, artmap[a], offset, prev_a, prev_offset);
+    count++;
+  }
+  return(count);
+}
+
+/* Writes the postings of <word> of <build>, whose article ids start at
+ * <firstid>. Returns the number written.
+ */
+long CorpusBuildPostingsWrite(FILE *stream, Corpus *build, char *word,
+                              long firstid, /* RESULTS */ long *prev_a,
+                              long *prev_offset)
+{
+  long			i, n;
+  CorpusWordList	*cwl, **cwls;
+  n = 0;
+  for (cwl = (CorpusWordList *)HashTableGet(build->ht, word); cwl;
+       cwl = cwl->next) {
+    n++;
+  }
+  /* The list is most recent first. */
+  cwls = (CorpusWordList **)MemAlloc((1+n)*sizeof(CorpusWordList *),
+                                     "CorpusWordList* CorpusBuild");
+  i = n;
+  for (cwl = (CorpusWordList *)HashTableGet(build->ht, word); cwl;
+       cwl = cwl->next) {
+    cwls[--i] = cwl;
+  }
+  for (i = 0; i < n; i++) {
+    CorpusIdxPostingPut(stream, firstid + cwls[i]->article->id,
+                        cwls[i]->offset, prev_a, prev_offset);
+  }
+  MemFree(cwls, "CorpusWordList* CorpusBuild");
+  return(n);
+}
+
+/* Writes to <stream> the index of the files of <old> marked in <keep>,
+ * and of the files indexed into <build>.
+ */
+Bool CorpusIdxWrite(FILE *stream, CorpusIdx *old, Bool *keep, Corpus *build)
+{
+  char			**fns, **words, **termwords, **speakers;
+  int			r;
+  long			i, j, n, numfiles, numwords, numold, numoldterms;
+  long			numkept, *artmap, prev_a, prev_offset, postings, count;
+  CorpusIdxHeader	hdr;
+  CorpusIdxFile		*files, *f;
+  CorpusIdxArticle	*articles;
+  CorpusIdxTerm		*terms;
+  Article		*article;
+
+  fns = CorpusIdxFilenames(old, keep, build, &numfiles);
+  words = CorpusBuildWords(build, &numwords);
+  numold = old ? old->hdr->numarticles : 0;
+  numoldterms = old ? old->hdr->numterms : 0;
+
+  /* Articles: the kept ones of <old>, then those of <build>. */
+  n = 1+numold+build->numarticles;
+  artmap = (long *)MemAlloc(n*sizeof(long), "long CorpusIdxWrite");
+  articles = (CorpusIdxArticle *)MemAlloc(n*sizeof(CorpusIdxArticle),
+                                          "CorpusIdxArticle");
+  speakers = (char **)MemAlloc(n*sizeof(char *), "char* CorpusIdxWrite");
+  numkept = 0;
+  for (i = 0; i < numold; i++) {
+    if (!keep[old->articles[i].file]) {
+      artmap[i] = -1L;
+      continue;
+    }
+    artmap[i] = numkept;
+    articles[numkept] = old->articles[i];
+    articles[numkept].file =
+      CorpusIdxFilenameFind(fns, numfiles,
+                            old->strings +
+                            old->files[old->articles[i].file].fn);
+    if (old->articles[i].speaker >= 0) {
+      speakers[numkept] = old->strings + old->articles[i].speaker;
+    } else {
+      speakers[numkept] = NULL;
+    }
+    numkept++;
+  }
+  for (i = 0; i < build->numarticles; i++) {
+    article = build->articles[i];
+    j = numkept + i;
+    articles[j].file = CorpusIdxFilenameFind(fns, numfiles,
+                                             article->filename);
+    articles[j].startpos = (long)article->startpos;
+    articles[j].stoppos = (long)article->stoppos;
+    articles[j].unixts = (long)article->ts.unixts;
+    articles[j].flag = (long)article->ts.flag;
+    if (article->speakers) speakers[j] = M(article->speakers->obj);
+    else speakers[j] = NULL;
+  }
+
+  /* Postings, merging the sorted words of <old> and <build>. */
+  memset(&hdr, 0, sizeof(hdr));
+  fwrite(&hdr, sizeof(hdr), 1, stream);
+  hdr.postings = ftell(stream);
+  n = 1+numwords+numoldterms;
+  terms = (CorpusIdxTerm *)MemAlloc(n*sizeof(CorpusIdxTerm), "CorpusIdxTerm");
+  termwords = (char **)MemAlloc(n*sizeof(char *), "char* CorpusIdxWrite");
+  hdr.numterms = 0;
+  i = j = 0;
+  while (i < numoldterms || j < numwords) {
+    if (i >= numoldterms) r = 1;
+    else if (j >= numwords) r = -1;
+    else r = strcmp(old->strings + old->terms[i].word, words[j]);
+    postings = ftell(stream) - hdr.postings;
+    prev_a = prev_offset = 0;
+    count = 0;
+    if (r <= 0) {
+      termwords[hdr.numterms] = old->strings + old->terms[i].word;
+      count += CorpusIdxPostingsCopy(stream, old, &old->terms[i], artmap,
+                                     &prev_a, &prev_offset);
+      i++;
+    }
+    if (r >= 0) {
+      termwords[hdr.numterms] = words[j];
+      count += CorpusBuildPostingsWrite(stream, build, words[j], numkept,
+                                        &prev_a, &prev_offset);
+      j++;
+    }
+    if (count > 0) {
+      terms[hdr.numterms].postings = postings;
+      terms[hdr.numterms].count = count;
+      hdr.numterms++;
+    }
+  }
+
+  /* Strings. */
+  CorpusIdxAlign(stream);
+  hdr.strings = ftell(stream);
+  for (i = 0; i < hdr.numterms; i++) {
+    terms[i].word = CorpusIdxStringPut(stream, hdr.strings, termwords[i]);
+  }
+  files = (CorpusIdxFile *)MemAlloc((1+numfiles)*sizeof(CorpusIdxFile),
+                                    "CorpusIdxFile");
+  for (i = 0; i < numfiles; i++) {
+    if (old && (f = CorpusIdxFileFind(old, fns[i])) &&
+        keep[f - old->files]) {
+      files[i] = *f;
+    } else if (!CorpusFileStat(fns[i], &files[i].size, &files[i].mtime)) {
+      files[i].size = files[i].mtime = -1L;
+    }
+    files[i].fn = CorpusIdxStringPut(stream, hdr.strings, fns[i]);
+  }
+  for (i = 0; i < numkept+build->numarticles; i++) {
+    if (speakers[i]) {
+      articles[i].speaker = CorpusIdxStringPut(stream, hdr.strings,
+                                               speakers[i]);
+    } else {
+      articles[i].speaker = -1L;
+    }
+  }
+
+  /* Tables. */
+  CorpusIdxAlign(stream);
+  hdr.files = ftell(stream);
+  fwrite(files, sizeof(CorpusIdxFile), (size_t)numfiles, stream);
+  hdr.articles = ftell(stream);
+  fwrite(articles, sizeof(CorpusIdxArticle),
+         (size_t)(numkept+build->numarticles), stream);
+  hdr.terms = ftell(stream);
+  fwrite(terms, sizeof(CorpusIdxTerm), (size_t)hdr.numterms, stream);
+  hdr.len = ftell(stream);
+  memcpy(hdr.magic, CORPUSIDXMAGIC, sizeof(hdr.magic));
+  hdr.numfiles = numfiles;
+  hdr.numarticles = numkept+build->numarticles;
+  fseek(stream, 0L, SEEK_SET);
+  fwrite(&hdr, sizeof(hdr), 1, stream);
+
+  MemFree(fns, "char* CorpusIdxFilenames");
+  MemFree(words, "char* CorpusBuildWords");
+  MemFree(artmap, "long CorpusIdxWrite");
+  MemFree(articles, "CorpusIdxArticle");
+  MemFree(speakers, "char* CorpusIdxWrite");
+  MemFree(terms, "CorpusIdxTerm");
+  MemFree(termwords, "char* CorpusIdxWrite");
+  MemFree(files, "CorpusIdxFile");
+  return(!ferror(stream));
+}
+
+/* Frees what has been indexed into <build>. */
+void CorpusBuildClear(Corpus *build)
+{
+  size_t		i;
+  long			j;
+  HashEntry		*he;
+  CorpusWordList	*cwl, *next;
+  for (i = 0; i < build->ht->size; i++) {
+    he = &build->ht->hashentries[i];
+    if (he->symbol == NULL) continue;
+    for (cwl = (CorpusWordList *)he->value; cwl; cwl = next) {
+      next = cwl->next;
+      MemFree(cwl, "CorpusWordList");
+    }
+    MemFree(he->symbol, "char HashTableIntern");
+  }
+  HashTableClear(build->ht);
+  for (j = 0; j < build->numarticles; j++) {
+    MemFree(build->articles[j]->text, "char * Channel");
+    MemFree(build->articles[j], "Article");
+  }
+  build->numarticles = 0;
+}
+
+/* Removes from <corpus> and returns the index <fn> if it is mapped. */
+CorpusIdx *CorpusIdxRemove(Corpus *corpus, char *fn)
+{
+  CorpusIdx	*idx, *prev;
+  prev = NULL;
+  for (idx = corpus->idxs; idx; idx = idx->next) {
+    if (streq(idx->fn, fn)) {
+      if (prev) prev->next = idx->next;
+      else corpus->idxs = idx->next;
+      idx->next = NULL;
+      return(idx);
+    }
+    prev = idx;
+  }
+  return(NULL);
+}
+
+void CorpusIndexDirectoryInMemory(Corpus *corpus, Directory *dir)
+{
+  Directory	*p;
+  for (p = dir; p; p = p->next) {
+    if (CorpusIdxIsIdxFile(p->basename)) continue;
+    CorpusIndexFile(corpus, p->fn, &p->ts);
+  }
+}
+
 void CorpusIndexDirectory(Corpus *corpus, char *dirfn)
 {
-  Directory *dir, *p;
+  char		fn[FILENAMELEN], newfn[FILENAMELEN];
+  long		size, mtime, numnew, numkept;
+  Bool		*keep, ok;
+  FILE		*stream;
+  CorpusIdx	*old, *idx;
+  CorpusIdxFile	*f;
+  Directory	*dir, *p;
   if (!(dir = DirectoryRead(dirfn))) return;
+  if (snprintf(fn, FILENAMELEN, "%s/%s", dirfn, CORPUSIDXFN) >= FILENAMELEN ||
+      snprintf(newfn, FILENAMELEN, "%s.new", fn) >= FILENAMELEN) {
+    Dbg(DBGGEN, DBGBAD, "path <%s> too long; indexing in memory", dirfn);
+    CorpusIndexDirectoryInMemory(corpus, dir);
+    DirectoryFree(dir);
+    return;
+  }
+  if (!(old = CorpusIdxRemove(corpus, fn))) old = CorpusIdxMap(fn);
+  if (NULL == (stream = StreamOpen(newfn, "w+"))) {
+    Dbg(DBGGEN, DBGBAD, "unable to write <%s>; indexing in memory", fn);
+    if (old) CorpusIdxUnmap(old);
+    CorpusIndexDirectoryInMemory(corpus, dir);
+    DirectoryFree(dir);
+    return;
+  }
+  keep = NULL;
+  if (old) {
+    keep = (Bool *)MemAlloc((1+old->hdr->numfiles)*sizeof(Bool),
+                            "Bool CorpusIndexDirectory");
+    memset(keep, 0, (1+old->hdr->numfiles)*sizeof(Bool));
+  }
+  if (CorpusBuild == NULL) CorpusBuild = CorpusCreate();
+  numnew = numkept = 0;
   for (p = dir; p; p = p->next) {
-    CorpusIndexFile(corpus, p->fn, &p->ts);
+    if (CorpusIdxIsIdxFile(p->basename)) continue;
+    if (!CorpusFileStat(p->fn, &size, &mtime)) continue;
+    if (old && (f = CorpusIdxFileFind(old, p->fn)) &&
+        f->size == size && f->mtime == mtime) {
+      keep[f - old->files] = 1;
+      numkept++;
+      continue;
+    }
+    CorpusIndexFile(CorpusBuild, p->fn, &p->ts);
+    numnew++;
+  }
+  idx = old;
+  if (old == NULL || numnew > 0 || numkept < old->hdr->numfiles) {
+    ok = CorpusIdxWrite(stream, old, keep, CorpusBuild);
+    if (0 != fclose(stream)) ok = 0;
+    if (ok && 0 == rename(newfn, fn)) {
+      Dbg(DBGGEN, DBGOK, "corpus index <%s>: %ld files kept, %ld indexed",
+          fn, numkept, numnew);
+      if (old) CorpusIdxUnmap(old);
+      idx = CorpusIdxMap(fn);
+    } else {
+      Dbg(DBGGEN, DBGBAD, "unable to write <%s>", fn);
+      unlink(newfn);
+    }
+  } else {
+    fclose(stream);
+    unlink(newfn);
   }
+  if (idx) {
+    idx->next = corpus->idxs;
+    corpus->idxs = idx;
+  }
+  CorpusBuildClear(CorpusBuild);
+  if (keep) MemFree(keep, "Bool CorpusIndexDirectory");
   DirectoryFree(dir);
 }
 
+/* Postings of <word> in the memory index and the mapped indexes of
+ * <corpus>:
+ *   CorpusCursorInit(&cc, corpus, word);
+ *   while ((cwl = CorpusCursorNext(&cc))) ...
+ */
+void CorpusCursorInit(CorpusCursor *cc, Corpus *corpus, char *word)
+{
+  cc->word = word;
+  cc->cwl = (CorpusWordList *)HashTableGet(corpus->ht, word);
+  cc->idx = corpus->idxs;
+  cc->left = -1L;
+}
+
+CorpusWordList *CorpusCursorNext(CorpusCursor *cc)
+{
+  long			d;
+  CorpusWordList	*cwl;
+  CorpusIdxTerm		*term;
+  if ((cwl = cc->cwl)) {
+    cc->cwl = cwl->next;
+    return(cwl);
+  }
+  while (cc->idx) {
+    if (cc->left < 0) {
+      if ((term = CorpusIdxTermFind(cc->idx, cc->word))) {
+        cc->p = (unsigned char *)cc->idx->base + cc->idx->hdr->postings +
+                term->postings;
+        cc->left = term->count;
+      } else {
+        cc->left = 0;
+      }
+      cc->article = cc->offset = 0;
+    }
+    while (cc->left > 0) {
+      cc->left--;
+      if ((d = (long)CorpusIdxVarintGet(&cc->p))) {
+        cc->article += d;
+        cc->offset = 0;
+      }
+      cc->offset += (long)CorpusIdxVarintGet(&cc->p);
+      if ((cc->cur.article = CorpusIdxArticleGet(cc->idx, cc->article))) {
+        cc->cur.offset = cc->offset;
+        cc->cur.next = NULL;
+        return(&cc->cur);
+      }
+    }
+    cc->idx = cc->idx->next;
+    cc->left = -1L;
+  }
+  return(NULL);
+}
+
 Corpus *CorpusFrench, *CorpusEnglish;
 
 void CorpusInit()
@@ -291,11 +980,12 @@ int CorpusFrenchGender(Corpus *corpus, char *word)
   long			m, f;
   char			buf[DWORDLEN];
   CorpusWordList	*cwl;
+  CorpusCursor		cc;
   StringToLowerNoAccents(word, DWORDLEN, buf);
   len = strlen(word);
   m = f = 0L;
-  for (cwl = (CorpusWordList *)HashTableGet(corpus->ht, word);
-       cwl; cwl = cwl->next) {
+  CorpusCursorInit(&cc, corpus, word);
+  while ((cwl = CorpusCursorNext(&cc))) {
     if (0 != strncmp(word, cwl->article->text + cwl->offset, len)) continue;
     CorpusFrenchGender1(cwl, &m, &f);
   }
@@ -327,12 +1017,13 @@ void CorpusPrintWordList1(char *buf, CorpusWordList *cwl, int halflinelen,
                        buf+prelen);
 }
 
-void CorpusPrintWordList(FILE *stream, CorpusWordList *cwl, char *word,
+void CorpusPrintWordList(FILE *stream, CorpusCursor *cc, char *word,
                          int linelen, int longfmt)
 {
   char			buf[LINELEN];
   int			wordlen;
   int			prelen, halflinelen;
+  CorpusWordList	*cwl;
   StringArray	*sa;
   wordlen = strlen(word);
   if (longfmt) {
@@ -342,7 +1033,7 @@ void CorpusPrintWordList(FILE *stream, CorpusWordList *cwl, char *word,
   }
   halflinelen = (((linelen - prelen) - wordlen))/2;
   sa = StringArrayCreate();
-  for (; cwl; cwl = cwl->next) {
+  while ((cwl = CorpusCursorNext(cc))) {
     CorpusPrintWordList1(buf, cwl, halflinelen, prelen, wordlen, longfmt);
     StringArrayAddCopy(sa, buf, 0);
   }
@@ -367,13 +1058,11 @@ void CorpusPrintWordList(FILE *stream, CorpusWordList *cwl, char *word,
 
 void CorpusPrintWord(FILE *stream, Corpus *corpus, char *word0, int linelen)
 {
-  char	word1[DWORDLEN];
+  char		word1[DWORDLEN];
+  CorpusCursor	cc;
   StringToLowerNoAccents(word0, DWORDLEN, word1);
-  CorpusPrintWordList(stream,
-                      (CorpusWordList *)HashTableGet(corpus->ht, word1),
-                      word1,
-                      linelen,
-                      0);
+  CorpusCursorInit(&cc, corpus, word1);
+  CorpusPrintWordList(stream, &cc, word1, linelen, 0);
 }
 
 /* ADVERBIAL FINDER */
@@ -453,6 +1142,7 @@ Bool Corpus_AdverbialFinderDirectory(char *dirfn, char *out_fn)
   Directory *dir, *p;
   if (!(dir = DirectoryRead(dirfn))) return(0);
   for (p = dir; p; p = p->next) {
+    if (CorpusIdxIsIdxFile(p->basename)) continue;
     Corpus_AdverbialFinderFile(p->fn, out_fn);
   }
   DirectoryFree(dir);
@@ -9,14 +9,39 @@ void CorpusIndexPNodeList(Corpus *corpus, Channel *ch, Ts *ts);
 void CorpusPNodeListAddArticle(Channel *ch, char *filename, char *base, char *start, char *end);
 void CorpusIndexFileString(Corpus *corpus, Channel *ch, char *filename, char *s, Ts *ts);
 Bool CorpusIndexFile(Corpus *corpus, char *fn, Ts *ts0);
+Bool CorpusIdxIsIdxFile(char *basename);
+Bool CorpusFileStat(char *fn, long *size, long *mtime);
+int CorpusStringCompare(const void *s1, const void *s2);
+long CorpusIdxVarintPut(FILE *stream, unsigned long v);
+unsigned long CorpusIdxVarintGet(unsigned char **p);
+CorpusIdx *CorpusIdxMap(char *fn);
+void CorpusIdxUnmap(CorpusIdx *idx);
+CorpusIdxFile *CorpusIdxFileFind(CorpusIdx *idx, char *fn);
+CorpusIdxTerm *CorpusIdxTermFind(CorpusIdx *idx, char *word);
+char *CorpusIdxFileMap(CorpusIdx *idx, long i);
+Article *CorpusIdxArticleGet(CorpusIdx *idx, long id);
+char **CorpusIdxFilenames(CorpusIdx *old, Bool *keep, Corpus *build, long *numfiles);
+long CorpusIdxFilenameFind(char **fns, long numfiles, char *fn);
+char **CorpusBuildWords(Corpus *build, long *numwords);
+long CorpusIdxStringPut(FILE *stream, long strings, char *s);
+void CorpusIdxAlign(FILE *stream);
+void CorpusIdxPostingPut(FILE *stream, long a, long offset, long *prev_a, long *prev_offset);
+long CorpusIdxPostingsCopy(FILE *stream, CorpusIdx *old, CorpusIdxTerm *term, long *artmap, long *prev_a, long *prev_offset);
+long CorpusBuildPostingsWrite(FILE *stream, Corpus *build, char *word, long firstid, long *prev_a, long *prev_offset);
+Bool CorpusIdxWrite(FILE *stream, CorpusIdx *old, Bool *keep, Corpus *build);
+void CorpusBuildClear(Corpus *build);
+CorpusIdx *CorpusIdxRemove(Corpus *corpus, char *fn);
+void CorpusIndexDirectoryInMemory(Corpus *corpus, Directory *dir);
 void CorpusIndexDirectory(Corpus *corpus, char *dirfn);
+void CorpusCursorInit(CorpusCursor *cc, Corpus *corpus, char *word);
+CorpusWordList *CorpusCursorNext(CorpusCursor *cc);
 void CorpusInit(void);
 Corpus *LangToCorpus(int lang);
 Bool CorpusFrenchGender2(char *s, CorpusWordList *cwl);
 void CorpusFrenchGender1(CorpusWordList *cwl, long *m, long *f);
 int CorpusFrenchGender(Corpus *corpus, char *word);
 void CorpusPrintWordList1(char *buf, CorpusWordList *cwl, int halflinelen, int prelen, int wordlen, int longfmt);
-void CorpusPrintWordList(FILE *stream, CorpusWordList *cwl, char *word, int linelen, int longfmt);
+void CorpusPrintWordList(FILE *stream, CorpusCursor *cc, char *word, int linelen, int longfmt);
 void CorpusPrintWord(FILE *stream, Corpus *corpus, char *word0, int linelen);
 void Corpus_AdverbialFinder3(FILE *outstream, char *begin, char *end);
 void Corpus_AdverbialFinder2(FILE *outstream, char *begin, char *end, int numword_thresh);
@@ -46,7 +46,7 @@ HashTable *ReportPhraseDeriv;
 void ReportInit()
 {
   if (!SaveTime) {
-    ReportPhraseDeriv = HashTableCreate(521L);
+    ReportPhraseDeriv = HashTableCreate(521L, "ReportPhraseDeriv");
   }
   ReportAnagramInit();
 }
@@ -451,7 +451,7 @@ void ReportAnagramTrain()
 {
   LexEntry		*le;
   Dbg(DBGLEX, DBGDETAIL, "ReportAnagramTrain begin");
-  ReportAnagramHt = HashTableCreate(5021L);
+  ReportAnagramHt = HashTableCreate(5021L, "ReportAnagramHt");
   for (le = AllLexEntries; le; le = le->next) {
     if (LexEntryIsPhrase(le)) continue;
     ReportAnagramTrain1(le);
@@ -31,6 +31,7 @@
 #include "repstr.h"
 #include "reptime.h"
 #include "semdisc.h"
+#include "synparse.h"
 #include "synpnode.h"
 #include "ta.h"
 #include "taemail.h"
@@ -47,6 +48,7 @@
 #include "toolsh.h"
 #include "toolsvr.h"
 #include "tooltest.h"
+#include "ua.h"
 #include "uadict.h"
 #include "uascript.h"
 #include "utildbg.h"
@@ -139,6 +141,8 @@ int Tool_Shell_Interpret(char *line, FILE *in, FILE *out, FILE *err,
 
   next_dc_out = DCOUT1;
   dc->run_agencies = AGENCY_ALL;
+  dc->understand_workers = 0;
+  dc->understand_stopped = 0;
   GenAdviceInit(&dc->ga);
   dc->mode &= ~(DC_MODE_THOUGHTSTREAM|DC_MODE_COMPOUND_NOUN);
 
@@ -196,6 +200,8 @@ int Tool_Shell_Interpret(char *line, FILE *in, FILE *out, FILE *err,
     } else if (streq(opt, "-runund")) {
       if (atoi(optarg)) dc->run_agencies |= AGENCY_UNDERSTANDING;
       else dc->run_agencies &= ~AGENCY_UNDERSTANDING;
+    } else if (streq(opt, "-undworkers")) {
+      dc->understand_workers = atoi(optarg);
     } else if (streq(opt, "-lang")) {
     /* todo: Error checking. */
       sa.lang = optarg[0];
@@ -402,10 +408,20 @@ int Tool_Shell_Interpret_Other_Command(char *buf, ShellArgs *sa, FILE *in,
   else if (streq(buf, "testtrip"))      TestTrip();
   else if (streq(buf, "testts"))        TestGenTsRange();
   else if (streq(buf, "testsa"))        TestGenSpeechActs();
+  else if (streq(buf, "isabench"))      TestIsaBench(out);
+  else if (streq(buf, "inferon"))       InferenceOn = 1;
+  else if (streq(buf, "inferoff"))      InferenceOn = 0;
   else if (streq(buf, "sortbyline"))    StreamSortIn(0);
   else if (streq(buf, "sortbytree"))    StreamSortIn(1);
     /* todo: Sortbytree: last line must be === */
   else if (streq(buf, "grind"))         GrinderGrind();
+  else if (streq(buf, "hashstats")) {
+    HashTableStatsAll(out);
+    DbIndexStatsAll(out);
+  }
+  else if (streq(buf, "parsestats"))    Syn_ParseStatsPrint(out);
+  else if (streq(buf, "demonstats"))    DemonStatsPrint(out);
+  else if (streq(buf, "undstats"))      UnderstandStatsPrint(out);
   else return(0);
   return(1);
 }
@@ -15,10 +15,27 @@
  * 19981115T151512: chatterbot
  * 19981116T141045: syntactic parse, generate
  * 19981120T184203: some case insensitivity
+ * 20261017T160000: tag and syntacticparse use scratch memory
+ * 20261017T200000: epoll event loop and worker pool
+ * 20261017T210000: Batch, gathered sends
+ * 20261018T100000: ancestors and descendants written as they are found
  */
 
 /* Implementation of ThoughtTreasure Server Protocol (TTSP)
  * as defined in <URL:../htm/ttsp.htm>.
+ *
+ * One thread (the event loop) accepts connections and moves bytes between
+ * sockets and their fifos, using epoll where available and select
+ * otherwise. Complete request lines are handed to a pool of worker
+ * threads. A socket is given to one worker at a time, so requests on a
+ * connection are answered in order and its discourse context is only
+ * touched by one thread. Requests on different connections that only read
+ * the database (cf Tool_Server_IsReadOnly) run concurrently; all others
+ * hold ServerKBLock exclusively.
+ *
+ * Locks, in the order they are taken: ServerKBLock, ThreadLock (cf
+ * repbasic.c), ServerMutex. ServerMutex guards the fifos, the queues,
+ * and the busy and closing flags of sockets.
  */
 
 #include "tt.h"
@@ -29,6 +46,12 @@
 #include <netdb.h>
 #include <arpa/inet.h>
 #include <errno.h>
+#include <pthread.h>
+#include <sys/uio.h>
+#ifdef __linux__
+#define EPOLL
+#include <sys/epoll.h>
+#endif
 
 #include "lexentry.h"
 #include "lexobjle.h"
@@ -51,27 +74,56 @@
 #include "utillrn.h"
 
 #define BUFSIZE 4096
-
-Socket *sockets[FD_SETSIZE];
+#define SERVERMAXWORKERS	32
+#define SERVERMAXEVENTS		64
+#define SERVERMAXIOV		64
+#define SERVERMAXPENDING	65536L	/* unsent bytes before a batch yields */
+
+Socket		*Sockets;	/* all sockets, including the listen socket */
+Socket		*ServerQueue, *ServerQueueLast;	/* awaiting a worker */
+Socket		*ServerDone;	/* workers are done with */
+Bool		ServerExit;
+int		ServerWake[2];	/* workers write to ServerWake[1] when done */
+int		ServerNumWorkers;
+pthread_t	ServerWorkers[SERVERMAXWORKERS];
+pthread_mutex_t	ServerMutex = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t	ServerCond = PTHREAD_COND_INITIALIZER;
+pthread_rwlock_t ServerKBLock;
+#ifdef EPOLL
+int		ServerEpoll;
+#endif
 
 /* Socket */
 
 void SocketInit()
 {
-  int i;
-  for (i = 0; i < FD_SETSIZE; i++) sockets[i] = NULL;
+  Sockets = ServerQueue = ServerQueueLast = ServerDone = NULL;
+  ServerExit = 0;
 }
 
+/* Sockets are created on the event loop thread while a worker may be in
+ * a scratch request, so they are never scratch memory.
+ */
 Socket *SocketCreate(int fd, char *host, int bufsize)
 {
   Socket *skt;
-  skt = CREATE(Socket);
+  skt = CREAT(Socket, 1);
   skt->fd = fd;
-  skt->host = StringCopy(host, "Socket host");
+  skt->host = (char *)MemAlloc1(1+strlen(host), "Socket host", 1);
+  strcpy(skt->host, host);
   skt->fifo_read = FifoCreate(bufsize);
   skt->fifo_write = FifoCreate(bufsize);
+  skt->fifo_reply = FifoCreate(bufsize);
+  skt->batch = skt->batchn = 0;
   skt->dc = NULL;
-  sockets[fd] = skt;
+  skt->busy = skt->closing = 0;
+  skt->retcode = 1;
+  skt->events = 0;
+  skt->next_queued = NULL;
+  skt->prev = NULL;
+  skt->next = Sockets;
+  if (Sockets) Sockets->prev = skt;
+  Sockets = skt;
   return skt;
 }
 
@@ -79,38 +131,91 @@ void SocketFree(Socket *skt)
 {
   Dbg(DBGGEN, DBGOK, "%s [%d]: closed", skt->host, skt->fd);
   close(skt->fd);
-  sockets[skt->fd] = NULL;
+  if (skt->prev) skt->prev->next = skt->next;
+  else Sockets = skt->next;
+  if (skt->next) skt->next->prev = skt->prev;
   MemFree(skt->host, "Socket host");
   FifoFree(skt->fifo_read);
   FifoFree(skt->fifo_write);
+  FifoFree(skt->fifo_reply);
   if (skt->dc != NULL) API_DiscourseFree(skt->dc);
   MemFree(skt, "Socket");
 }
 
 Bool SocketReadLine(Socket *skt, int linelen, /* RESULTS */ char *line)
 {
-  return FifoReadLine(skt->fifo_read, linelen, line);
+  Bool r;
+  pthread_mutex_lock(&ServerMutex);
+  r = FifoReadLine(skt->fifo_read, linelen, line);
+  pthread_mutex_unlock(&ServerMutex);
+  return r;
 }
 
+/* Only the worker answering a request on <skt> writes to it. The reply is
+ * passed on to the event loop whole (cf Tool_Server_Reply).
+ */
 void SocketWrite(Socket *skt, char *s)
 {
-  FifoWrite(skt->fifo_write, s);
+  FifoWrite(skt->fifo_reply, s);
 }
 
 /* Tool_Server */
 
+/* Requests that may run alongside each other. Retrieve only qualifies
+ * once its pattern is parsed (cf Tool_Server_KBShare).
+ */
+Bool Tool_Server_IsReadOnly(char *cmd)
+{
+  return(streq(cmd, "status") ||
+         streq(cmd, "isa") ||
+         streq(cmd, "ispartof") ||
+         streq(cmd, "parents") ||
+         streq(cmd, "children") ||
+         streq(cmd, "ancestors") ||
+         streq(cmd, "descendants") ||
+         streq(cmd, "phrasetoconcepts") ||
+         streq(cmd, "concepttolexentries") ||
+         streq(cmd, "batch") ||
+         streq(cmd, "quit") ||
+         streq(cmd, "bringdown"));
+}
+
+/* Lets other read-only requests in for the rest of this request. */
+void Tool_Server_KBShare()
+{
+  pthread_rwlock_unlock(&ServerKBLock);
+  pthread_rwlock_rdlock(&ServerKBLock);
+}
+
 /* Returns 1 on success,
  *         0 if caller should close connection,
  *         -1 if it is time to exit.
+ * Requests that leave nothing behind but their reply run in scratch
+ * memory (cf MemScratchBegin). Generate does not qualify: it leaves
+ * antecedents for later anaphora in the discourse context.
+ * The discourse context is created by the first request that needs it.
  */
 Bool Tool_Server_ProcessLine(Socket *skt, char *line)
 {
+  int  retcode, framed;
   char *p, cmd[PHRASELEN];
 
   p = line;
   p = StringReadWord(p, PHRASELEN, cmd);
   Dbg(DBGGEN, DBGOK, "%s [%d]: <%s>", skt->host, skt->fd, line);
   StringToLowerDestructive(cmd);
+  if (Tool_Server_IsReadOnly(cmd)) {
+    pthread_rwlock_rdlock(&ServerKBLock);
+  } else {
+    pthread_rwlock_wrlock(&ServerKBLock);
+    if (skt->dc == NULL) skt->dc = API_DiscourseCreate();
+  }
+  framed = 0;
+  if (skt->batch > 0) {
+    skt->batch--;
+    framed = skt->batchn - skt->batch;
+  }
+  retcode = 1;
   if (cmd[0] == TERM) {
     SocketWrite(skt, "error: empty command\n");
   } else if (streq(cmd, "status")) {
@@ -133,9 +238,13 @@ Bool Tool_Server_ProcessLine(Socket *skt, char *line)
   } else if (streq(cmd, "concepttolexentries")) {
     Tool_Server_ConceptToLexEntries(skt, p);
   } else if (streq(cmd, "tag")) {
+    MemScratchBegin();
     Tool_Server_Tag(skt, p);
+    MemScratchEnd(cmd);
   } else if (streq(cmd, "syntacticparse")) {
+    MemScratchBegin();
     Tool_Server_SemanticParse(skt, p, 0);
+    MemScratchEnd(cmd);
   } else if (streq(cmd, "semanticparse")) {
     Tool_Server_SemanticParse(skt, p, 1);
   } else if (streq(cmd, "generate")) {
@@ -144,14 +253,64 @@ Bool Tool_Server_ProcessLine(Socket *skt, char *line)
     Tool_Server_Chatterbot(skt, p);
   } else if (streq(cmd, "clearcontext")) {
     Tool_Server_ClearContext(skt);
+  } else if (streq(cmd, "batch")) {
+    Tool_Server_Batch(skt, p, framed);
   } else if (streq(cmd, "quit")) {
-    return 0;
+    retcode = 0;
   } else if (streq(cmd, "bringdown")) {
-    return -1;
+    retcode = -1;
   } else {
     SocketWrite(skt, "error: unknown command\n");
   }
-  return 1;
+  pthread_rwlock_unlock(&ServerKBLock);
+  Tool_Server_Reply(skt, framed);
+  return retcode;
+}
+
+/* Passes the reply to the current request on to the event loop. Within a
+ * batch, each reply is preceded by a line giving its position in the
+ * batch and its length in bytes.
+ */
+void Tool_Server_Reply(Socket *skt, int framed)
+{
+  char buf[WORDLEN];
+  if (framed) {
+    sprintf(buf, "#%d %ld\n", framed, FifoLength(skt->fifo_reply));
+  }
+  pthread_mutex_lock(&ServerMutex);
+  if (framed) FifoWrite(skt->fifo_write, buf);
+  FifoMove(skt->fifo_write, skt->fifo_reply);
+  pthread_mutex_unlock(&ServerMutex);
+}
+
+/* Whether enough replies are waiting to be sent that the worker should
+ * hand <skt> back to the event loop.
+ */
+Bool Tool_Server_ReplyPending(Socket *skt)
+{
+  Bool r;
+  pthread_mutex_lock(&ServerMutex);
+  r = FifoLength(skt->fifo_write) >= SERVERMAXPENDING;
+  pthread_mutex_unlock(&ServerMutex);
+  return r;
+}
+
+/* The next <n> requests are answered as they arrive, without waiting for
+ * the client to read each reply.
+ */
+void Tool_Server_Batch(Socket *skt, char *p, int framed)
+{
+  int  n;
+  char nbuf[WORDLEN];
+  p = StringReadWord(p, WORDLEN, nbuf);
+  n = atoi(nbuf);
+  if (framed) {
+    SocketWrite(skt, "error: Batch within Batch\n");
+  } else if (n <= 0) {
+    SocketWrite(skt, "error: Usage: Batch <n>\n");
+  } else {
+    skt->batch = skt->batchn = n;
+  }
 }
 
 void Tool_Server_Status(Socket *skt, char *p)
@@ -192,33 +351,37 @@ void Tool_Server_IsPartOf(Socket *skt, char *p)
   SocketWrite(skt, r);
 }
 
+void Tool_Server_AncDesc1(Obj *obj, SocketObjs *so)
+{
+  if (!so->first) SocketWrite(so->skt, ":");
+  so->first = 0;
+  SocketWrite(so->skt, M(obj));
+}
+
+/* Objects are written as the traversal reaches them, without building
+ * a list of them first.
+ */
 void Tool_Server_AncDesc(Socket *skt, char *cmd, char *p)
 {
-  int     first;
-  char    obj[OBJNAMELEN], *r;
-  ObjList *objs, *p1;
+  char       obj[OBJNAMELEN], *r;
+  SocketObjs so;
   p = StringReadWord(p, OBJNAMELEN, obj);
   if (obj[0] == TERM) goto usage;
+  so.skt = skt;
+  so.first = 1;
   if (streq(cmd, "parents")) {
-    objs = ObjParents(N(obj), OBJTYPEANY);
+    ObjAncestorsForeach(N(obj), OBJTYPEANY, 1, Tool_Server_AncDesc1, &so);
   } else if (streq(cmd, "children")) {
-    objs = ObjChildren(N(obj), OBJTYPEANY);
+    ObjDescendantsForeach(N(obj), OBJTYPEANY, 1, Tool_Server_AncDesc1, &so);
   } else if (streq(cmd, "ancestors")) {
-    objs = ObjAncestors(N(obj), OBJTYPEANY);
+    ObjAncestorsForeach(N(obj), OBJTYPEANY, INTPOSINF, Tool_Server_AncDesc1,
+                        &so);
   } else if (streq(cmd, "descendants")) {
-    objs = ObjDescendants(N(obj), OBJTYPEANY);
+    ObjDescendantsForeach(N(obj), OBJTYPEANY, INTPOSINF,
+                          Tool_Server_AncDesc1, &so);
   } else {
     Dbg(DBGGEN, DBGBAD, "%s [%d]: unknown mode", skt->host, skt->fd);
-    objs = NULL;
   }
-  first = 1;
-  for (p1 = objs; p1; p1 = p1->next) {
-    if (!first) SocketWrite(skt, ":");
-    if (p1->obj == NULL) continue;
-    first = 0;
-    SocketWrite(skt, M(p1->obj));
-  }
-  ObjListFree(objs);
   SocketWrite(skt, "\n");
   return;
 
@@ -264,6 +427,7 @@ void Tool_Server_Retrieve(Socket *skt, char *p)
   }
   if (len == 0) goto usage;
   ptn = ObjCreateList1(elems, len);
+  Tool_Server_KBShare();
   objs = NULL; /* REDUNDANT */
   if (streq(mode, "exact")) {
     if (anci != -1) goto usage;
@@ -733,9 +897,290 @@ void Tool_Server_NewConnection(int s)
   }
 
   skt = SocketCreate(s, host, BUFSIZE);
-  skt->dc = API_DiscourseCreate();
+  Tool_Server_Watch(skt);
 }
 
+/* Workers */
+
+/* Called with ServerMutex held. */
+void Tool_Server_Enqueue(Socket *skt)
+{
+  skt->next_queued = NULL;
+  if (ServerQueueLast) ServerQueueLast->next_queued = skt;
+  else ServerQueue = skt;
+  ServerQueueLast = skt;
+  pthread_cond_signal(&ServerCond);
+}
+
+/* Returns NULL when it is time for workers to exit. */
+Socket *Tool_Server_Dequeue()
+{
+  Socket *skt;
+  pthread_mutex_lock(&ServerMutex);
+  while (ServerQueue == NULL && !ServerExit) {
+    pthread_cond_wait(&ServerCond, &ServerMutex);
+  }
+  if (ServerExit) {
+    skt = NULL;
+  } else {
+    skt = ServerQueue;
+    if (NULL == (ServerQueue = skt->next_queued)) ServerQueueLast = NULL;
+    skt->next_queued = NULL;
+  }
+  pthread_mutex_unlock(&ServerMutex);
+  return skt;
+}
+
+/* Hands <skt> back to the event loop. */
+void Tool_Server_Done(Socket *skt, int retcode)
+{
+  pthread_mutex_lock(&ServerMutex);
+  skt->retcode = retcode;
+  skt->next_queued = ServerDone;
+  ServerDone = skt;
+  pthread_mutex_unlock(&ServerMutex);
+  if (-1 == write(ServerWake[1], "", 1)) {
+    Dbg(DBGGEN, DBGBAD, "wake trouble: %s", strerror(errno));
+  }
+}
+
+void Tool_Server_DiscourseFree(Socket *skt)
+{
+  if (skt->dc == NULL) return;
+  pthread_rwlock_wrlock(&ServerKBLock);
+  API_DiscourseFree(skt->dc);
+  skt->dc = NULL;
+  pthread_rwlock_unlock(&ServerKBLock);
+}
+
+/* Each time it is given a socket, a worker answers one request, or frees
+ * the discourse context of a socket that is closing.
+ */
+void *Tool_Server_Worker(void *arg)
+{
+  int    retcode;
+  Bool   closing;
+  char   line[PARAGRAPHLEN];
+  Socket *skt;
+  while ((skt = Tool_Server_Dequeue())) {
+    pthread_mutex_lock(&ServerMutex);
+    closing = skt->closing;
+    pthread_mutex_unlock(&ServerMutex);
+    retcode = 1;
+    if ((!closing) && SocketReadLine(skt, PARAGRAPHLEN, line)) {
+      retcode = Tool_Server_ProcessLine(skt, line);
+      /* As much of a batch as has arrived. */
+      while (retcode == 1 && skt->batch > 0 &&
+             (!Tool_Server_ReplyPending(skt)) &&
+             SocketReadLine(skt, PARAGRAPHLEN, line)) {
+        retcode = Tool_Server_ProcessLine(skt, line);
+      }
+    }
+    if (closing || retcode == 0) Tool_Server_DiscourseFree(skt);
+    Tool_Server_Done(skt, retcode);
+  }
+  return NULL;
+}
+
+/* One worker per processor, within limits. */
+Bool Tool_Server_WorkersStart()
+{
+  long                 n;
+  pthread_rwlockattr_t attr;
+  if (-1 == pipe(ServerWake) ||
+      -1 == fcntl(ServerWake[0], F_SETFL, O_NONBLOCK)) {
+    Dbg(DBGGEN, DBGBAD, "pipe trouble: %s", strerror(errno));
+    return 0;
+  }
+  pthread_rwlockattr_init(&attr);
+#ifdef _GNU_SOURCE
+  /* Keep a stream of queries from holding off parses indefinitely. */
+  pthread_rwlockattr_setkind_np(&attr,
+                                PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+#endif
+  pthread_rwlock_init(&ServerKBLock, &attr);
+  pthread_rwlockattr_destroy(&attr);
+  n = sysconf(_SC_NPROCESSORS_ONLN);
+  if (n < 2) n = 2;
+  if (n > SERVERMAXWORKERS) n = SERVERMAXWORKERS;
+  ThreadsOn = 1;
+  for (ServerNumWorkers = 0; ServerNumWorkers < n; ServerNumWorkers++) {
+    if (pthread_create(&ServerWorkers[ServerNumWorkers], NULL,
+                       Tool_Server_Worker, NULL)) {
+      Dbg(DBGGEN, DBGBAD, "pthread_create trouble");
+      break;
+    }
+  }
+  if (ServerNumWorkers == 0) {
+    ThreadsOn = 0;
+    return 0;
+  }
+  Dbg(DBGGEN, DBGOK, "%d workers", ServerNumWorkers);
+  return 1;
+}
+
+/* Waits for requests in progress to finish. */
+void Tool_Server_WorkersStop()
+{
+  int i;
+  pthread_mutex_lock(&ServerMutex);
+  ServerExit = 1;
+  pthread_cond_broadcast(&ServerCond);
+  pthread_mutex_unlock(&ServerMutex);
+  for (i = 0; i < ServerNumWorkers; i++) {
+    pthread_join(ServerWorkers[i], NULL);
+  }
+  ThreadsOn = 0;
+  pthread_rwlock_destroy(&ServerKBLock);
+  close(ServerWake[0]);
+  close(ServerWake[1]);
+}
+
+/* Event loop */
+
+/* Hands <skt> to a worker if it has a complete request line and no worker
+ * has it.
+ */
+void Tool_Server_Dispatch(Socket *skt)
+{
+  pthread_mutex_lock(&ServerMutex);
+  if ((!skt->busy) && (!skt->closing) &&
+      FifoIsLineAvailable(skt->fifo_read)) {
+    skt->busy = 1;
+    Tool_Server_Enqueue(skt);
+  }
+  pthread_mutex_unlock(&ServerMutex);
+}
+
+/* Stops reading from <skt>, and frees it once no worker has it. Its
+ * discourse context, if any, is freed by a worker.
+ */
+void Tool_Server_Close(Socket *skt)
+{
+  Bool busy;
+  pthread_mutex_lock(&ServerMutex);
+  skt->closing = 1;
+  if ((!skt->busy) && skt->dc != NULL) {
+    skt->busy = 1;
+    Tool_Server_Enqueue(skt);
+  }
+  busy = skt->busy;
+  pthread_mutex_unlock(&ServerMutex);
+  if (busy) Tool_Server_Watch(skt);
+  else SocketFree(skt);
+}
+
+/* Polls <skt> for requests unless it is closing, and for writing while
+ * it has replies to send.
+ */
+void Tool_Server_Watch(Socket *skt)
+{
+#ifdef EPOLL
+  int                events;
+  struct epoll_event ev;
+  if (skt->closing) {
+    events = 0;
+  } else {
+    events = EPOLLIN;
+    pthread_mutex_lock(&ServerMutex);
+    if (!FifoIsEmpty(skt->fifo_write)) events |= EPOLLOUT;
+    pthread_mutex_unlock(&ServerMutex);
+  }
+  if (events == skt->events) return;
+  ev.events = events;
+  ev.data.ptr = (void *)skt;
+  if (skt->events == 0) {
+    epoll_ctl(ServerEpoll, EPOLL_CTL_ADD, skt->fd, &ev);
+  } else if (events == 0) {
+    epoll_ctl(ServerEpoll, EPOLL_CTL_DEL, skt->fd, &ev);
+  } else {
+    epoll_ctl(ServerEpoll, EPOLL_CTL_MOD, skt->fd, &ev);
+  }
+  skt->events = events;
+#endif
+}
+
+/* Called for each socket a worker is done with. */
+void Tool_Server_Resume(Socket *skt)
+{
+  pthread_mutex_lock(&ServerMutex);
+  skt->busy = 0;
+  pthread_mutex_unlock(&ServerMutex);
+  if (skt->retcode == -1) return;
+  if (skt->retcode == 0 || skt->closing) {
+    Tool_Server_Close(skt);
+  } else {
+    Tool_Server_Dispatch(skt);
+    Tool_Server_Watch(skt);
+  }
+}
+
+/* returns 0 if it is time to exit. */
+Bool Tool_Server_Process()
+{
+  char   buf[64];
+  Bool   r;
+  Socket *skt, *next;
+  while (read(ServerWake[0], buf, sizeof(buf)) > 0);
+  pthread_mutex_lock(&ServerMutex);
+  skt = ServerDone;
+  ServerDone = NULL;
+  pthread_mutex_unlock(&ServerMutex);
+  r = 1;
+  for (; skt; skt = next) {
+    next = skt->next_queued;
+    if (skt->retcode == -1) r = 0;
+    Tool_Server_Resume(skt);
+  }
+  return r;
+}
+
+#ifdef EPOLL
+void Tool_Server_EpollLoop(int ls)
+{
+  int                i, n;
+  Bool               wake;
+  Socket             *skt;
+  struct epoll_event ev, events[SERVERMAXEVENTS];
+  if (-1 == (ServerEpoll = epoll_create(SERVERMAXEVENTS))) {
+    Dbg(DBGGEN, DBGBAD, "epoll trouble: %s", strerror(errno));
+    Tool_Server_SelectLoop(ls);
+    return;
+  }
+  ev.events = EPOLLIN;
+  ev.data.ptr = NULL;
+  epoll_ctl(ServerEpoll, EPOLL_CTL_ADD, ServerWake[0], &ev);
+  for (skt = Sockets; skt; skt = skt->next) Tool_Server_Watch(skt);
+  while (1) {
+    if (-1 == (n = epoll_wait(ServerEpoll, events, SERVERMAXEVENTS, -1))) {
+      if (errno == EINTR) continue;
+      Dbg(DBGGEN, DBGBAD, "epoll trouble: %s", strerror(errno));
+      break;
+    }
+    wake = 0;
+    for (i = 0; i < n; i++) {
+      if (NULL == (skt = (Socket *)events[i].data.ptr)) {
+        wake = 1;
+        continue;
+      }
+      if (events[i].events & EPOLLERR) {
+        Dbg(DBGGEN, DBGOK, "%s [%d]: exception", skt->host, skt->fd);
+        Tool_Server_Close(skt);
+        continue;
+      }
+      if ((events[i].events & EPOLLOUT) && !Tool_Server_SelectWrite(skt)) {
+        continue;
+      }
+      if (events[i].events & (EPOLLIN|EPOLLHUP)) {
+        Tool_Server_SelectRead(skt, ls);
+      }
+    }
+    if (wake && !Tool_Server_Process()) break;
+  }
+  close(ServerEpoll);
+}
+#endif
+
 void Tool_Server_SelectLoop(int ls)
 {
   int retcode;
@@ -746,101 +1191,105 @@ void Tool_Server_SelectLoop(int ls)
       return;
     }
     if (retcode == 0) continue;
-    if (!Tool_Server_Process(ls)) return;
+    if (!Tool_Server_Process()) return;
   }
 }
 
 int Tool_Server_ReadAndWrite(int ls)
 { 
-  int            i, maxfd, retcode;
+  int            maxfd, retcode;
   fd_set         readfds, writefds, exceptfds;
   struct timeval tv;
-  Socket         *skt;
+  Socket         *skt, *next;
 
   FD_ZERO(&readfds);
   FD_ZERO(&writefds);
   FD_ZERO(&exceptfds);
-  maxfd = 0;
-  for (i = 0; i < FD_SETSIZE; i++) {
-    if (sockets[i] != NULL) {
-      FD_SET(i, &readfds);
-      if (!FifoIsEmpty(sockets[i]->fifo_write)) FD_SET(i, &writefds);
-      FD_SET(i, &exceptfds);
-      maxfd = i;
-    }
+  FD_SET(ServerWake[0], &readfds);
+  maxfd = ServerWake[0];
+  pthread_mutex_lock(&ServerMutex);
+  for (skt = Sockets; skt; skt = skt->next) {
+    if (skt->closing) continue;
+    FD_SET(skt->fd, &readfds);
+    if (!FifoIsEmpty(skt->fifo_write)) FD_SET(skt->fd, &writefds);
+    FD_SET(skt->fd, &exceptfds);
+    if (skt->fd > maxfd) maxfd = skt->fd;
   }
+  pthread_mutex_unlock(&ServerMutex);
   tv.tv_usec = 0;
   tv.tv_sec = 1;
   retcode = select(maxfd+1, &readfds, &writefds, &exceptfds, &tv);
   if (retcode <= 0) return retcode;
-  for (i = 0; i < FD_SETSIZE; i++) {
-    skt = sockets[i];
-    if (FD_ISSET(i, &exceptfds)) {
+  for (skt = Sockets; skt; skt = next) {
+    next = skt->next;
+    if (skt->closing) continue;
+    if (FD_ISSET(skt->fd, &exceptfds)) {
       Dbg(DBGGEN, DBGOK, "%s [%d]: exception", skt->host, skt->fd);
-      SocketFree(skt);
-    } else {
-      if (FD_ISSET(i, &writefds)) {
-        Tool_Server_SelectWrite(skt);
-      }
-      if (FD_ISSET(i, &readfds)) {
-        Tool_Server_SelectRead(skt, ls);
-      }
+      Tool_Server_Close(skt);
+      continue;
     }
-  }
-  return retcode;
-}
-
-/* returns 0 if it is time to exit. */
-Bool Tool_Server_Process(int ls)
-{
-  int  i, retcode;
-  char line[PARAGRAPHLEN];
-  Socket *skt;
-  for (i = 0; i < FD_SETSIZE; i++) {
-    if (sockets[i] != NULL && sockets[i]->fd != ls) {
-      skt = sockets[i];
-      while (1) {
-        if (!SocketReadLine(skt, PARAGRAPHLEN, line)) break;
-        retcode = Tool_Server_ProcessLine(skt, line);
-        if (retcode == -1) {
-          return 0;
-        } else if (retcode == 0) {
-          SocketFree(skt);
-          break;
-        }
-      }
+    if (FD_ISSET(skt->fd, &writefds) && !Tool_Server_SelectWrite(skt)) {
+      continue;
+    }
+    if (FD_ISSET(skt->fd, &readfds)) {
+      Tool_Server_SelectRead(skt, ls);
     }
   }
-  return 1;
+  return retcode;
 }
 
-void Tool_Server_SelectWrite(Socket *skt)
+/* Sends as much of the pending replies as possible per call.
+ * Returns 0 if <skt> was closed.
+ */
+Bool Tool_Server_SelectWrite(Socket *skt)
 {
-  char *buf;
-  int to_write, actually_written;
+  int           n, bufsize, first_removepos;
+  ssize_t       actually_written;
+  char          *buf;
+  Buffer        *first;
+  struct iovec  iov[SERVERMAXIOV];
+  struct msghdr msg;
+  pthread_mutex_lock(&ServerMutex);
   while (1) {
-    FifoRemoveBegin(skt->fifo_write, &buf, &to_write);
-    if (to_write == 0) return;
-    actually_written = send(skt->fd, buf, to_write, 0);
+    FifoLookaheadBegin(skt->fifo_write, &first, &first_removepos);
+    for (n = 0; n < SERVERMAXIOV; n++) {
+      FifoLookaheadNext(skt->fifo_write, &buf, &bufsize, &first,
+                        &first_removepos);
+      if (bufsize == 0) break;
+      iov[n].iov_base = buf;
+      iov[n].iov_len = bufsize;
+    }
+    if (n == 0) break;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = iov;
+    msg.msg_iovlen = n;
+#ifdef MSG_NOSIGNAL
+    actually_written = sendmsg(skt->fd, &msg, MSG_NOSIGNAL);
+#else
+    actually_written = sendmsg(skt->fd, &msg, 0);
+#endif
     if (-1 == actually_written) {
-      if (errno == EWOULDBLOCK) return;
+      if (errno == EWOULDBLOCK) break;
       Dbg(DBGGEN, DBGBAD, "%s [%d]: socket send trouble: %s",
           skt->host, skt->fd,
           strerror(errno));
-      SocketFree(skt);
-      FifoRemoveEnd(skt->fifo_write, 0);
-      return;
+      pthread_mutex_unlock(&ServerMutex);
+      Tool_Server_Close(skt);
+      return 0;
     }
-    FifoRemoveEnd(skt->fifo_write, actually_written);
+    FifoRemove(skt->fifo_write, (long)actually_written);
   }
+  pthread_mutex_unlock(&ServerMutex);
+  Tool_Server_Watch(skt);
+  return 1;
 }
 
 void Tool_Server_SelectRead(Socket *skt, int ls)
 {
   if (skt->fd == ls) {
     Tool_Server_SelectReadListen(skt, ls);
-  } else {
-    Tool_Server_SelectReadConnection(skt);
+  } else if (Tool_Server_SelectReadConnection(skt)) {
+    Tool_Server_Dispatch(skt);
   }
 }
 
@@ -858,36 +1307,41 @@ void Tool_Server_SelectReadListen(Socket *skt, int ls)
   Tool_Server_NewConnection(s);
 }
 
-void Tool_Server_SelectReadConnection(Socket *skt)
+/* Returns 0 if <skt> was closed. */
+Bool Tool_Server_SelectReadConnection(Socket *skt)
 {
   char *buf;
   int space_for, actually_read;
+  pthread_mutex_lock(&ServerMutex);
   while (1) {
     FifoAddBegin(skt->fifo_read, &buf, &space_for);
     actually_read = recv(skt->fd, buf, space_for, 0);
     if (0 == actually_read) {
     /* closed by peer */
-      SocketFree(skt);
-      FifoAddEnd(skt->fifo_read, 0);
-      return;
+      break;
     }
     if (-1 == actually_read) {
-      if (errno == EWOULDBLOCK) return;
+      if (errno == EWOULDBLOCK) {
+        pthread_mutex_unlock(&ServerMutex);
+        return 1;
+      }
       Dbg(DBGGEN, DBGBAD, "%s [%d]: socket recv trouble: %s",
           skt->host, skt->fd,
           strerror(errno));
-      SocketFree(skt);
-      FifoAddEnd(skt->fifo_read, 0);
-      return;
+      break;
     }
     FifoAddEnd(skt->fifo_read, actually_read);
 #ifdef notdef
     /* Enable this on Win32 platform when using Cygnus Cygwin.
      * (Due to failure to map GNU fcntl O_NONBLOCK to Winsock FIONBIO.)
      */
-    return;
+    pthread_mutex_unlock(&ServerMutex);
+    return 1;
 #endif
   }
+  pthread_mutex_unlock(&ServerMutex);
+  Tool_Server_Close(skt);
+  return 0;
 }
 
 void Tool_Server(int port)
@@ -928,14 +1382,22 @@ void Tool_Server(int port)
     return;
   }
 
+  if (!Tool_Server_WorkersStart()) {
+    close(ls);
+    return;
+  }
+
   lskt = SocketCreate(ls, "listen socket", 0);
 
   Dbg(DBGGEN, DBGOK, "server started; port = %d", port);
+#ifdef EPOLL
+  Tool_Server_EpollLoop(ls);
+#else
   Tool_Server_SelectLoop(ls);
+#endif
 
-  for (i = 0; i < FD_SETSIZE; i++) {
-    if (sockets[i] != NULL) SocketFree(sockets[i]);
-  }
+  Tool_Server_WorkersStop();
+  while (Sockets) SocketFree(Sockets);
   Dbg(DBGGEN, DBGOK, "server exited");
 }
 
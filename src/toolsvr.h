@@ -4,10 +4,16 @@ Socket *SocketCreate(int fd, char *host, int bufsize);
 void SocketFree(Socket *skt);
 Bool SocketReadLine(Socket *skt, int linelen, char *line);
 void SocketWrite(Socket *skt, char *s);
+Bool Tool_Server_IsReadOnly(char *cmd);
+void Tool_Server_KBShare(void);
 Bool Tool_Server_ProcessLine(Socket *skt, char *line);
+void Tool_Server_Reply(Socket *skt, int framed);
+Bool Tool_Server_ReplyPending(Socket *skt);
+void Tool_Server_Batch(Socket *skt, char *p, int framed);
 void Tool_Server_Status(Socket *skt, char *p);
 void Tool_Server_ISA(Socket *skt, char *p);
 void Tool_Server_IsPartOf(Socket *skt, char *p);
+void Tool_Server_AncDesc1(Obj *obj, SocketObjs *so);
 void Tool_Server_AncDesc(Socket *skt, char *cmd, char *p);
 void Tool_Server_Retrieve(Socket *skt, char *p);
 void Tool_Server_Assert(Socket *skt, char *p);
@@ -19,11 +25,23 @@ void Tool_Server_Generate(Socket *skt, char *p);
 void Tool_Server_Chatterbot(Socket *skt, char *p);
 void Tool_Server_ClearContext(Socket *skt);
 void Tool_Server_NewConnection(int s);
+void Tool_Server_Enqueue(Socket *skt);
+Socket *Tool_Server_Dequeue(void);
+void Tool_Server_Done(Socket *skt, int retcode);
+void Tool_Server_DiscourseFree(Socket *skt);
+void *Tool_Server_Worker(void *arg);
+Bool Tool_Server_WorkersStart(void);
+void Tool_Server_WorkersStop(void);
+void Tool_Server_Dispatch(Socket *skt);
+void Tool_Server_Close(Socket *skt);
+void Tool_Server_Watch(Socket *skt);
+void Tool_Server_Resume(Socket *skt);
+Bool Tool_Server_Process(void);
+void Tool_Server_EpollLoop(int ls);
 void Tool_Server_SelectLoop(int ls);
 int Tool_Server_ReadAndWrite(int ls);
-Bool Tool_Server_Process(int ls);
-void Tool_Server_SelectWrite(Socket *skt);
+Bool Tool_Server_SelectWrite(Socket *skt);
 void Tool_Server_SelectRead(Socket *skt, int ls);
 void Tool_Server_SelectReadListen(Socket *skt, int ls);
-void Tool_Server_SelectReadConnection(Socket *skt);
+Bool Tool_Server_SelectReadConnection(Socket *skt);
 void Tool_Server(int port);
@@ -728,4 +728,87 @@ void TestGenAttr()
   TestGenAttr1(N("good"));
 }
 
+/* Compares ISA against the uncached walk ISA1 for every loaded object
+ * against a set of classes.
+ */
+void TestIsaBench(FILE *stream)
+{
+  int		i, j, numobjs, numclasses, pass;
+  long		found1, found2, mismatches;
+  Bool		isa, isa1;
+  clock_t	start;
+  double	walk_secs, cache_secs[2];
+  Obj		*obj, **objs, *classes[64];
+
+  for (numobjs = 0, obj = Objs; obj; obj = obj->next) {
+    if (obj->type != OBJTYPELIST) numobjs++;
+  }
+  if (numobjs == 0) return;
+  objs = (Obj **)MemAlloc(numobjs*sizeof(Obj *), "Obj* TestIsaBench");
+  for (i = 0, obj = Objs; obj; obj = obj->next) {
+    if (obj->type != OBJTYPELIST) objs[i++] = obj;
+  }
+  numclasses = 0;
+  classes[numclasses++] = N("concept");
+  classes[numclasses++] = N("human");
+  classes[numclasses++] = N("animal");
+  classes[numclasses++] = N("physical-object");
+  classes[numclasses++] = N("location");
+  classes[numclasses++] = N("polity");
+  classes[numclasses++] = N("action");
+  classes[numclasses++] = N("attribute");
+  classes[numclasses++] = N("media-object");
+  classes[numclasses++] = N("number");
+  classes[numclasses++] = N("F68");
+  classes[numclasses++] = N("script-relation");
+  for (i = 1; numclasses < 32; i++) {
+    classes[numclasses++] = objs[(i*7919) % numobjs];
+  }
+
+  found1 = 0L;
+  start = clock();
+  for (j = 0; j < numclasses; j++) {
+    for (i = 0; i < numobjs; i++) {
+      if (ISA1(classes[j], objs[i], MAXISADEPTH)) found1++;
+    }
+  }
+  walk_secs = ((double)(clock() - start))/CLOCKS_PER_SEC;
+
+  for (pass = 0; pass < 2; pass++) {
+    found2 = 0L;
+    start = clock();
+    for (j = 0; j < numclasses; j++) {
+      for (i = 0; i < numobjs; i++) {
+        if (ISA(classes[j], objs[i])) found2++;
+      }
+    }
+    cache_secs[pass] = ((double)(clock() - start))/CLOCKS_PER_SEC;
+  }
+
+  mismatches = 0L;
+  for (j = 0; j < numclasses; j++) {
+    for (i = 0; i < numobjs; i++) {
+      isa = ISA(classes[j], objs[i]);
+      isa1 = ISA1(classes[j], objs[i], MAXISADEPTH);
+      if (isa != isa1) {
+        if (mismatches == 0L) {
+          fprintf(stream, "MISMATCH ISA(%s, %s) = %d, ISA1 = %d\n",
+                  M(classes[j]), M(objs[i]), isa, isa1);
+        }
+        mismatches++;
+      }
+    }
+  }
+
+  fprintf(stream, "ISA benchmark: %d objects x %d classes, %ld true\n",
+          numobjs, numclasses, found1);
+  fprintf(stream, "walk  %8.3f sec\n", walk_secs);
+  fprintf(stream, "cache %8.3f sec (building), %8.3f sec (built)\n",
+          cache_secs[0], cache_secs[1]);
+  if (mismatches) {
+    fprintf(stream, "%ld pairs differ between ISA and ISA1\n", mismatches);
+  }
+  MemFree(objs, "Obj* TestIsaBench");
+}
+
 /* End of file. */
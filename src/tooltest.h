@@ -18,3 +18,4 @@ void TestGenSpeechActs(void);
 void TestTrip(void);
 void TestGenAttr1(Obj *attr);
 void TestGenAttr(void);
+void TestIsaBench(FILE *stream);
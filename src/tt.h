@@ -410,6 +410,10 @@ typedef unsigned char uc;
 #define LE_WORD_SRCPHRASE	((uc)'')
 #define LE_WHITESPACE		" -\"',;:/()"
 #define LE_NONWHITESPACE	"$%.@"
+
+/* Flags of the word sequences in EnglishPrefixIndex and FrenchPrefixIndex. */
+#define LEPREFIX_WORDS		1L	/* begins a phrase */
+#define LEPREFIX_PHRASE		2L	/* is a phrase */
 #define LE_PHRASE_FEATSEP	"*#+_"
 #define LE_ESCAPE_CHARS		"."
 
@@ -442,20 +446,53 @@ typedef unsigned char uc;
 		((type *) MemAlloc1(sizeof(type),#type,force_malloc))
 #define streq(a,b) \
 	(((a)[0] == (b)[0]) && (strcmp((a),(b)) == 0))
+
+/* For data read without a lock by other server threads (cf ThreadLock). */
+#ifdef GCC
+#define ATOMICLOAD(p)		__atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define ATOMICSTORE(p, v)	__atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#define ATOMICFETCHADD(p, v)	__atomic_fetch_add((p), (v), __ATOMIC_RELAXED)
+#else
+#define ATOMICLOAD(p)		(*(p))
+#define ATOMICSTORE(p, v)	(*(p) = (v))
+#define ATOMICFETCHADD(p, v)	((*(p) += (v)) - (v))
+#endif
 #define HASHSIG		6
-#define DHASHSIG	12
 
-typedef struct HashEntry_s {
-  char	*symbol;
-  char	*value;
-  struct HashEntry_s *next;
-} HashEntry;
+/* Open addressing with linear probing. <size> is always a power of 2 and
+ * the table is doubled once <count> exceeds HASHMAXLOAD of <size>.
+ */
+#define HASHMAXLOAD	0.5
 
 typedef struct {
-  long		size;
-  HashEntry	*hashentries[5];
+  char		*symbol;	/* NULL if slot unused */
+  char		*value;
+  unsigned long	hash;		/* HashTableHash(symbol) */
+} HashEntry;
+
+typedef struct HashTable_s {
+  char			*name;
+  size_t		size;
+  size_t		count;
+  HashEntry		*hashentries;
+  struct HashTable_s	*next;	/* HashTables chain */
 } HashTable;
 
+/* Assertion index keyed on the identity (or, for numbers and strings, the
+ * value) of one or two assertion elements. See DbIndexKey.
+ */
+typedef struct {
+  unsigned long		a, b;
+  struct ObjList_s	*objs;	/* NULL if slot unused */
+} DbIndexEntry;
+
+typedef struct {
+  char		*name;
+  size_t	size;
+  size_t	count;
+  DbIndexEntry	*entries;
+} DbIndex;
+
 #define UNIXTSNA	0
 #define UNIXTSNEGINF	1
 
@@ -578,6 +615,10 @@ typedef struct Obj_s {
       short		maxparents, maxchildren;
       struct Obj_s	**parents;
       struct Obj_s	**children;
+      struct Obj_s	**ancestors;	/* ISA cache, sorted by address */
+      int		numancestors;
+      int		ancepoch;	/* valid if == IsaEpoch */
+      int		id;		/* dense, cf ObjMarks */
     } nlst;
     struct {		/* OBJTYPELIST */
       short		len;
@@ -603,6 +644,29 @@ typedef struct Obj_s {
   struct Obj_s	*prev;	/* linked list of all objects */
 } Obj;
 
+/* Objects visited by one traversal: epochs[id] == epoch. cf ObjMarksBegin. */
+typedef struct ObjMarks_s {
+  int			*epochs;
+  int			len;
+  int			base;	/* labels are epochs[id] - base */
+  int			epoch;
+  struct ObjMarks_s	*next;	/* ObjMarksPool */
+} ObjMarks;
+
+/* Cached ObjShortestPathLen. Links are indices + 1. cf ObjPathCacheGet. */
+typedef struct ObjPathEntry_s {
+  Obj	*from, *to;
+  int	len;
+  int	hnext;		/* hash chain */
+  int	prev, next;	/* most recently used first */
+} ObjPathEntry;
+
+/* Pre-resolved concept used in parsing hot paths. cf ObjHandlesInit. */
+typedef struct ObjHandle_s {
+  Obj	**obj;
+  char	*name;
+} ObjHandle;
+
 typedef struct SP_s {
   Float				score;
   struct PNode_s		*pn;
@@ -714,6 +778,7 @@ typedef struct LexitemList_s {
 } LexitemList;
 
 typedef struct {
+  long		id;		/* index in Corpus articles */
   char		*filename;
   size_t	startpos;
   size_t	stoppos;
@@ -885,10 +950,11 @@ typedef struct PNode_s {
   size_t		upperb;
   size_t		lowerb_subj;
   size_t		upperb_subj;
-  long			versuslen;
-  long			versusmaxlen;
-  PNNumber		*versus;
+  long			seq;		/* Syn_Parse creation order. */
+  long			pairedthru;	/* Paired with neighbors seq < this. */
   char			appliedsingletons;
+  struct PNode_s	*next_startat;	/* Syn_Parse chart: same lowerb. */
+  struct PNode_s	*next_endat;	/* Syn_Parse chart: same upperb. */
   struct PNode_s	*next;		/* Next PNodeList node for sentence. */
   struct PNode_s	*next_altern;	/* Next translation alternative. */
 } PNode;
@@ -907,6 +973,28 @@ typedef struct Demon_s {
   struct Demon_s	*next;
 } Demon;
 
+/* Discrimination tree of the pattern demons of a Context, by predicate and
+ * then by first argument. A NULL key stands for a variable or a list,
+ * which do not discriminate. Cf DemonIndexAdd.
+ */
+typedef struct DemonLeaf_s {
+  Demon			*demon;
+  struct Subgoal_s	*sg;
+  struct DemonLeaf_s	*next;
+} DemonLeaf;
+
+typedef struct DemonArgNode_s {
+  Obj			*arg;
+  DemonLeaf		*leaves;
+  struct DemonArgNode_s	*next;
+} DemonArgNode;
+
+typedef struct DemonPredNode_s {
+  Obj			*pred;
+  DemonArgNode		*args;
+  struct DemonPredNode_s	*next;
+} DemonPredNode;
+
 #define SubgoalStateIsFailure(a) (((a) == STFAILURE)||((a) == STFAILURENOPLAN))
 #define SubgoalStateIsStopped(a) (((a) == STSUCCESS) || \
                                   ((a) == STFAILURE) || \
@@ -928,6 +1016,11 @@ typedef struct Demon_s {
 
 typedef short SubgoalState;
 
+/* Values of queue_i other than heap positions: */
+#define QUEUENONE		-1
+#define QUEUEDEFERRED		-2
+#define QUEUEPARKED		-3
+
 typedef struct Subgoal_s {
   SubgoalState		state;
   struct Subgoal_s	*supergoal;
@@ -951,6 +1044,11 @@ typedef struct Subgoal_s {
   ObjList		*failure_causes;
   Demon			*demons;
   Obj			*trigger;	/* Assertion causing demon to fire. */
+  long			demon_mark;	/* cf DemonPtnTestAll */
+/* Scheduling, cf PA_QueueBefore: */
+  long			order;
+  Ts			queue_ts;
+  int			queue_i;
 /* Temporary within PA_MainLoop, to replace with FINDO: */
   Obj			*hand1, *hand2;
   Obj			*obj1;
@@ -1085,10 +1183,23 @@ typedef struct Actor_s {
   Obj		*rest_level;
   Obj		*energy_level;
   Antecedent    antecedent[DCMAX];      /* Element DCIN (= 0) unused. */
+  long		order;		/* cf PA_QueueBefore */
+  Bool		animal;		/* valid if animal_epoch == IsaLinkEpoch */
+  int		animal_epoch;
   struct Context_s	*cx;
   struct Actor_s	*next;
 } Actor;
 
+/* Heap of the runnable subgoals of a Context. Cf PA_QueueTop. */
+typedef struct SubgoalQueue_s {
+  struct Subgoal_s	**heap;
+  int			len, maxlen;
+  struct Subgoal_s	**deferred;	/* until end of PA_Pass */
+  int			numdeferred, maxdeferred;
+  struct Subgoal_s	**parked;	/* until end of spinning */
+  int			numparked, maxparked;
+} SubgoalQueue;
+
 #define MODE_NA				0
 #define MODE_STOPPED			1
 #define MODE_SPINNING			2
@@ -1120,12 +1231,28 @@ typedef struct {
   Float		novelty;
 } RSN;
 
+/* Path of a Context from ContextRoot, shared by a Context and its first
+ * descendants (cf ContextSprout).
+ */
+typedef struct ContextPath_s {
+  struct Context_s	**cxs;
+  int			len;
+  int			maxlen;
+} ContextPath;
+
 typedef struct Context_s {
   struct Context_s	*parent;
+  int			depth;		/* path->cxs[depth] == this */
+  ContextPath		*path;
   Float			sense;
   TsRange		story_time;	/* = "then"; cf ds_now */
   TenseStep		story_tensestep;
-  Actor			*actors;
+  Actor			*actors;	/* cf ContextActors */
+  Bool			actors_pending;	/* not yet copied from parent */
+  struct Context_s	*pending;	/* children with actors_pending */
+  struct Context_s	*pending_next;
+  DemonPredNode		*demon_index;
+  SubgoalQueue		*queue;
   struct Question_s	*last_question;
   struct Discourse_s	*dc;
   struct Context_s	*next;
@@ -1201,6 +1328,9 @@ typedef struct Channel_s {
   PNodeList	*pnf_holding_area;	/* Used in Corpus processing. */
   PNode		*synparse_pns;		/* PNodes for current sentence. */
   PNNumber	synparse_pnnnext;
+  long		synparse_seqnext;
+  PNode		**synparse_startat;	/* Chart: PNodes by lowerb. */
+  PNode		**synparse_endat;	/* Chart: PNodes by upperb. */
   size_t	synparse_lowerb;
   size_t	synparse_upperb;
   short		synparse_sentences;
@@ -1224,6 +1354,7 @@ typedef struct {
   Dur	timelimit;
   short	recursion_count;
   short	recursion_limit;
+  Bool	stopped;	/* BBrainStopsABrain has returned 1 */
 } ABrainTask;
 
 #define DEICTICSTACKMAX		5
@@ -1288,6 +1419,8 @@ typedef struct Discourse_s {
   short			mode;
   struct Answer_s	*last_answers;
   short			run_agencies;
+  short			understand_workers;	/* cf UnderstandJobsRun */
+  Bool			understand_stopped;	/* last input hit budget */
   Obj			*task;
 /* Deictic stack: */
   short			ds_cur;
@@ -1314,6 +1447,27 @@ typedef struct Discourse_s {
   char			dialects[FEATLEN];
 } Discourse;
 
+/* An understanding alternative deferred to a worker process. */
+typedef struct UnderstandJob_s {
+  Obj				*obj;
+  PNode				*pn;
+  Anaphor			*anaphors;
+  Context			*parent_cx;
+  int				utype;
+  Float				sense;
+  Bool				finished;	/* within the B-Brain budget */
+  struct UnderstandJob_s	*next;
+} UnderstandJob;
+
+/* What a worker process returns for UnderstandJob number <job>. */
+typedef struct {
+  int	job;
+  Bool	finished;
+  Float	sense;
+} UnderstandResult;
+
+#define UNDERSTANDMAXJOBS	1024	/* job numbers fit in one pipe write */
+
 #define GR_IS_VAR(c)	(CharIsUpper((uc)(c)) || CharIsLower((uc)(c)) || \
                          Char_isdigit(c))
 #define GR_VARSEP	':'
@@ -1330,9 +1484,10 @@ typedef struct Discourse_s {
 typedef short GridCoord;
 
 typedef struct Grid_s {
-  GridCoord	rows, cols;
-  char		*m;
-  Obj		*grid;					
+  GridCoord		rows, cols;
+  char			*m;
+  Obj			*grid;					
+  struct SpaceCells_s	*cells;	/* at-grid assertions, cf SpaceCellsEnter */
 } Grid;
 
 typedef struct GridSubspace_s {
@@ -1345,6 +1500,55 @@ typedef struct GridSubspace_s {
   struct GridSubspace_s *next;
 } GridSubspace;
 
+/* A path found by GridFindPath in a cached grid state, cf GridStateGet.
+ * <path> is NULL if there is none.
+ */
+typedef struct GridPathEntry_s {
+  GridCoord		fromrow, fromcol, torow, tocol;
+  char			*wallchars;
+  GridSubspace		*path;
+  struct GridPathEntry_s *next;
+} GridPathEntry;
+
+#define GRIDSTATECACHE	8
+#define GRIDPATHCACHE	32
+
+/* A grid state built by GridBuild, with the paths found in it. */
+typedef struct GridStateEntry_s {
+  Obj			*gridobj, *prop;	/* NULL if unused */
+  Ts			ts;
+  Grid			*state;
+  long			used;
+  int			pathcnt;
+  GridPathEntry		*paths;
+} GridStateEntry;
+
+/* An element of the A* open set heap, cf GridFindPathAstar. */
+typedef struct GridOpen_s {
+  int			f, g, cell;
+} GridOpen;
+
+/* An at-grid assertion entered in a block of SpaceCells. The bounding box
+ * of its subspace is not clipped to the grid.
+ */
+typedef struct SpaceEntry_s {
+  Obj			*assertion;
+  long			seq;	/* DbAssertionCnt, for DbRetrieval order */
+  GridCoord		row1, col1, row2, col2;
+  struct SpaceEntry_s	*next;
+} SpaceEntry;
+
+#define SPACECELL	16
+
+/* The at-grid assertions of a grid, bucketed by SPACECELL x SPACECELL
+ * blocks of cells.
+ */
+typedef struct SpaceCells_s {
+  int		rows, cols;	/* blocks */
+  SpaceEntry	**blocks;
+  SpaceEntry	*unplaced;	/* without a subspace */
+} SpaceCells;
+
 typedef struct IntergridPath_s {
   long		maxlen;
   long		len;
@@ -1352,6 +1556,35 @@ typedef struct IntergridPath_s {
   Obj		**wormholes;
 } IntergridPath;
 
+/* The at-grid assertion of a wormhole in one of the grids it connects,
+ * cf IntergridGraphEnter. <row> <col> is a cell of the wormhole and
+ * <rowdist> <coldist> the cell size of <grid>.
+ */
+typedef struct IntergridDoor_s {
+  Obj				*wormhole, *grid, *assertion;
+  GridCoord			row, col;
+  Float				rowdist, coldist;
+  long				stamp;
+  int				expanded;	/* in search <stamp> */
+  struct IntergridDoor_s	*nextgrid;	/* same IntergridByGrid bucket */
+  struct IntergridDoor_s	*nextworm;	/* same IntergridByWorm bucket */
+} IntergridDoor;
+
+#define INTERGRIDHASH	256
+#define INTERGRIDPATHS	3
+
+/* A partial route of IntergridFindPaths, which entered <grid> through
+ * <door>, or a complete route if <final>.
+ */
+typedef struct IntergridLabel_s {
+  Obj			*grid;
+  IntergridDoor		*door;
+  GridCoord		row, col;
+  Float			cost;
+  int			depth, parent;
+  Bool			final;
+} IntergridLabel;
+
 #define SPACEFAILURE		0
 #define SPACEALREADYNEAR	1
 #define SPACEGRIDPATH		2
@@ -1361,6 +1594,53 @@ typedef struct IntergridPath_s {
 #define DBFILETYPE_ISA		0
 #define	DBFILETYPE_POLITY	1
 
+typedef struct LoadFile_s {
+  char	*fn;
+  int	filetype;	/* DBFILETYPE_* */
+} LoadFile;
+
+/* Snapshot of the loaded database. cf utilsnap.c. */
+#define SNAPMAGIC	"TTSNAP1"
+#define SNAPVERSION	1L
+
+typedef struct SnapHeader_s {
+  char		magic[8];
+  long		version;
+  char		*arena;		/* address the arena must be mapped at */
+  size_t	arenaused;
+  long		arenaoffset;	/* file offset of arena, page aligned */
+  size_t	rootbytes;
+  size_t	numrelocs;
+  char		*exe;		/* address of SnapshotWrite when written */
+  int		anamorph;
+  Bool		savetime;
+  char		langs[FEATLEN];
+  char		dialects[FEATLEN];
+} SnapHeader;
+
+typedef struct SnapRoot_s {
+  void		*addr;
+  size_t	size;
+  char		*name;
+} SnapRoot;
+
+/* Region that memory is carved out of and released all at once.
+ * cf MemArenaCreate.
+ */
+#define MEMARENACLASSES	256	/* free lists for blocks up to 4K */
+
+typedef struct MemArena_s {
+  char		*name;
+  char		*base;
+  size_t	max;		/* bytes reserved */
+  size_t	used;
+  size_t	floor;		/* bytes below this are never released */
+  size_t	high;		/* most used since last released */
+  size_t	peak;		/* most used in one request */
+  char		*freelist[MEMARENACLASSES];
+  Bool		on;
+} MemArena;
+
 typedef struct Answer_s {
 /* Debugging: */
   Obj			*ua;
@@ -1443,6 +1723,30 @@ typedef struct Proof_s {
   struct Proof_s	*next;
 } Proof;
 
+/* Answer table entry for one subgoal of a top-level Prove. See Prove1. */
+#define PROVEACTIVE	1	/* being proved */
+#define PROVECOMPLETE	2	/* r and proofs may be reused */
+#define PROVEINCOMPLETE	3	/* cut short; prove again */
+
+typedef struct ProveEntry_s {
+  Obj			*goal;
+  unsigned long		hash;
+  int			state;
+  int			index;	/* position on stack of active subgoals */
+  Bool			r;
+  Proof			*proofs;
+  struct ProveEntry_s	*next;	/* hash chain */
+} ProveEntry;
+
+typedef struct {
+  size_t		size;
+  size_t		count;
+  ProveEntry		**entries;
+  int			height;		/* number of active subgoals */
+  int			low;		/* lowest active subgoal cut off */
+  long			cutoffs;	/* MAXDEPTH cutoffs */
+} ProveTable;
+
 typedef struct Stat_s {
   long		sum;
   long		total;
@@ -1508,8 +1812,65 @@ typedef struct AnagramClass_s {
   struct AnagramClass_s	*next;
 } AnagramClass;
 
+/* On-disk corpus index (cf CorpusIdxWrite):
+ *   CorpusIdxHeader
+ *   postings: per term, varint (article id delta, offset delta) pairs,
+ *             the offset delta restarting from 0 at each new article
+ *   strings
+ *   CorpusIdxFile[numfiles], sorted by filename
+ *   CorpusIdxArticle[numarticles]
+ *   CorpusIdxTerm[numterms], sorted by word
+ * Offsets of postings and strings are relative to the start of their
+ * sections.
+ */
+typedef struct {
+  char		magic[8];
+  long		numfiles, numarticles, numterms;
+  long		postings, strings, files, articles, terms;
+  long		len;
+} CorpusIdxHeader;
+
+typedef struct {
+  long		fn;
+  long		size;
+  long		mtime;
+} CorpusIdxFile;
+
+typedef struct {
+  long		file;
+  long		startpos;
+  long		stoppos;
+  long		unixts;
+  long		flag;
+  long		speaker;	/* -1 if none */
+} CorpusIdxArticle;
+
+typedef struct {
+  long		word;
+  long		postings;
+  long		count;
+} CorpusIdxTerm;
+
+typedef struct CorpusIdx_s {
+  char			fn[FILENAMELEN];
+  char			*base;
+  size_t		len;
+  CorpusIdxHeader	*hdr;
+  CorpusIdxFile		*files;
+  CorpusIdxArticle	*articles;
+  CorpusIdxTerm		*terms;
+  char			*strings;
+  Article		**loaded;	/* by article id, as used */
+  char			**maps;		/* source files, by file id */
+  struct CorpusIdx_s	*next;
+} CorpusIdx;
+
 typedef struct {
   HashTable		*ht;
+  Article		**articles;	/* indexed into ht */
+  long			numarticles;
+  long			maxarticles;
+  CorpusIdx		*idxs;
 } Corpus;
 
 typedef struct CorpusWordList_s {
@@ -1518,6 +1879,17 @@ typedef struct CorpusWordList_s {
   struct CorpusWordList_s	*next;
 } CorpusWordList;
 
+typedef struct {
+  char			*word;
+  CorpusWordList	*cwl;
+  CorpusIdx		*idx;
+  unsigned char		*p;
+  long			left;		/* -1 if idx not yet looked up */
+  long			article;
+  long			offset;
+  CorpusWordList	cur;
+} CorpusCursor;
+
 #define LEARN_INTXT_LEN	75L
 
 typedef struct LearnFile_s {
@@ -1632,8 +2004,51 @@ typedef struct {
   long		len;
   size_t	*positions;
   char		*firstchars;	/* Used only as a check. */
+  char		**words;
+  char		**tags;		/* Penn Treebank tags assigned by tagger */
+  Bool		*guessed;	/* tag is from TaggerTagUnknown */
 } TaggerWords;
 
+/* Contextual rule of a Brill tagger: change tag <from> to <to> if the
+ * context matches <template> and its arguments, such as
+ * "NN VB PREVTAG TO".
+ */
+typedef struct {
+  char		*from;
+  char		*to;
+  int		template;	/* TAGGER_PREVTAG ... */
+  char		*arg1;
+  char		*arg2;
+} TaggerRule;
+
+/* Templates of contextual rules, in the order of TaggerTemplates. */
+#define TAGGER_PREVTAG		1
+#define TAGGER_NEXTTAG		2
+#define TAGGER_PREV2TAG		3
+#define TAGGER_NEXT2TAG		4
+#define TAGGER_PREV1OR2TAG	5
+#define TAGGER_NEXT1OR2TAG	6
+#define TAGGER_PREV1OR2OR3TAG	7
+#define TAGGER_NEXT1OR2OR3TAG	8
+#define TAGGER_SURROUNDTAG	9
+#define TAGGER_PREVBIGRAM	10
+#define TAGGER_NEXTBIGRAM	11
+#define TAGGER_CURWD		12
+#define TAGGER_PREVWD		13
+#define TAGGER_NEXTWD		14
+#define TAGGER_PREV2WD		15
+#define TAGGER_NEXT2WD		16
+#define TAGGER_PREV1OR2WD	17
+#define TAGGER_NEXT1OR2WD	18
+#define TAGGER_WDPREVTAG	19
+#define TAGGER_WDNEXTTAG	20
+#define TAGGER_WDAND2BFR	21
+#define TAGGER_WDAND2AFT	22
+#define TAGGER_WDAND2TAGBFR	23
+#define TAGGER_WDAND2TAGAFT	24
+#define TAGGER_LBIGRAM		25
+#define TAGGER_RBIGRAM		26
+
 typedef struct {
   size_t        size;
   char          *typ;
@@ -1657,9 +2072,23 @@ typedef struct Socket_s {
   char      *host;
   Fifo      *fifo_read;
   Fifo      *fifo_write;
+  Fifo      *fifo_reply;	/* reply to the current request */
+  int       batch;	/* requests left in the current batch */
+  int       batchn;	/* requests in the current batch */
   Discourse *dc;
+  Bool      busy;		/* a worker has it */
+  Bool      closing;	/* free once no worker has it */
+  int       retcode;	/* of the worker's last request */
+  int       events;	/* polled for */
+  struct Socket_s *next, *prev;	/* all sockets */
+  struct Socket_s *next_queued;	/* awaiting a worker */
 } Socket;
 
+typedef struct {
+  Socket    *skt;
+  Bool      first;	/* nothing written yet */
+} SocketObjs;
+
 typedef struct CaseElementLink_s {
   Obj                      *pred;
   char                     *label;
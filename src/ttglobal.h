@@ -19,14 +19,46 @@ extern FILE		*TranslateStream;
 extern Ts		TsNA;
 extern TsRange		TsRangeAlways;
 extern Obj		*Me, *ObjWild, *ObjNA, *Objs, *DbgLastObj, *OBJDEFER;
+extern Obj		*N_F63, *N_F68, *N_F71, *N_F72, *N_F100, *N_F101,
+  *N_F102, *N_eng_infl_tense_of, *N_eng_infl_mood_of, *N_auxiliary_verb,
+  *N_progressive_tense, *N_infinitive, *N_imperative, *N_expl, *N_aobj,
+  *N_subj, *N_obj, *N_iobj, *N_tsrobj, *N_spatial, *N_spatial_preposition,
+  *N_location_interrogative_pronoun, *N_noun_phrase_pronoun,
+  *N_relative_pronoun, *N_determining_interrogative_pronoun, *N_copula,
+  *N_appearance_copula, *N_action, *N_object_interrogative_pronoun,
+  *N_intervention, *N_such_that, *N_determiner_article, *N_relation, *N_one,
+  *N_pronoun_there_expletive, *N_and, *N_or, *N_not, *N_nonhuman, *N_human,
+  *N_location, *N_physical_object, *N_polity, *N_number, *N_list, *N_string,
+  *N_time_range, *N_concept, *N_parse, *N_generate, *N_title, *N_human_name,
+  *N_X_MAX, *N_Y_MAX, *N_W_MAX, *N_prep_adjunct_OK;
+extern long		NameToObjCnt;
 extern ObjList		*OBJLISTDEFER, *OBJLISTRULEDOUT;
 extern ObjList		*Sem_ParseResults;
 extern Context		*ContextRoot;
 extern HashTable	*FrenchIndex, *EnglishIndex, *SpellIndex;
+extern HashTable	*FrenchPrefixIndex, *EnglishPrefixIndex;
+extern char		*TaggerModelDir;
 extern LexEntry		*AllLexEntries;
 extern Word		*NewInflections;
 extern Discourse	*StdDiscourse;
 extern Discourse	*ContextCurrentDc;
 extern Corpus		*CorpusFrench;
+extern char		*SnapshotReadFn, *SnapshotWriteFn;
+extern Bool		SnapshotLoaded;
+extern LoadFile		LoadFiles[];
+extern MemArena		MemArenaKB, MemArenaScratch;
+extern Bool		MemArenaReport, ThreadsOn;
+extern HashTable	*HashTables, *ObjHash, *WordFormHt, *AnaMorphHt;
+extern Obj		*Objs;
+extern int		IsaEpoch, IsaLinkEpoch, StringGenNext, ObjNextId;
+extern long		ObjParentLinkCnt, DbAssertionCnt, ContextNextTopId;
+extern Bool		IncreaseMsg, WordFormTrained;
+extern DbIndex		*DbIndex01, *DbIndex02, *DbIndex0, *DbIndex1, *DbIndex2;
+extern Affix		*WordForm2Suffixes, *WordForm2Prefixes;
+extern int		WordForm2EnglishSuffixesCnt, WordForm2EnglishPrefixesCnt;
+extern int		WordForm2FrenchSuffixesCnt, WordForm2FrenchPrefixesCnt;
+extern AnaMorphClass	*AnaMorphClassAll;
+extern ObjList		*InferenceRules, *ActivationRules, *ProofRules;
+extern Bool		InferenceOn;
 
 /* End of file. */
@@ -20,6 +20,8 @@
  *           individual UAs.
  * 19951210: Integrated Syn_Parse, Sem_Parse, and Sem_Anaphora. They now
  *           all work in "parallel" on a parse. This should reduce search.
+ * 20261018T020000: understanding alternatives in worker processes
+ * 20261019T010000: workers forked once per input
  */
 
 #include "tt.h"
@@ -60,6 +62,11 @@
 #include "utildbg.h"
 #include "utillrn.h"
 
+#ifdef GCC
+#include <sys/time.h>
+#include <sys/wait.h>
+#endif
+
 void UA_Actor(Discourse *dc, Context *cx, Obj *in)
 {
   int	i, len;
@@ -138,7 +145,7 @@ void UnderstandRunActorUAs(Discourse *dc, Context *cx, Obj *in,
 {
   Actor	*ac;
   UA_Actor(dc, cx, in);	/* add RSN results to this */
-  for (ac = cx->actors; ac; ac = ac->next) {
+  for (ac = ContextActors(cx); ac; ac = ac->next) {
     if (!ISA(N("animal"), ac->actor)) continue;
     UnderstandRunActorUAs1(dc, cx, ac, in, numer, denom);
   }
@@ -328,35 +335,301 @@ Bool UA_CanOnlyBeQuestionConcept(Obj *obj)
          ISADeep(N("question-word"), obj));
 }
 
-void UnderstandAsQuestion(Discourse *dc, Obj *obj, PNode *pn, int eoschar,
-                          Anaphor *anaphors, Context *parent_cx,
-                          /* INPUT AND RESULTS */ Context **children_cxs_p)
+/* Understanding statistics (cf UnderstandStatsPrint). */
+long	UnderstandAlternativesRun, UnderstandAlternativesFinished;
+long	UnderstandAlternativesForked;
+double	UnderstandWallSecs;
+
+double UnderstandWallClock()
 {
-  Context	*child_cx;
+#ifdef GCC
+  struct timeval	tv;
+  gettimeofday(&tv, NULL);
+  return(tv.tv_sec + tv.tv_usec/1000000.0);
+#else
+  return((double)time(NULL));
+#endif
+}
+
+void UnderstandStatsPrint(FILE *stream)
+{
+  fprintf(stream, "%ld understanding alternative(s)\n",
+          UnderstandAlternativesRun);
+  fprintf(stream, "%10ld finished within budget\n",
+          UnderstandAlternativesFinished);
+  fprintf(stream, "%10ld run in worker processes\n",
+          UnderstandAlternativesForked);
+  fprintf(stream, "%10.3f sec understanding (wall)\n", UnderstandWallSecs);
+  UnderstandAlternativesRun = UnderstandAlternativesFinished = 0L;
+  UnderstandAlternativesForked = 0L;
+  UnderstandWallSecs = 0.0;
+}
 
-  *children_cxs_p = child_cx =
-    ContextSprout(parent_cx, obj, pn, *children_cxs_p);
+/* Sprouts a child of <parent_cx> in which to understand <obj>, and
+ * returns it.
+ */
+Context *UnderstandAs(Discourse *dc, Obj *obj, PNode *pn, int eoschar,
+                      Anaphor *anaphors, Context *parent_cx, int utype,
+                      Context *next)
+{
+  Context	*child_cx;
+  child_cx = ContextSprout(parent_cx, obj, pn, next);
   child_cx->anaphors = anaphors;
   ObjSetTsRangeContext(obj, child_cx);
   child_cx->answer = NULL;	/* not needed? */
-  child_cx->sense = UnderstandUtterance1(dc, child_cx, obj, eoschar,
-                                         UT_QUESTION, &child_cx->answer);
+  if (utype == UT_QUESTION) {
+    child_cx->sense = UnderstandUtterance1(dc, child_cx, obj, eoschar,
+                                           UT_QUESTION, &child_cx->answer);
+  } else {
+    child_cx->sense = UnderstandUtterance1(dc, child_cx, obj, eoschar,
+                                           UT_STATEMENT, NULL);
+  }
   UA_Asker(child_cx, dc);
+  return(child_cx);
+}
+
+/* While UnderstandJobsCollecting, UnderstandAsQuestion and
+ * UnderstandAsStatement defer alternatives to UnderstandJobs instead of
+ * understanding them (cf UnderstandAlternatives).
+ */
+Bool		UnderstandJobsCollecting;
+UnderstandJob	*UnderstandJobs;
+
+void UnderstandAs1(Discourse *dc, Obj *obj, PNode *pn, int eoschar,
+                   Anaphor *anaphors, Context *parent_cx, int utype,
+                   /* INPUT AND RESULTS */ Context **children_cxs_p)
+{
+  UnderstandJob	*job;
+  if (UnderstandJobsCollecting) {
+    job = CREATE(UnderstandJob);
+    job->obj = obj;
+    job->pn = pn;
+    job->anaphors = anaphors;
+    job->parent_cx = parent_cx;
+    job->utype = utype;
+    job->sense = FLOATNEGINF;
+    job->finished = 0;
+    job->next = UnderstandJobs;
+    UnderstandJobs = job;
+    return;
+  }
+  *children_cxs_p = UnderstandAs(dc, obj, pn, eoschar, anaphors, parent_cx,
+                                 utype, *children_cxs_p);
+  UnderstandAlternativesRun++;
+  if (dc->abt == NULL || !dc->abt->stopped) UnderstandAlternativesFinished++;
+}
+
+void UnderstandAsQuestion(Discourse *dc, Obj *obj, PNode *pn, int eoschar,
+                          Anaphor *anaphors, Context *parent_cx,
+                          /* INPUT AND RESULTS */ Context **children_cxs_p)
+{
+  UnderstandAs1(dc, obj, pn, eoschar, anaphors, parent_cx, UT_QUESTION,
+                children_cxs_p);
 }
 
 void UnderstandAsStatement(Discourse *dc, Obj *obj, PNode *pn, int eoschar,
                            Anaphor *anaphors, Context *parent_cx,
                            /* INPUT AND RESULTS */ Context **children_cxs_p)
 {
-  Context	*child_cx;
+  UnderstandAs1(dc, obj, pn, eoschar, anaphors, parent_cx, UT_STATEMENT,
+                children_cxs_p);
+}
 
-  *children_cxs_p = child_cx =
-    ContextSprout(parent_cx, obj, pn, *children_cxs_p);
-  child_cx->anaphors = anaphors;
-  ObjSetTsRangeContext(obj, child_cx);
-  child_cx->sense = UnderstandUtterance1(dc, child_cx, obj, eoschar,
-                                         UT_STATEMENT, NULL);
-  UA_Asker(child_cx, dc);
+/* Worker processes
+ *
+ * With -undworkers <n> (dc->understand_workers), the alternatives of an
+ * input in a context are collected as UnderstandJobs instead of being
+ * understood one after another. Workers are only used when the last input
+ * ran out of B-Brain budget (dc->understand_stopped), or when there are
+ * more alternatives than <n> and more than one CPU to run them on; with
+ * alternatives that take well under a millisecond each, as in the
+ * examples, forking costs more than it saves. Then up to <n> worker processes are forked once for the
+ * input. They take job numbers from one pipe, understand each job with a
+ * budget of its own, and write an UnderstandResult per job to another
+ * pipe, until no job numbers are left. A worker has its own copy of the
+ * database, Contexts, and Actors, so whatever it asserts is discarded
+ * when it exits. The alternative ContextPrune would keep, that with the
+ * greatest sense, is then understood again in this process, so that only
+ * its assertions are committed. Since the other alternatives are not
+ * understood here, their assertions, learning, and commentary are lost,
+ * which is why this is not the default. Otherwise the jobs are understood
+ * here in the order they were collected, as without workers.
+ * Not used when other threads are running (ThreadsOn), since only the
+ * forking thread survives in the worker.
+ */
+
+/* Whether an alternative of the current input ran out of budget in a
+ * worker (cf Understand).
+ */
+Bool	UnderstandJobsUnfinished;
+
+int UnderstandCPUs()
+{
+#ifdef GCC
+  long	n;
+  if (0 < (n = sysconf(_SC_NPROCESSORS_ONLN))) return((int)n);
+#endif
+  return(1);
+}
+
+Bool UnderstandParallel(Discourse *dc)
+{
+#ifdef GCC
+  return(dc->understand_workers > 1 && !ThreadsOn &&
+         (dc->understand_stopped || UnderstandCPUs() > 1));
+#else
+  return(0);
+#endif
+}
+
+#ifdef GCC
+/* Runs in the worker process. */
+void UnderstandWorker(Discourse *dc, UnderstandJob **jobs, int eoschar,
+                      int jobfd, int resultfd)
+{
+  int			i, devnull;
+  Context		*cx;
+  UnderstandResult	r;
+  if (0 <= (devnull = open("/dev/null", O_WRONLY))) {
+  /* Keep the worker from writing to the log and output channels. */
+    dup2(devnull, fileno(stdout));
+    dup2(devnull, fileno(stderr));
+    if (Log) dup2(devnull, fileno(Log));
+    for (i = 0; i < DCMAX; i++) {
+      if (dc->channel[i].stream) dup2(devnull, fileno(dc->channel[i].stream));
+    }
+  }
+  while (sizeof(i) == read(jobfd, &i, sizeof(i))) {
+    dc->abt = BBrainBegin(N("understand"), 60L, 10);
+    cx = UnderstandAs(dc, jobs[i]->obj, jobs[i]->pn, eoschar,
+                      jobs[i]->anaphors, jobs[i]->parent_cx, jobs[i]->utype,
+                      NULL);
+    r.job = i;
+    r.finished = !dc->abt->stopped;
+    r.sense = cx->sense;
+    BBrainEnd(dc->abt);
+    if (sizeof(r) != write(resultfd, &r, sizeof(r))) _exit(1);
+  }
+  _exit(0);
+}
+
+/* Understands the <njobs> <jobs> in up to <nworkers> worker processes,
+ * filling in their sense. Returns the number of workers forked.
+ */
+int UnderstandWorkersRun(Discourse *dc, UnderstandJob **jobs, int njobs,
+                         int nworkers, int eoschar)
+{
+  int			i, forked, status, jobfds[2], resultfds[2], *nums, *pids;
+  ssize_t		len, n;
+  UnderstandResult	r;
+  if (pipe(jobfds) < 0) return(0);
+  if (pipe(resultfds) < 0) {
+    close(jobfds[0]);
+    close(jobfds[1]);
+    return(0);
+  }
+  /* Since njobs <= UNDERSTANDMAXJOBS, all job numbers fit in the pipe
+   * before any worker reads them, and the workers see end of file once
+   * they are taken.
+   */
+  nums = (int *)MemAlloc(njobs*sizeof(int), "int UnderstandWorkersRun");
+  for (i = 0; i < njobs; i++) nums[i] = i;
+  len = write(jobfds[1], nums, njobs*sizeof(int));
+  MemFree(nums, "int UnderstandWorkersRun");
+  close(jobfds[1]);
+  if (len != (ssize_t)(njobs*sizeof(int))) {
+    close(jobfds[0]);
+    close(resultfds[0]);
+    close(resultfds[1]);
+    return(0);
+  }
+  pids = (int *)MemAlloc(nworkers*sizeof(int), "int UnderstandWorkersRun");
+  fflush(NULL);
+  for (forked = 0; forked < nworkers; forked++) {
+    if ((pids[forked] = fork()) < 0) break;
+    if (pids[forked] == 0) {
+      close(resultfds[0]);
+      UnderstandWorker(dc, jobs, eoschar, jobfds[0], resultfds[1]);
+    }
+  }
+  close(jobfds[0]);
+  close(resultfds[1]);
+  while (1) {
+    for (len = 0; len < (ssize_t)sizeof(r); len += n) {
+      if (0 >= (n = read(resultfds[0], ((char *)&r)+len, sizeof(r)-len))) {
+        break;
+      }
+    }
+    if (len != (ssize_t)sizeof(r)) break;
+    if (r.job < 0 || r.job >= njobs) continue;
+    jobs[r.job]->sense = r.sense;
+    jobs[r.job]->finished = r.finished;
+    UnderstandAlternativesForked++;
+  }
+  close(resultfds[0]);
+  for (i = 0; i < forked; i++) waitpid(pids[i], &status, 0);
+  MemFree(pids, "int UnderstandWorkersRun");
+  return(forked);
+}
+#endif
+
+/* Understands <jobs>, the last collected first (cf UnderstandAs1), either
+ * in worker processes and then the best of them here, or all of them here
+ * one after another.
+ */
+void UnderstandJobsRun(Discourse *dc, UnderstandJob *jobs, int eoschar,
+                       /* INPUT AND RESULTS */ Context **children_cxs_p)
+{
+  int		i, njobs, nworkers;
+  UnderstandJob	*job, **a, *best;
+  njobs = 0;
+  for (job = jobs; job; job = job->next) njobs++;
+  if (njobs == 0) return;
+  a = (UnderstandJob **)MemAlloc(njobs*sizeof(UnderstandJob *),
+                                 "UnderstandJob* UnderstandJobsRun");
+  i = njobs;
+  for (job = jobs; job; job = job->next) a[--i] = job;
+  nworkers = 0;
+#ifdef GCC
+  if (njobs > 1 && njobs <= UNDERSTANDMAXJOBS &&
+      (dc->understand_stopped ||
+       (njobs > dc->understand_workers && UnderstandCPUs() > 1))) {
+    nworkers = UnderstandWorkersRun(dc, a, njobs,
+                                    IntMin(njobs, dc->understand_workers),
+                                    eoschar);
+    if (nworkers == 0) {
+      Dbg(DBGUA, DBGBAD, "understanding workers not started");
+    }
+  }
+#endif
+  if (nworkers > 0) {
+  /* As in ContextFindBest, in the order of the Contexts the jobs stand
+   * for.
+   */
+    best = NULL;
+    for (i = njobs-1; i >= 0; i--) {
+      if (a[i]->sense == FLOATNEGINF) {
+        Dbg(DBGUA, DBGBAD, "understanding alternative %d lost", i);
+        continue;
+      }
+      UnderstandAlternativesRun++;
+      if (a[i]->finished) UnderstandAlternativesFinished++;
+      else UnderstandJobsUnfinished = 1;
+      if (best == NULL || a[i]->sense > best->sense) best = a[i];
+    }
+    if (best) {
+      *children_cxs_p = UnderstandAs(dc, best->obj, best->pn, eoschar,
+                                     best->anaphors, best->parent_cx,
+                                     best->utype, *children_cxs_p);
+    }
+  } else {
+    for (i = 0; i < njobs; i++) {
+      UnderstandAs1(dc, a[i]->obj, a[i]->pn, eoschar, a[i]->anaphors,
+                    a[i]->parent_cx, a[i]->utype, children_cxs_p);
+    }
+  }
+  for (i = 0; i < njobs; i++) MemFree(a[i], "UnderstandJob");
+  MemFree(a, "UnderstandJob* UnderstandJobsRun");
 }
 
 void UnderstandAlternative(Discourse *dc, ObjList *p, Obj *obj, ObjList *q,
@@ -389,10 +662,15 @@ void UnderstandAlternative(Discourse *dc, ObjList *p, Obj *obj, ObjList *q,
 void UnderstandAlternatives(Discourse *dc, ObjList *in_objs, int eoschar,
                             /* RESULTS */ Context **children_cxs_r)
 {
+  Bool		parallel;
   ObjList	*p, *q, *objs, *done;
   Context	*parent_cx, *children_cxs;
   children_cxs = NULL;
   done = NULL;
+  if ((parallel = UnderstandParallel(dc))) {
+    UnderstandJobsCollecting = 1;
+    UnderstandJobs = NULL;
+  }
   for (p = in_objs; p; p = p->next) {
     if (ISADeep(N("auxiliary-verb"), p->obj)) continue;
     parent_cx = dc->cx_cur;
@@ -410,6 +688,11 @@ void UnderstandAlternatives(Discourse *dc, ObjList *in_objs, int eoschar,
     }
     Dbg(DBGUA, DBGDETAIL, "**** UNDERSTANDING AGENCY END ****");
   }
+  if (parallel) {
+    UnderstandJobsCollecting = 0;
+    UnderstandJobsRun(dc, UnderstandJobs, eoschar, &children_cxs);
+    UnderstandJobs = NULL;
+  }
   ObjListFree(done);
   *children_cxs_r = children_cxs;
 }
@@ -535,6 +818,7 @@ ObjList *Understand_SpeechAct(ObjList *objs, Discourse *dc)
 
 void Understand(Discourse *dc, ObjList *in_objs, int eoschar)
 {
+  double	start;
   Context	*children_cxs;
 
   if (in_objs == NULL) return;
@@ -542,10 +826,14 @@ void Understand(Discourse *dc, ObjList *in_objs, int eoschar)
 
   in_objs = Understand_SpeechAct(in_objs, dc);
 
+  start = UnderstandWallClock();
   dc->abt = BBrainBegin(N("understand"), 60L, 10);
+  UnderstandJobsUnfinished = 0;
   UnderstandAlternatives(dc, in_objs, eoschar, &children_cxs);
+  dc->understand_stopped = dc->abt->stopped || UnderstandJobsUnfinished;
   BBrainEnd(dc->abt);
   dc->abt = NULL;
+  UnderstandWallSecs += UnderstandWallClock()-start;
 
   dc->cx_children = ContextAppendDestructive(dc->cx_children, children_cxs);
 }
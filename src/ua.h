@@ -14,8 +14,17 @@ Float UnderstandUtterance2(Discourse *dc, Context *cx, Obj *obj, int eoschar, in
 Float UnderstandUtterance1(Discourse *dc, Context *cx, Obj *in, int eoschar, int utype, Answer **an);
 void UA_Infer(Discourse *dc, Context *cx, Ts *ts, Obj *in, Obj *justification);
 Bool UA_CanOnlyBeQuestionConcept(Obj *obj);
+double UnderstandWallClock(void);
+void UnderstandStatsPrint(FILE *stream);
+Context *UnderstandAs(Discourse *dc, Obj *obj, PNode *pn, int eoschar, Anaphor *anaphors, Context *parent_cx, int utype, Context *next);
+void UnderstandAs1(Discourse *dc, Obj *obj, PNode *pn, int eoschar, Anaphor *anaphors, Context *parent_cx, int utype, Context **children_cxs_p);
 void UnderstandAsQuestion(Discourse *dc, Obj *obj, PNode *pn, int eoschar, Anaphor *anaphors, Context *parent_cx, Context **children_cxs_p);
 void UnderstandAsStatement(Discourse *dc, Obj *obj, PNode *pn, int eoschar, Anaphor *anaphors, Context *parent_cx, Context **children_cxs_p);
+int UnderstandCPUs(void);
+Bool UnderstandParallel(Discourse *dc);
+void UnderstandWorker(Discourse *dc, UnderstandJob **jobs, int eoschar, int jobfd, int resultfd);
+int UnderstandWorkersRun(Discourse *dc, UnderstandJob **jobs, int njobs, int nworkers, int eoschar);
+void UnderstandJobsRun(Discourse *dc, UnderstandJob *jobs, int eoschar, Context **children_cxs_p);
 void UnderstandAlternative(Discourse *dc, ObjList *p, Obj *obj, ObjList *q, int eoschar, Context *parent_cx, Context **children_cxs_r);
 void UnderstandAlternatives(Discourse *dc, ObjList *in_objs, int eoschar, Context **children_cxs_r);
 void UnderstandSwitchAndPrune(Discourse *dc, Context *children_cxs, int eoschar);
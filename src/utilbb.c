@@ -27,6 +27,7 @@ ABrainTask *BBrainBegin(Obj *process, Dur timelimit, int recursion_limit)
   TsIncrement(&abt->timeoutts, timelimit);
   abt->recursion_count = 0;
   abt->recursion_limit = recursion_limit;
+  abt->stopped = 0;
   return(abt);
 }
 
@@ -53,10 +54,12 @@ Bool BBrainStopsABrain(ABrainTask *abt)
    */
     Dbg(DBGGEN, DBGBAD, "B-brain stops A-brain working on <%s> (> %ld secs)",
         M(abt->process), abt->timelimit);
+    abt->stopped = 1;
     return(1);
   }
   if (abt->recursion_limit != INTNA &&
       abt->recursion_count > abt->recursion_limit) {
+    abt->stopped = 1;
     return(1);
   }
   return(0);
@@ -6,6 +6,7 @@
  * 19940313: begun
  * 19940419: modified for levels and flags
  * 19981112: fix to DbgLogClear
+ * 20261017T200000: Log lines are written whole by server threads
  */
 
 #include "tt.h"
@@ -126,6 +127,9 @@ void Dbg(int flag, int level, char *fmt, ...)
     fputc(NEWLINE, stdout);
   }
   if (Log && DbgOn(flag, level)) {
+#ifdef GCC
+    flockfile(Log);	/* one line at a time from server threads */
+#endif
     TsPrint(Log, &ts);
     fputs(": ", Log);
     if (level <= DBGBAD) {
@@ -135,6 +139,9 @@ void Dbg(int flag, int level, char *fmt, ...)
     fputs(buf, Log);
     fputc(NEWLINE, Log);
     fflush(Log);
+#ifdef GCC
+    funlockfile(Log);
+#endif
   }
   if (Interrupt) {
     Interrupt = 0;
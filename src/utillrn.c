@@ -9,6 +9,7 @@
  * 19950206: names
  * 19950221: learning humans, names, media objects, input_text, cleanup
  * 19950223: modified for multiple learn files
+ * 20261017T160000: learned objects are never scratch memory
  *
  * Learning is twofold:
  * (1) DUMPing to outlrn.txt file.
@@ -234,10 +235,12 @@ void LearnObjLeUPDATE(char *le_text, char *features, Obj *obj)
   char		le_text1[PHRASELEN];
   ht = LexEntryLangHt(features);
   StringCopyExcept(le_text, TREE_ESCAPE, WORDLEN, le_text1);
+  MemScratchSuspend();
   if (!(le = LexEntryFindInfl(le_text1, features, ht, 0))) {
     le = LexEntryNewWord(le_text1, features, obj, ht);
   }
   LexEntryLinkToObj(le, obj, features, ht, NULL, 0, NULL, NULL, NULL);
+  MemScratchResume();
 }
 
 void LearnNameLeUPDATE(Name *nm, int gender, Obj *human)
@@ -465,6 +468,10 @@ void LearnObjClass(Obj *obj, Obj *was_class, Obj *is_class)
 
 /* HIGHER-LEVEL LEARNING FUNCTIONS */
 
+/* These suspend scratch memory, since what is learned outlives the current
+ * request.
+ */
+
 Obj *LearnName(char *name, Obj *class, int gender, char *input_text,
                Discourse *dc)
 {
@@ -495,9 +502,11 @@ Obj *LearnName(char *name, Obj *class, int gender, char *input_text,
     feat2 = "Ny";
   }
   create_flag = OBJ_CREATE_A;
+  MemScratchSuspend();
   obj = ObjCreateInstanceNamed(parent, objname, create_flag);
   /* todo: name=>LexEntryPhraseToDbFile=>name if several words? */
   LearnObj(parent, obj, name, feat1, feat2, 0, create_flag, input_text, dc);
+  MemScratchResume();
   return(obj);
 }
 
@@ -535,9 +544,11 @@ Obj *LearnObjText(Obj *parent, char *text, int gender, int number, int pos,
   char		le[PHRASELEN+20], feat[FEATLEN], *p;
   HashTable	*ht;
   ht = LexEntryLangHt1(lang);
+  MemScratchSuspend();
   obj = ObjCreateInstanceText(parent, text, existing_ok, create_flag, &is_le0,
                               &existing);
   if (existing) {
+    MemScratchResume();
     return(obj);
   }
   LexEntryPhraseToDbFile(text, gender, pos, number, lang, ht, PHRASELEN+20, le);
@@ -552,6 +563,7 @@ Obj *LearnObjText(Obj *parent, char *text, int gender, int number, int pos,
                dc);
   LexEntryPhraseRead(le, feat, obj, gender, pos, number, lang, ht);
     /* This is called second because it steps on <le>. */
+  MemScratchResume();
   return(obj);
 }
 
@@ -565,6 +577,7 @@ Obj *LearnObjToken(Obj *parent, char *text, char *input_text, Discourse *dc)
 {
   char		*feat1, *feat2, le[PHRASELEN+20];
   Obj		*obj;
+  MemScratchSuspend();
   obj = StringToObj(text, parent, 1);
   feat1 = "Nz";
   feat2 = "Ny";
@@ -575,6 +588,7 @@ Obj *LearnObjToken(Obj *parent, char *text, char *input_text, Discourse *dc)
                      EnglishIndex);
   LexEntryPhraseRead(le, feat2, obj, F_NULL, F_NOUN, F_SINGULAR, F_FRENCH,
                      FrenchIndex);
+  MemScratchResume();
   return(obj);
 }
 
@@ -622,6 +636,7 @@ Obj *LearnHuman(Name *nm, char *input_text, Discourse *dc, /* RESULTS */
   int		is_le0;
   Obj		*new_human, *sex, *nationality, *new_assertion;
   ObjList	*sex_just, *nation_just;
+  MemScratchSuspend();
   if (nm == NULL) {
     /* todo: Later learning of this name. */
     new_human = ObjCreateInstance(N("human"), NULL);
@@ -629,6 +644,7 @@ Obj *LearnHuman(Name *nm, char *input_text, Discourse *dc, /* RESULTS */
     LearnObjDUMP(N("human"), new_human, M(new_human), feat, NULL, 0,
                  OBJ_CREATE_C, input_text, dc);
     if (gender) *gender = F_NULL;
+    MemScratchResume();
     return(new_human);
   }
 
@@ -672,6 +688,7 @@ Obj *LearnHuman(Name *nm, char *input_text, Discourse *dc, /* RESULTS */
     LearnAssert(new_assertion, dc);
   }
 
+  MemScratchResume();
   return(new_human);
 }
 
@@ -9,6 +9,8 @@
  * 19970712: port to gcc / DJGPP 2.01 / Windows95
  * 19981113: port to Red Hat Linux 5.2
  * 20150731: port to Apple Command Line Tools 6.4 / OS X 10.10.4
+ * 20261017T140000: added -S and -L snapshot options
+ * 20261017T160000: added -m arena report option
  */
 
 #include "tt.h"
@@ -25,6 +27,7 @@
 #include "repdb.h"
 #include "repdbf.h"
 #include "repgrid.h"
+#include "repinfer.h"
 #include "repmisc.h"
 #include "repobj.h"
 #include "repobjl.h"
@@ -37,7 +40,9 @@
 #include "synbase.h"
 #include "synparse.h"
 #include "synpnode.h"
+#include "ta.h"
 #include "taname.h"
+#include "tatagger.h"
 #include "toolrpt.h"
 #include "toolsh.h"
 #include "uaquest.h"
@@ -45,6 +50,7 @@
 #include "utildbg.h"
 #include "utilhtml.h"
 #include "utillrn.h"
+#include "utilsnap.h"
 
 Bool            DoLoad, Starting, SaveTime, GenOnAssert;
 Discourse	*StdDiscourse;
@@ -104,6 +110,7 @@ void Init(char *langs, char *dialects, int anamorph)
      * SaveTime = 0: uses more time and memory.
      */
   qallocInit();
+  ThreadInit();
   DbgInit();
   DbgSet(DBGALL, DBGBAD);
   DbgSetStdoutLevel(DBGOK);
@@ -113,17 +120,23 @@ void Init(char *langs, char *dialects, int anamorph)
   StringInit();
   RandomInit();
   GridInit();
-  ObjInit();
-  ObjListInit();
-  DbInit();
+  if (!SnapshotBegin(langs, dialects, anamorph)) {
+    ObjInit();
+    ObjListInit();
+    DbInit();
+  }
+  ObjHandlesInit();
   ContextInit();
   TsInit();
   TsRangeInit();
-  LexEntryInit();
-  Lex_WordForm2Init();
-  MorphInit(anamorph);
-  WordFormInit();
-  InferenceInit();
+  if (!SnapshotLoaded) {
+    LexEntryInit();
+    Lex_WordForm2Init();
+    MorphInit(anamorph);
+    WordFormInit();
+    InferenceInit();
+  }
+  InferenceForwardInit();
   ReportInit();
   CommentaryInit();
   TranslateInit();
@@ -139,22 +152,75 @@ void LoadBegin()
 {
   Starting = 1;
   BaseRuleCompile();
+  Syn_ParseRuleTableInit();
   LexEntryStatsBegin();
 }
 
 void LoadEnd()
 {
   LexEntryStatsEnd();
+  ObjHandlesCheck();
   TA_NameInit();
+  TA_ScanInit();
+  TA_TaggerInit();
   Me = N("TT");
   Sem_ParseInit();
   Starting = 0;
 }
 
+LoadFile LoadFiles[] = {
+  {"db/name.txt", DBFILETYPE_ISA},
+  {"db/food.txt", DBFILETYPE_ISA},
+  {"db/drug.txt", DBFILETYPE_ISA},
+  {"db/geog.txt", DBFILETYPE_POLITY},
+  {"db/absobj.txt", DBFILETYPE_ISA},
+  {"db/street.txt", DBFILETYPE_ISA},
+  {"db/grid.txt", DBFILETYPE_ISA},
+  {"db/all.txt", DBFILETYPE_ISA},
+  {"db/physics.txt", DBFILETYPE_ISA},
+  {"db/chem.txt", DBFILETYPE_ISA},
+  {"db/trans.txt", DBFILETYPE_ISA},
+  {"db/celest.txt", DBFILETYPE_ISA},
+  {"db/physobj.txt", DBFILETYPE_ISA},
+  {"db/photo.txt", DBFILETYPE_ISA},
+  {"db/furniture.txt", DBFILETYPE_ISA},
+  {"db/personalarticle.txt", DBFILETYPE_ISA},
+  {"db/officeproduct.txt", DBFILETYPE_ISA},
+  {"db/appliance.txt", DBFILETYPE_ISA},
+  {"db/hardware.txt", DBFILETYPE_ISA},
+  {"db/toy.txt", DBFILETYPE_ISA},
+  {"db/musicinstrument.txt", DBFILETYPE_ISA},
+  {"db/ling.txt", DBFILETYPE_ISA},
+  /* FeatPrintUnused(stdout); */
+  {"db/relation.txt", DBFILETYPE_ISA},
+  {"db/action.txt", DBFILETYPE_ISA},
+  {"db/attr.txt", DBFILETYPE_ISA},
+  {"db/enum.txt", DBFILETYPE_ISA},
+  {"db/living.txt", DBFILETYPE_ISA},
+  {"db/human.txt", DBFILETYPE_ISA},
+  {"db/clothing.txt", DBFILETYPE_ISA},
+  {"db/mediaobj.txt", DBFILETYPE_ISA},
+  {"db/software.txt", DBFILETYPE_ISA},
+  {"db/book.txt", DBFILETYPE_ISA},
+  {"db/homeentertain.txt", DBFILETYPE_ISA},
+  {"db/liveentertain.txt", DBFILETYPE_ISA},
+  {"db/film.txt", DBFILETYPE_ISA},
+  {"db/theory.txt", DBFILETYPE_ISA},
+  {"db/sound.txt", DBFILETYPE_ISA},
+  {"db/music.txt", DBFILETYPE_ISA},
+  {"db/musicconcept.txt", DBFILETYPE_ISA},
+  {"db/tv.txt", DBFILETYPE_ISA},
+  {"db/company.txt", DBFILETYPE_ISA},
+  {"db/elec.txt", DBFILETYPE_ISA},
+  {"db/net.txt", DBFILETYPE_ISA},
+  {NULL, 0}
+};
+
 void Load()
 {
-  Ts	ts1, ts2;
-  Dur	d;
+  Ts		ts1, ts2;
+  Dur		d;
+  LoadFile	*lf;
   TsSetNow(&ts1);
   if (StringIn(F_FRENCH, StdDiscourse->langs)) {
     LexEntryReadInflFile("db/frinfl.txt");
@@ -162,50 +228,9 @@ void Load()
   if (StringIn(F_ENGLISH, StdDiscourse->langs)) {
     LexEntryReadInflFile("db/eninfl.txt");
   }
-  DbFileRead("db/name.txt", DBFILETYPE_ISA);
-  DbFileRead("db/food.txt", DBFILETYPE_ISA);
-  DbFileRead("db/drug.txt", DBFILETYPE_ISA);
-  DbFileRead("db/geog.txt", DBFILETYPE_POLITY);
-  DbFileRead("db/absobj.txt", DBFILETYPE_ISA);
-  DbFileRead("db/street.txt", DBFILETYPE_ISA);
-  DbFileRead("db/grid.txt", DBFILETYPE_ISA);
-  DbFileRead("db/all.txt", DBFILETYPE_ISA);
-  DbFileRead("db/physics.txt", DBFILETYPE_ISA);
-  DbFileRead("db/chem.txt", DBFILETYPE_ISA);
-  DbFileRead("db/trans.txt", DBFILETYPE_ISA);
-  DbFileRead("db/celest.txt", DBFILETYPE_ISA);
-  DbFileRead("db/physobj.txt", DBFILETYPE_ISA);
-  DbFileRead("db/photo.txt", DBFILETYPE_ISA);
-  DbFileRead("db/furniture.txt", DBFILETYPE_ISA);
-  DbFileRead("db/personalarticle.txt", DBFILETYPE_ISA);
-  DbFileRead("db/officeproduct.txt", DBFILETYPE_ISA);
-  DbFileRead("db/appliance.txt", DBFILETYPE_ISA);
-  DbFileRead("db/hardware.txt", DBFILETYPE_ISA);
-  DbFileRead("db/toy.txt", DBFILETYPE_ISA);
-  DbFileRead("db/musicinstrument.txt", DBFILETYPE_ISA);
-  DbFileRead("db/ling.txt", DBFILETYPE_ISA);
-  /* FeatPrintUnused(stdout); */
-  DbFileRead("db/relation.txt", DBFILETYPE_ISA);
-  DbFileRead("db/action.txt", DBFILETYPE_ISA);
-  DbFileRead("db/attr.txt", DBFILETYPE_ISA);
-  DbFileRead("db/enum.txt", DBFILETYPE_ISA);
-  DbFileRead("db/living.txt", DBFILETYPE_ISA);
-  DbFileRead("db/human.txt", DBFILETYPE_ISA);
-  DbFileRead("db/clothing.txt", DBFILETYPE_ISA);
-  DbFileRead("db/mediaobj.txt", DBFILETYPE_ISA);
-  DbFileRead("db/software.txt", DBFILETYPE_ISA);
-  DbFileRead("db/book.txt", DBFILETYPE_ISA);
-  DbFileRead("db/homeentertain.txt", DBFILETYPE_ISA);
-  DbFileRead("db/liveentertain.txt", DBFILETYPE_ISA);
-  DbFileRead("db/film.txt", DBFILETYPE_ISA);
-  DbFileRead("db/theory.txt", DBFILETYPE_ISA);
-  DbFileRead("db/sound.txt", DBFILETYPE_ISA);
-  DbFileRead("db/music.txt", DBFILETYPE_ISA);
-  DbFileRead("db/musicconcept.txt", DBFILETYPE_ISA);
-  DbFileRead("db/tv.txt", DBFILETYPE_ISA);
-  DbFileRead("db/company.txt", DBFILETYPE_ISA);
-  DbFileRead("db/elec.txt", DBFILETYPE_ISA);
-  DbFileRead("db/net.txt", DBFILETYPE_ISA);
+  for (lf = LoadFiles; lf->fn; lf++) {
+    DbFileRead(lf->fn, lf->filetype);
+  }
   TsSetNow(&ts2);
   d = TsMinus(&ts2, &ts1);
   Dbg(DBGGEN, DBGBAD, "Load time = %.2ld:%.2ld.", d/60, d%60);
@@ -235,10 +260,12 @@ int main(int argc, char **argv)
   errflg = 0;
   ttshell_file = NULL;
   ttshell_cmd = NULL;
+  SnapshotReadFn = SnapshotWriteFn = NULL;
+  TaggerModelDir = NULL;
 #ifdef MACOS
   /* todo: implement option parsing on Mac. */
 #else
-  while ((c = getopt(argc, argv, "alc:d:f:g:")) != EOF) {
+  while ((c = getopt(argc, argv, "almc:d:f:g:L:S:T:")) != EOF) {
     switch (c) {
       case 'a':
         anamorph = 1;
@@ -249,6 +276,9 @@ int main(int argc, char **argv)
       case 'l':
         DoLoad = 0;
         break;
+      case 'm':
+        MemArenaReport = 1;
+        break;
       case 'c':
         ttshell_cmd = optarg;
         break;
@@ -261,6 +291,15 @@ int main(int argc, char **argv)
       case 'g':
         langs = optarg;
         break;
+      case 'L':
+        SnapshotReadFn = optarg;
+        break;
+      case 'S':
+        SnapshotWriteFn = optarg;
+        break;
+      case 'T':
+        TaggerModelDir = optarg;
+        break;
       case '?':
         errflg++;
     }
@@ -268,7 +307,8 @@ int main(int argc, char **argv)
 #endif
   if (errflg) {
     fprintf(stderr,
-      "usage: tt [-a] [-l] [-c cmd] [-f file] [-g langs] [-d dialects]\n");
+      "usage: tt [-a] [-l] [-m] [-c cmd] [-f file] [-g langs] [-d dialects]\n"
+      "          [-L snapshot] [-S snapshot] [-T tagger]\n");
     exit(1);
   }
 
@@ -278,11 +318,17 @@ int main(int argc, char **argv)
   }
  */
 
+  if (!DoLoad) SnapshotReadFn = SnapshotWriteFn = NULL;
   Init(langs, dialects, anamorph);
   if (DoLoad) {
     LoadBegin();
-    Load();
+    if (!SnapshotLoaded) {
+      Load();
+      if (SnapshotWriteFn) SnapshotWrite(SnapshotWriteFn);
+    }
     LoadEnd();
+  } else {
+    ObjHandlesCheck();
   }
 
   if (ttshell_cmd) {
@@ -0,0 +1,296 @@
+/*
+ * ThoughtTreasure
+ * Copyright 1996, 1997, 1998, 1999, 2015 Erik Thomas Mueller.
+ * All Rights Reserved.
+ *
+ * 20261017T140000: begun
+ *
+ * Snapshots of the loaded database, so that a restart does not have to
+ * reparse db/(*).txt:
+ *   tt -S snapshot.bin   loads the database as usual, then writes it out
+ *   tt -L snapshot.bin   maps the database back in instead of loading
+ * A snapshot is the KB arena (cf MemArenaInit) as it stands after
+ * Load, followed by the globals in SnapRoots that point into it:
+ *   SnapHeader
+ *   values of SnapRoots, in table order
+ *   offsets of arena words that point into the executable
+ *   arena, starting at a page boundary
+ * Since the arena is mapped back at the address it was written from, the
+ * only pointers needing fixup are those into the executable (string
+ * constants such as HashTable names), which move when the executable is
+ * loaded at a different address.
+ *
+ * A snapshot is stale, and the database is loaded as usual, if the
+ * executable or any of the database files is newer than it, or if it was
+ * written for other languages, dialects, or options.
+ */
+
+#include "tt.h"
+#include "repbasic.h"
+#include "repstr.h"
+#include "reptime.h"
+#include "utildbg.h"
+#include "utilsnap.h"
+
+char	*SnapshotReadFn, *SnapshotWriteFn;
+Bool	SnapshotLoaded;
+char	SnapshotLangs[FEATLEN], SnapshotDialects[FEATLEN];
+
+#define SNAPROOT(v)	{(void *)&(v), sizeof(v), #v}
+
+/* Globals set by ObjInit, ObjListInit, DbInit, LexEntryInit,
+ * Lex_WordForm2Init, MorphInit, WordFormInit, InferenceInit, and Load,
+ * plus ContextRoot, which assertions point to. Everything set by LoadBegin
+ * and LoadEnd is recomputed.
+ */
+SnapRoot SnapRoots[] = {
+  SNAPROOT(HashTables),
+  SNAPROOT(ObjHash),
+  SNAPROOT(Objs),
+  SNAPROOT(ObjWild),
+  SNAPROOT(ObjNA),
+  SNAPROOT(OBJDEFER),
+  SNAPROOT(IsaEpoch),
+  SNAPROOT(ObjNextId),
+  SNAPROOT(IncreaseMsg),
+  SNAPROOT(ObjParentLinkCnt),
+  SNAPROOT(OBJLISTDEFER),
+  SNAPROOT(OBJLISTRULEDOUT),
+  SNAPROOT(DbIndex01),
+  SNAPROOT(DbIndex02),
+  SNAPROOT(DbIndex0),
+  SNAPROOT(DbIndex1),
+  SNAPROOT(DbIndex2),
+  SNAPROOT(DbAssertionCnt),
+  SNAPROOT(MaxWordsInPhrase),
+  SNAPROOT(AllLexEntries),
+  SNAPROOT(LexEntryInsideName),
+  SNAPROOT(FrenchIndex),
+  SNAPROOT(EnglishIndex),
+  SNAPROOT(SpellIndex),
+  SNAPROOT(FrenchPrefixIndex),
+  SNAPROOT(EnglishPrefixIndex),
+  SNAPROOT(NewInflections),
+  SNAPROOT(WordForm2Suffixes),
+  SNAPROOT(WordForm2Prefixes),
+  SNAPROOT(WordForm2EnglishSuffixesCnt),
+  SNAPROOT(WordForm2EnglishPrefixesCnt),
+  SNAPROOT(WordForm2FrenchSuffixesCnt),
+  SNAPROOT(WordForm2FrenchPrefixesCnt),
+  SNAPROOT(AnaMorphOn),
+  SNAPROOT(AnaMorphHt),
+  SNAPROOT(AnaMorphClassAll),
+  SNAPROOT(WordFormHt),
+  SNAPROOT(WordFormTrained),
+  SNAPROOT(InferenceRules),
+  SNAPROOT(ActivationRules),
+  SNAPROOT(ProofRules),
+  SNAPROOT(StringGenNext),
+  SNAPROOT(ContextRoot),
+  SNAPROOT(ContextNextTopId),
+  {NULL, 0, NULL}
+};
+
+#ifdef GCC
+extern char	__executable_start[], _end[];
+#endif
+
+size_t SnapRootBytes()
+{
+  size_t	r;
+  SnapRoot	*sr;
+  r = 0;
+  for (sr = SnapRoots; sr->addr; sr++) r += sr->size;
+  return(r);
+}
+
+/* Called by Init in place of the database initialization functions.
+ * Returns 1 if the database was mapped in from a snapshot.
+ */
+Bool SnapshotBegin(char *langs, char *dialects, int anamorph)
+{
+  SnapshotLoaded = 0;
+  StringCpy(SnapshotLangs, langs, FEATLEN);
+  StringCpy(SnapshotDialects, dialects, FEATLEN);
+  if (SnapshotReadFn) {
+    SnapshotLoaded = SnapshotRead(SnapshotReadFn, anamorph);
+  }
+  if (!SnapshotLoaded) {
+    MemArenaInit();
+    if (!MemArenaKB.on) SnapshotWriteFn = NULL;
+  }
+  return(SnapshotLoaded);
+}
+
+Bool SnapshotFileNewer(char *fn, Ts *snapts)
+{
+  Ts	ts;
+  if (!StreamFileModtime(fn, &ts)) return(0);
+  if (TsGT(&ts, snapts)) {
+    Dbg(DBGGEN, DBGOK, "snapshot older than <%s>", fn);
+    return(1);
+  }
+  return(0);
+}
+
+Bool SnapshotIsStale(char *fn)
+{
+  char		dbfn[FILENAMELEN];
+  Ts		snapts;
+  LoadFile	*lf;
+  if (!StreamFileModtime(fn, &snapts)) return(1);
+#ifdef GCC
+  if (SnapshotFileNewer("/proc/self/exe", &snapts)) return(1);
+#endif
+  sprintf(dbfn, "%s/db/frinfl.txt", TTRoot);
+  if (SnapshotFileNewer(dbfn, &snapts)) return(1);
+  sprintf(dbfn, "%s/db/eninfl.txt", TTRoot);
+  if (SnapshotFileNewer(dbfn, &snapts)) return(1);
+  for (lf = LoadFiles; lf->fn; lf++) {
+    sprintf(dbfn, "%s/%s", TTRoot, lf->fn);
+    if (SnapshotFileNewer(dbfn, &snapts)) return(1);
+  }
+  return(0);
+}
+
+Bool SnapshotWrite(char *fn)
+{
+#ifdef GCC
+  size_t	numrelocs, i;
+  long		pagesize;
+  char		**p, **e, *pad;
+  FILE		*stream;
+  SnapHeader	hdr;
+  SnapRoot	*sr;
+  size_t	*relocs;
+  if (!MemArenaKB.on) {
+    Dbg(DBGGEN, DBGBAD, "SnapshotWrite: no KB arena");
+    return(0);
+  }
+  MemArenaKB.on = 0;
+  e = (char **)(MemArenaKB.base + MemArenaKB.used);
+  numrelocs = 0;
+  for (p = (char **)MemArenaKB.base; p < e; p++) {
+    if (*p >= __executable_start && *p < _end) numrelocs++;
+  }
+  relocs = (size_t *)MemAlloc(sizeof(size_t)*(numrelocs+1), "size_t relocs");
+  i = 0;
+  for (p = (char **)MemArenaKB.base; p < e; p++) {
+    if (*p >= __executable_start && *p < _end) {
+      relocs[i++] = ((char *)p) - MemArenaKB.base;
+    }
+  }
+  pagesize = sysconf(_SC_PAGESIZE);
+  memset(&hdr, 0, sizeof(hdr));
+  memcpy(hdr.magic, SNAPMAGIC, sizeof(hdr.magic));
+  hdr.version = SNAPVERSION;
+  hdr.arena = MemArenaKB.base;
+  hdr.arenaused = MemArenaKB.used;
+  hdr.rootbytes = SnapRootBytes();
+  hdr.numrelocs = numrelocs;
+  hdr.exe = (char *)SnapshotWrite;
+  hdr.anamorph = AnaMorphOn;
+  hdr.savetime = SaveTime;
+  StringCpy(hdr.langs, SnapshotLangs, FEATLEN);
+  StringCpy(hdr.dialects, SnapshotDialects, FEATLEN);
+  hdr.arenaoffset = sizeof(hdr) + hdr.rootbytes + numrelocs*sizeof(size_t);
+  hdr.arenaoffset = pagesize*((hdr.arenaoffset + pagesize - 1)/pagesize);
+  if (NULL == (stream = StreamOpen(fn, "wb"))) {
+    MemFree(relocs, "size_t relocs");
+    return(0);
+  }
+  fwrite(&hdr, sizeof(hdr), 1, stream);
+  for (sr = SnapRoots; sr->addr; sr++) fwrite(sr->addr, sr->size, 1, stream);
+  fwrite(relocs, sizeof(size_t), numrelocs, stream);
+  i = hdr.arenaoffset - (sizeof(hdr) + hdr.rootbytes +
+                         numrelocs*sizeof(size_t));
+  pad = (char *)MemAlloc(i+1, "char snapshot pad");
+  memset(pad, 0, i);
+  fwrite(pad, 1, i, stream);
+  fwrite(MemArenaKB.base, 1, MemArenaKB.used, stream);
+  MemFree(pad, "char snapshot pad");
+  MemFree(relocs, "size_t relocs");
+  if (ferror(stream)) {
+    Dbg(DBGGEN, DBGBAD, "SnapshotWrite: trouble writing <%s>", fn);
+    fclose(stream);
+    return(0);
+  }
+  fclose(stream);
+  Dbg(DBGGEN, DBGOK, "wrote snapshot <%s>: %ld bytes, %ld relocations",
+      fn, (long)MemArenaKB.used, (long)numrelocs);
+  return(1);
+#else
+  Dbg(DBGGEN, DBGBAD, "SnapshotWrite: not supported on this platform");
+  return(0);
+#endif
+}
+
+Bool SnapshotRead(char *fn, int anamorph)
+{
+#ifdef GCC
+  size_t	i;
+  long		delta;
+  char		*roots, *q, **p;
+  FILE		*stream;
+  SnapHeader	hdr;
+  SnapRoot	*sr;
+  size_t	*relocs;
+  if (SnapshotIsStale(fn)) {
+    Dbg(DBGGEN, DBGOK, "snapshot <%s> missing or stale; loading database",
+        fn);
+    return(0);
+  }
+  if (NULL == (stream = StreamOpen(fn, "rb"))) return(0);
+  if (1 != fread(&hdr, sizeof(hdr), 1, stream) ||
+      0 != memcmp(hdr.magic, SNAPMAGIC, sizeof(hdr.magic)) ||
+      hdr.version != SNAPVERSION ||
+      hdr.rootbytes != SnapRootBytes()) {
+    Dbg(DBGGEN, DBGBAD, "SnapshotRead: <%s> is not a snapshot", fn);
+    fclose(stream);
+    return(0);
+  }
+  if (hdr.anamorph != anamorph || hdr.savetime != SaveTime ||
+      (!streq(hdr.langs, SnapshotLangs)) ||
+      (!streq(hdr.dialects, SnapshotDialects))) {
+    Dbg(DBGGEN, DBGOK, "snapshot <%s> written with other options", fn);
+    fclose(stream);
+    return(0);
+  }
+  roots = (char *)MemAlloc(hdr.rootbytes, "char snapshot roots");
+  relocs = (size_t *)MemAlloc(sizeof(size_t)*(hdr.numrelocs+1),
+                              "size_t relocs");
+  if (1 != fread(roots, hdr.rootbytes, 1, stream) ||
+      hdr.numrelocs != fread(relocs, sizeof(size_t), hdr.numrelocs, stream) ||
+      !MemArenaMap(&MemArenaKB, fileno(stream), hdr.arenaoffset,
+                   hdr.arenaused)) {
+    Dbg(DBGGEN, DBGBAD, "SnapshotRead: trouble reading <%s>", fn);
+    MemFree(roots, "char snapshot roots");
+    MemFree(relocs, "size_t relocs");
+    fclose(stream);
+    return(0);
+  }
+  fclose(stream);
+  delta = ((char *)SnapshotWrite) - hdr.exe;
+  if (delta != 0) {
+    for (i = 0; i < hdr.numrelocs; i++) {
+      p = (char **)(MemArenaKB.base + relocs[i]);
+      *p += delta;
+    }
+  }
+  q = roots;
+  for (sr = SnapRoots; sr->addr; sr++) {
+    memcpy(sr->addr, q, sr->size);
+    q += sr->size;
+  }
+  MemFree(roots, "char snapshot roots");
+  MemFree(relocs, "size_t relocs");
+  Dbg(DBGGEN, DBGOK, "read snapshot <%s>: %ld bytes, %ld relocations", fn,
+      (long)hdr.arenaused, (long)hdr.numrelocs);
+  return(1);
+#else
+  Dbg(DBGGEN, DBGBAD, "SnapshotRead: not supported on this platform");
+  return(0);
+#endif
+}
+
+/* End of file. */
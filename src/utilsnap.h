@@ -0,0 +1,7 @@
+/* utilsnap.c */
+size_t SnapRootBytes(void);
+Bool SnapshotBegin(char *langs, char *dialects, int anamorph);
+Bool SnapshotFileNewer(char *fn, Ts *snapts);
+Bool SnapshotIsStale(char *fn);
+Bool SnapshotWrite(char *fn);
+Bool SnapshotRead(char *fn, int anamorph);